@@ -411,7 +411,8 @@ StudentAutonomyProtocol::UpdateTrajectories() {
       return empty_quad_to_trajectory_map;
       break;
     }
-    case MediationLayerCode::PointWithinObstacle: {
+    case MediationLayerCode::PointWithinObstacle:
+    case MediationLayerCode::SegmentIntersectsObstacle: {
       P4_inflate = P4_inflate - 1;
       std::cout << "Prevet code: " << static_cast<int>(prevetter_response.code)
                 << std::endl;
@@ -14,6 +14,7 @@
 #include "game_snapshot.h"
 #include "map3d.h"
 #include "presubmission_trajectory_vetter.h"
+#include "stop_token.h"
 #include "trajectory_client.h"
 #include "trajectory_code.h"
 #include "warden.h"
@@ -56,7 +57,7 @@ class AutonomyProtocol {
   Eigen::Vector3d goal_position_;
   WindIntensity wind_intensity_;
 
-  volatile std::atomic<bool> ok_{true};
+  StopSource stop_source_;
   std::map<std::string, TrajectoryCode> trajectoryCodeMap_;
 
  public:
@@ -89,7 +90,8 @@ class AutonomyProtocol {
 
   virtual ~AutonomyProtocol() {}
 
-  // Stop this thread from running
+  // Stop this thread from running. Once Run() has returned, it may be called
+  // again.
   void Stop();
 
   // Main loop for this thread
@@ -111,7 +113,8 @@ inline void AutonomyProtocol::Run(
     std::unordered_map<std::string, std::shared_ptr<TrajectoryClientNode>>
         proposed_trajectory_clients,
     bool joy_mode, bool camera_mode) {
-  while (ok_) {
+  const StopToken stop_token = this->stop_source_.Token();
+  while (false == stop_token.StopRequested()) {
     // Request trajectory updates from the virtual function
     const std::unordered_map<std::string, Trajectory> trajectories =
         UpdateTrajectories();
@@ -140,9 +143,11 @@ inline void AutonomyProtocol::Run(
       // mode.
       sleep_time = 100;
     }
-    std::this_thread::sleep_for(std::chrono::milliseconds(sleep_time));
+    stop_token.WaitFor(std::chrono::milliseconds(sleep_time));
   }
+
+  this->stop_source_.Reset();
 }
 
-inline void AutonomyProtocol::Stop() { ok_ = false; }
+inline void AutonomyProtocol::Stop() { this->stop_source_.RequestStop(); }
 }  // namespace game_engine
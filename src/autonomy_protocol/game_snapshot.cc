@@ -1,29 +1,38 @@
 #include "game_snapshot.h"
 
 namespace game_engine {
+void GameSnapshot::Resolve(const std::string& quad_name, const bool is_friend) {
+  QuadId id;
+  if (MediationLayerCode::Success !=
+      this->quad_state_warden_->Id(quad_name, id)) {
+    return;
+  }
+  this->quads_[quad_name] = Quad{id, is_friend};
+}
+
+const GameSnapshot::Quad* GameSnapshot::Find(
+    const std::string& quad_name) const {
+  const auto it = this->quads_.find(quad_name);
+  return (this->quads_.end() == it) ? nullptr : &it->second;
+}
+
 bool GameSnapshot::Position(const std::string& quad_name,
                             Eigen::Vector3d& position) {
-  const bool is_friend =
-      (std::find(this->friendly_names_.begin(), this->friendly_names_.end(),
-                 quad_name) != this->friendly_names_.end());
-
-  const bool is_enemy =
-      (std::find(this->enemy_names_.begin(), this->enemy_names_.end(),
-                 quad_name) != this->enemy_names_.end());
+  const Quad* quad = this->Find(quad_name);
 
   // Invalid quad name
-  if (false == (is_enemy || is_friend)) {
+  if (nullptr == quad) {
     return false;
   }
 
   // Read from the warden
   QuadState state;
-  this->quad_state_warden_->Read(quad_name, state);
+  this->quad_state_warden_->Read(quad->id, state);
 
   // Copy the position
   position = state.Position();
 
-  if (true == is_enemy) {
+  if (false == quad->is_friend) {
     // TODO: Corrupt position with noise
   }
 
@@ -32,27 +41,21 @@ bool GameSnapshot::Position(const std::string& quad_name,
 
 bool GameSnapshot::Orientation(const std::string& quad_name,
                                Eigen::Vector4d& orientation) {
-  const bool is_friend =
-      (std::find(this->friendly_names_.begin(), this->friendly_names_.end(),
-                 quad_name) != this->friendly_names_.end());
-
-  const bool is_enemy =
-      (std::find(this->enemy_names_.begin(), this->enemy_names_.end(),
-                 quad_name) != this->enemy_names_.end());
+  const Quad* quad = this->Find(quad_name);
 
   // Invalid quad name
-  if (false == (is_enemy || is_friend)) {
+  if (nullptr == quad) {
     return false;
   }
 
   // Read from the warden
   QuadState state;
-  this->quad_state_warden_->Read(quad_name, state);
+  this->quad_state_warden_->Read(quad->id, state);
 
   // Copy the yaw
   orientation = Eigen::Vector4d(state.Orientation());
 
-  if (true == is_enemy) {
+  if (false == quad->is_friend) {
     // TODO: Corrupt position with noise
   }
 
@@ -61,22 +64,16 @@ bool GameSnapshot::Orientation(const std::string& quad_name,
 
 bool GameSnapshot::Velocity(const std::string& quad_name,
                             Eigen::Vector3d& velocity) {
-  const bool is_friend =
-      (std::find(this->friendly_names_.begin(), this->friendly_names_.end(),
-                 quad_name) != this->friendly_names_.end());
-
-  const bool is_enemy =
-      (std::find(this->enemy_names_.begin(), this->enemy_names_.end(),
-                 quad_name) != this->enemy_names_.end());
+  const Quad* quad = this->Find(quad_name);
 
   // Invalid quad name or not friend
-  if (false == is_friend) {
+  if (nullptr == quad || false == quad->is_friend) {
     return false;
   }
 
   // Read from the warden
   QuadState state;
-  this->quad_state_warden_->Read(quad_name, state);
+  this->quad_state_warden_->Read(quad->id, state);
 
   // Copy the velocity
   velocity = state.Velocity();
@@ -1,8 +1,10 @@
 #pragma once
 
 #include <string>
+#include <unordered_map>
 #include <vector>
 
+#include "quad_id.h"
 #include "quad_state.h"
 #include "warden.h"
 
@@ -26,7 +28,16 @@ class GameSnapshot {
       : friendly_names_(friendly_names),
         enemy_names_(enemy_names),
         quad_state_warden_(quad_state_warden),
-        options_(options) {}
+        options_(options) {
+    // Resolve every quad once so that lookups are a single hash. Quads must
+    // be registered with the warden before the snapshot is constructed.
+    for (const std::string& name : friendly_names_) {
+      this->Resolve(name, true);
+    }
+    for (const std::string& name : enemy_names_) {
+      this->Resolve(name, false);
+    }
+  }
 
   // Returns the yaw of the quadcopter. If quad_name is invalid, returns
   // false, else returns true. Stores the data in 'position'.
@@ -52,9 +63,21 @@ class GameSnapshot {
   bool Velocity(const std::string& quad_name, Eigen::Vector3d& velocity);
 
  private:
+  struct Quad {
+    QuadId id;
+    bool is_friend;
+  };
+
   Options options_;
   std::vector<std::string> friendly_names_;
   std::vector<std::string> enemy_names_;
   std::shared_ptr<QuadStateWarden> quad_state_warden_;
+  std::unordered_map<std::string, Quad> quads_;
+
+  void Resolve(const std::string& quad_name, const bool is_friend);
+
+  // Returns the quad associated with quad_name, or nullptr if it is neither
+  // a friend nor an enemy
+  const Quad* Find(const std::string& quad_name) const;
 };
 }  // namespace game_engine
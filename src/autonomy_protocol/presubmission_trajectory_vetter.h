@@ -18,6 +18,16 @@ class PreSubmissionTrajectoryVetter : public TrajectoryVetter {
   // Determines if a trajectory meets the trajectory requirements
   TrajectoryCode PreVet(const std::string& quad_name,
                         const Trajectory& trajectory, const Map3D& map);
+
+  // Lists every trajectory requirement that a trajectory violates
+  VettingReport PreVetAll(const std::string& quad_name,
+                          const Trajectory& trajectory, const Map3D& map);
+
+  // Determines which of several candidate trajectories meet the trajectory
+  // requirements. The candidates are vetted in parallel.
+  std::vector<TrajectoryCode> PreVetBatch(
+      const std::string& quad_name, const std::vector<Trajectory>& trajectories,
+      const Map3D& map);
 };
 
 //  ******************
@@ -35,6 +45,25 @@ inline TrajectoryCode PreSubmissionTrajectoryVetter::PreVet(
   // Vet is part of trajectory_vetter.h in the mediation layer.
   return Vet(trajectory, map, quad_state_warden_, quad_name);
 }
+
+// Unlike PreVet(), which stops at the first violation, the report lists
+// every violated requirement with the first violating index, the worst value
+// and the number of violating samples. A trajectory can be corrected for all
+// of them before it is submitted again.
+inline VettingReport PreSubmissionTrajectoryVetter::PreVetAll(
+    const std::string& quad_name, const Trajectory& trajectory,
+    const Map3D& map) {
+  return VetAll(trajectory, map, quad_state_warden_, quad_name);
+}
+
+// Vets a batch of candidates, for example several timing variants of the
+// same path, so that the fastest feasible one can be submitted within a
+// single planning cycle. The codes are in the order of the candidates.
+inline std::vector<TrajectoryCode> PreSubmissionTrajectoryVetter::PreVetBatch(
+    const std::string& quad_name, const std::vector<Trajectory>& trajectories,
+    const Map3D& map) {
+  return VetBatch(trajectories, map, quad_state_warden_, quad_name);
+}
 }  // namespace game_engine
 
 #endif
@@ -2,7 +2,23 @@
 
 #include "map3d.h"
 
+#include <algorithm>
+#include <cmath>
+#include <exception>
+
 namespace game_engine {
+namespace {
+// Bounding boxes are padded slightly so that rounding in Contains() can never
+// place a point inside an obstacle but outside its box
+constexpr double kBoxPadding = 1e-6;
+
+// Edge length of the cells of inflated maps' occupancy bitmaps, in meters
+constexpr double kCellSize = 0.1;
+
+// Upper bound on the number of cells in an occupancy bitmap
+constexpr double kMaxCells = 1 << 22;
+}  // namespace
+
 const Polyhedron& Map3D::Boundary() const { return this->boundary_; }
 
 const std::vector<Polyhedron>& Map3D::Obstacles() const {
@@ -30,13 +46,19 @@ bool Map3D::IsFreeDynamicSpace(const std::string& quad_name,
 void Map3D::ClearDynamicObstacles() { this->dynamic_obstacles_.clear(); }
 
 bool Map3D::Contains(const Point3D& point) const {
+  if (nullptr != this->boundary_cells_) {
+    const OccupancyBitmap::State state = this->boundary_cells_->At(point);
+    if (OccupancyBitmap::State::kUnknown != state) {
+      return OccupancyBitmap::State::kFree == state;
+    }
+  }
   return this->boundary_.Contains(point);
 }
 
 Plane3D Map3D::Ground() const {
   size_t min_idx;
   double min_z = std::numeric_limits<double>::max();
-  const std::vector<Plane3D>& faces = this->boundary_.Faces();
+  const Polyhedron::FaceRange faces = this->boundary_.Faces();
   for (size_t idx = 0; idx < faces.size(); ++idx) {
     double z = 0;
     for (const Line3D edge : faces[idx].Edges()) {
@@ -50,13 +72,16 @@ Plane3D Map3D::Ground() const {
     }
   }
 
-  return faces[min_idx];
+  return faces[min_idx].ToPlane3D();
 }
 
 std::vector<Plane3D> Map3D::Walls() const {
   size_t min_idx;
   double min_z = std::numeric_limits<double>::max();
-  std::vector<Plane3D> faces = this->boundary_.Faces();
+  std::vector<Plane3D> faces;
+  for (const Polyhedron::Face& face : this->boundary_.Faces()) {
+    faces.push_back(face.ToPlane3D());
+  }
   for (size_t idx = 0; idx < faces.size(); ++idx) {
     double z = 0;
     for (const Line3D edge : faces[idx].Edges()) {
@@ -75,12 +100,117 @@ std::vector<Plane3D> Map3D::Walls() const {
 }
 
 bool Map3D::IsFreeSpace(const Point3D& point) const {
+  if (nullptr != this->obstacle_cells_) {
+    const OccupancyBitmap::State state = this->obstacle_cells_->At(point);
+    if (OccupancyBitmap::State::kUnknown != state) {
+      return OccupancyBitmap::State::kFree == state;
+    }
+  }
+
+  // Only obstacles whose bounding boxes contain the point can contain it
+  return this->obstacle_tree_->Query(
+      AabbTree::Box(point, point), [&](const size_t idx) {
+        return false == this->obstacles_[idx].Contains(point);
+      });
+}
+
+bool Map3D::IsFreeSegment(const Point3D& start, const Point3D& end) const {
+  const AabbTree::Box region(start.cwiseMin(end), start.cwiseMax(end));
+  return this->obstacle_tree_->Query(region, [&](const size_t idx) {
+    return false == this->obstacles_[idx].IntersectsSegment(start, end);
+  });
+}
+
+std::vector<bool> Map3D::Contains(const std::vector<Point3D>& points) const {
+  std::vector<bool> contained(points.size());
+  for (size_t idx = 0; idx < points.size(); ++idx) {
+    contained[idx] = this->Contains(points[idx]);
+  }
+  return contained;
+}
+
+std::vector<bool> Map3D::IsFreeSpace(const std::vector<Point3D>& points) const {
+  std::vector<bool> free(points.size());
+  for (size_t idx = 0; idx < points.size(); ++idx) {
+    free[idx] = this->IsFreeSpace(points[idx]);
+  }
+  return free;
+}
+
+void Map3D::BuildObstacleTree() {
+  std::vector<AabbTree::Box> boxes;
+  boxes.reserve(this->obstacles_.size());
   for (const Polyhedron& obstacle : this->obstacles_) {
-    if (true == obstacle.Contains(point)) {
-      return false;
+    AabbTree::Box box = obstacle.BoundingBox();
+    box.min().array() -= kBoxPadding;
+    box.max().array() += kBoxPadding;
+    boxes.push_back(box);
+  }
+  this->obstacle_tree_ = std::make_shared<const AabbTree>(boxes);
+}
+
+void Map3D::Rasterize(const double resolution) {
+  const Eigen::AlignedBox3d bounds = this->boundary_.BoundingBox();
+  if (true == bounds.isEmpty()) {
+    return;
+  }
+  const double cell_size =
+      std::max(resolution, std::cbrt(bounds.volume() / kMaxCells));
+
+  // Cells that straddle the boundary are left unknown
+  auto boundary_cells = std::make_shared<OccupancyBitmap>(bounds, cell_size);
+  const Eigen::Array3i size = boundary_cells->Size();
+  for (int z = 0; z < size.z(); ++z) {
+    for (int y = 0; y < size.y(); ++y) {
+      for (int x = 0; x < size.x(); ++x) {
+        switch (this->boundary_.Classify(boundary_cells->CellBox(x, y, z))) {
+          case Polyhedron::Overlap::kInside:
+            boundary_cells->Set(x, y, z, OccupancyBitmap::State::kFree);
+            break;
+          case Polyhedron::Overlap::kOutside:
+            boundary_cells->Set(x, y, z, OccupancyBitmap::State::kOccupied);
+            break;
+          case Polyhedron::Overlap::kPartial:
+            break;
+        }
+      }
     }
   }
-  return true;
+
+  // Cells are free unless they are near an obstacle. A cell entirely inside
+  // any obstacle is occupied, even if it straddles another one.
+  auto obstacle_cells = std::make_shared<OccupancyBitmap>(
+      bounds, cell_size, OccupancyBitmap::State::kFree);
+  for (const Polyhedron& obstacle : this->obstacles_) {
+    Eigen::AlignedBox3d box = obstacle.BoundingBox();
+    box.min().array() -= kBoxPadding;
+    box.max().array() += kBoxPadding;
+
+    Eigen::Array3i begin, end;
+    obstacle_cells->CellRange(box, begin, end);
+    for (int z = begin.z(); z < end.z(); ++z) {
+      for (int y = begin.y(); y < end.y(); ++y) {
+        for (int x = begin.x(); x < end.x(); ++x) {
+          switch (obstacle.Classify(obstacle_cells->CellBox(x, y, z))) {
+            case Polyhedron::Overlap::kInside:
+              obstacle_cells->Set(x, y, z, OccupancyBitmap::State::kOccupied);
+              break;
+            case Polyhedron::Overlap::kPartial:
+              if (OccupancyBitmap::State::kOccupied !=
+                  obstacle_cells->Get(x, y, z)) {
+                obstacle_cells->Set(x, y, z, OccupancyBitmap::State::kUnknown);
+              }
+              break;
+            case Polyhedron::Overlap::kOutside:
+              break;
+          }
+        }
+      }
+    }
+  }
+
+  this->boundary_cells_ = boundary_cells;
+  this->obstacle_cells_ = obstacle_cells;
 }
 
 Map3D Map3D::Inflate(const double distance) const {
@@ -94,6 +224,44 @@ Map3D Map3D::Inflate(const double distance) const {
   return Map3D(new_boundary, new_obstacles);
 }
 
+std::shared_ptr<const Map3D> Map3D::Inflated(const double distance) const {
+  const std::shared_ptr<InflationCache> cache = this->inflation_cache_;
+
+  // The first caller for a distance builds the map. Later callers wait on its
+  // future.
+  std::promise<std::shared_ptr<const Map3D>> promise;
+  std::shared_future<std::shared_ptr<const Map3D>> inflated;
+  {
+    std::lock_guard<std::mutex> lock(cache->mtx);
+    const auto it = cache->maps.find(distance);
+    if (cache->maps.end() != it) {
+      inflated = it->second;
+    } else {
+      cache->maps.emplace(distance, promise.get_future().share());
+    }
+  }
+  if (true == inflated.valid()) {
+    return inflated.get();
+  }
+
+  try {
+    Map3D inflated_map = this->Inflate(distance);
+    inflated_map.Rasterize(kCellSize);
+    const std::shared_ptr<const Map3D> inflated_ptr =
+        std::make_shared<const Map3D>(std::move(inflated_map));
+    promise.set_value(inflated_ptr);
+    return inflated_ptr;
+  } catch (...) {
+    // Let a later call try again, and pass the error to any waiting caller
+    {
+      std::lock_guard<std::mutex> lock(cache->mtx);
+      cache->maps.erase(distance);
+    }
+    promise.set_exception(std::current_exception());
+    throw;
+  }
+}
+
 std::vector<std::pair<double, double>> Map3D::Extents() const {
   double min_x{std::numeric_limits<double>::max()},
       max_x{-std::numeric_limits<double>::max()},
@@ -102,29 +270,24 @@ std::vector<std::pair<double, double>> Map3D::Extents() const {
       min_z{std::numeric_limits<double>::max()},
       max_z{-std::numeric_limits<double>::max()};
 
-  for (const Plane3D& face : this->boundary_.Faces()) {
-    for (const Line3D& edge : face.Edges()) {
-      const std::vector<Point3D> vertices = {edge.Start(), edge.End()};
-      for (const Point3D& vertex : vertices) {
-        if (vertex.x() < min_x) {
-          min_x = vertex.x();
-        }
-        if (vertex.y() < min_y) {
-          min_y = vertex.y();
-        }
-        if (vertex.z() < min_z) {
-          min_z = vertex.z();
-        }
-        if (vertex.x() > max_x) {
-          max_x = vertex.x();
-        }
-        if (vertex.y() > max_y) {
-          max_y = vertex.y();
-        }
-        if (vertex.z() > max_z) {
-          max_z = vertex.z();
-        }
-      }
+  for (const Point3D& vertex : this->boundary_.Vertices()) {
+    if (vertex.x() < min_x) {
+      min_x = vertex.x();
+    }
+    if (vertex.y() < min_y) {
+      min_y = vertex.y();
+    }
+    if (vertex.z() < min_z) {
+      min_z = vertex.z();
+    }
+    if (vertex.x() > max_x) {
+      max_x = vertex.x();
+    }
+    if (vertex.y() > max_y) {
+      max_y = vertex.y();
+    }
+    if (vertex.z() > max_z) {
+      max_z = vertex.z();
     }
   }
 
@@ -1,12 +1,18 @@
 #pragma once
 
 #include <cstdlib>
+#include <future>
 #include <iostream>
 #include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include "aabb_tree.h"
+#include "occupancy_bitmap.h"
 #include "polyhedron.h"
 #include "yaml-cpp/yaml.h"
 
@@ -22,10 +28,32 @@ class Map3D {
   // The obstacles in the map are represented by a list of convex polyhedra
   std::vector<Polyhedron> obstacles_;
 
+  // Bounding volume hierarchy over the obstacles' bounding boxes. Built
+  // whenever the obstacles change and shared by copies of the map.
+  std::shared_ptr<const AabbTree> obstacle_tree_;
+
+  // Conservative rasterizations of the boundary and the obstacles. Where a
+  // cell is known to be entirely inside or outside, Contains() and
+  // IsFreeSpace() answer with a single lookup. Only the maps built by
+  // Inflated() are rasterized.
+  std::shared_ptr<const OccupancyBitmap> boundary_cells_;
+  std::shared_ptr<const OccupancyBitmap> obstacle_cells_;
+
   // The dynamic obstacles in the map are represented by a list of convex
   // polyhedra
   std::unordered_map<std::string, Polyhedron> dynamic_obstacles_;
 
+  // Inflated copies of the static map, keyed by inflation distance. Copies of
+  // a map share its cache. The cache is replaced whenever the boundary or
+  // obstacles change. Each map is built without holding mtx, so only callers
+  // that ask for the same distance wait for it.
+  struct InflationCache {
+    std::mutex mtx;
+    std::map<double, std::shared_future<std::shared_ptr<const Map3D>>> maps;
+  };
+  std::shared_ptr<InflationCache> inflation_cache_ =
+      std::make_shared<InflationCache>();
+
   // Forward-declare friend class for parsing
   friend class YAML::convert<Map3D>;
 
@@ -33,7 +61,9 @@ class Map3D {
   // Constructor
   Map3D(const Polyhedron& boundary = Polyhedron(),
         const std::vector<Polyhedron>& obstacles = {})
-      : boundary_(boundary), obstacles_(obstacles) {}
+      : boundary_(boundary), obstacles_(obstacles) {
+    this->BuildObstacleTree();
+  }
 
   // Boundary accessor
   const Polyhedron& Boundary() const;
@@ -60,6 +90,16 @@ class Map3D {
   // obstacle
   bool IsFreeSpace(const Point3D& point) const;
 
+  // Determines whether or not every point on the segment between start and
+  // end is free of obstacles. Like IsFreeSpace(), this does not consider the
+  // map boundary.
+  bool IsFreeSegment(const Point3D& start, const Point3D& end) const;
+
+  // Batch forms of Contains() and IsFreeSpace(). Element idx of the result is
+  // the answer for points[idx].
+  std::vector<bool> Contains(const std::vector<Point3D>& points) const;
+  std::vector<bool> IsFreeSpace(const std::vector<Point3D>& points) const;
+
   // Determines the extents of the map. Returns a list of tuples that
   // contain the {min,max} coordinates for the XYZ dimensions.
   std::vector<std::pair<double, double>> Extents() const;
@@ -76,9 +116,22 @@ class Map3D {
   // to stay the same.
   Map3D Inflate(const double distance) const;
 
+  // Returns the same map as Inflate(), but builds it only once per distance
+  // and shares it with every copy of this map. The returned map is also
+  // rasterized, so that most of its queries take constant time. Safe to
+  // call from multiple threads.
+  std::shared_ptr<const Map3D> Inflated(const double distance) const;
+
   // Returns the point closest to the given point that is either on the
   // map boundary or any obstacle
   Point3D ClosestPoint(const Point3D& point) const;
+
+ private:
+  void BuildObstacleTree();
+
+  // Build boundary_cells_ and obstacle_cells_ with cells of the given edge
+  // length, or larger for maps too big to cover at that resolution
+  void Rasterize(const double resolution);
 };
 }  // namespace game_engine
 
@@ -98,11 +151,16 @@ struct convert<game_engine::Map3D> {
     }
 
     rhs.boundary_ = node["boundary"].as<game_engine::Polyhedron>();
+    rhs.inflation_cache_ =
+        std::make_shared<game_engine::Map3D::InflationCache>();
 
     if (node["obstacles"]) {
       rhs.obstacles_ =
           node["obstacles"].as<std::vector<game_engine::Polyhedron>>();
     }
+    rhs.BuildObstacleTree();
+    rhs.boundary_cells_ = nullptr;
+    rhs.obstacle_cells_ = nullptr;
 
     return true;
   }
@@ -0,0 +1,74 @@
+#include "occupancy_bitmap.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace game_engine {
+OccupancyBitmap::OccupancyBitmap(const Eigen::AlignedBox3d& bounds,
+                                 const double resolution, const State initial)
+    : origin_(bounds.min()),
+      resolution_(resolution),
+      inverse_resolution_(1.0 / resolution) {
+  const Eigen::Array3d cells =
+      (bounds.sizes().array() * this->inverse_resolution_).ceil();
+  this->size_ = cells.max(1.0).cast<int>();
+
+  // Replicate the initial state into every cell of a word
+  uint64_t word = 0;
+  for (size_t idx = 0; idx < kCellsPerWord; ++idx) {
+    word |= static_cast<uint64_t>(initial) << (idx * kBitsPerCell);
+  }
+  const size_t num_cells = this->size_.cast<size_t>().prod();
+  this->words_.assign((num_cells + kCellsPerWord - 1) / kCellsPerWord, word);
+}
+
+OccupancyBitmap::State OccupancyBitmap::At(const Point3D& point) const {
+  const Eigen::Array3d cell =
+      ((point - this->origin_).array() * this->inverse_resolution_).floor();
+
+  // Written so that NaN coordinates also fall outside of the grid
+  if (false == (cell >= 0.0).all() ||
+      false == (cell < this->size_.cast<double>()).all()) {
+    return State::kUnknown;
+  }
+  return this->Get(cell.x(), cell.y(), cell.z());
+}
+
+OccupancyBitmap::State OccupancyBitmap::Get(const size_t x, const size_t y,
+                                            const size_t z) const {
+  const size_t idx = this->Index(x, y, z);
+  const size_t shift = (idx % kCellsPerWord) * kBitsPerCell;
+  return static_cast<State>((this->words_[idx / kCellsPerWord] >> shift) & 3);
+}
+
+void OccupancyBitmap::Set(const size_t x, const size_t y, const size_t z,
+                          const State state) {
+  const size_t idx = this->Index(x, y, z);
+  const size_t shift = (idx % kCellsPerWord) * kBitsPerCell;
+  uint64_t& word = this->words_[idx / kCellsPerWord];
+  word = (word & ~(uint64_t(3) << shift)) |
+         (static_cast<uint64_t>(state) << shift);
+}
+
+Eigen::AlignedBox3d OccupancyBitmap::CellBox(const size_t x, const size_t y,
+                                             const size_t z) const {
+  const Point3D min =
+      this->origin_ + this->resolution_ * Point3D(x, y, z);
+  return Eigen::AlignedBox3d(min,
+                             min + Point3D::Constant(this->resolution_));
+}
+
+void OccupancyBitmap::CellRange(const Eigen::AlignedBox3d& box,
+                                Eigen::Array3i& begin,
+                                Eigen::Array3i& end) const {
+  const Eigen::Array3d lo =
+      ((box.min() - this->origin_).array() * this->inverse_resolution_)
+          .floor();
+  const Eigen::Array3d hi =
+      ((box.max() - this->origin_).array() * this->inverse_resolution_)
+          .floor() + 1.0;
+  const Eigen::Array3d size = this->size_.cast<double>();
+  begin = lo.max(0.0).min(size).cast<int>();
+  end = hi.max(0.0).min(size).cast<int>();
+}
+}  // namespace game_engine
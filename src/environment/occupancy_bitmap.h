@@ -0,0 +1,64 @@
+#pragma once
+
+#include <Eigen/Geometry>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+#include "types.h"
+
+namespace game_engine {
+// An OccupancyBitmap records, for every cell of a regular 3D grid, what is
+// known about all of the points in that cell: that they are all free, that
+// they are all occupied, or neither. Each cell takes two bits, so a grid
+// over a whole arena fits in cache and a lookup is a single load.
+//
+// Unlike an OccupancyGrid3D, which samples cell centers for planning, the
+// bitmap is meant to be conservative. A cell that is not entirely free or
+// entirely occupied must be marked kUnknown, and the caller falls back to an
+// exact test.
+class OccupancyBitmap {
+ public:
+  enum class State : uint8_t { kUnknown = 0, kFree = 1, kOccupied = 2 };
+
+  // A grid of cubic cells with the given edge length that covers bounds.
+  // Every cell starts in state initial.
+  OccupancyBitmap(const Eigen::AlignedBox3d& bounds =
+                      Eigen::AlignedBox3d(Point3D::Zero(), Point3D::Zero()),
+                  const double resolution = 1.0,
+                  const State initial = State::kUnknown);
+
+  // State of the cell containing point. Points outside of the grid are
+  // kUnknown.
+  State At(const Point3D& point) const;
+
+  // State of the cell at the given grid indices
+  State Get(const size_t x, const size_t y, const size_t z) const;
+  void Set(const size_t x, const size_t y, const size_t z, const State state);
+
+  // Closed box covered by the cell at the given grid indices
+  Eigen::AlignedBox3d CellBox(const size_t x, const size_t y,
+                              const size_t z) const;
+
+  // Range [begin, end) of grid indices of the cells that intersect box
+  void CellRange(const Eigen::AlignedBox3d& box, Eigen::Array3i& begin,
+                 Eigen::Array3i& end) const;
+
+  double Resolution() const { return this->resolution_; }
+  const Eigen::Array3i& Size() const { return this->size_; }
+
+ private:
+  static constexpr size_t kBitsPerCell = 2;
+  static constexpr size_t kCellsPerWord = 64 / kBitsPerCell;
+
+  Point3D origin_;
+  double resolution_;
+  double inverse_resolution_;
+  Eigen::Array3i size_;
+  std::vector<uint64_t> words_;
+
+  size_t Index(const size_t x, const size_t y, const size_t z) const {
+    return (z * this->size_.y() + y) * this->size_.x() + x;
+  }
+};
+}  // namespace game_engine
@@ -82,7 +82,7 @@ bool OccupancyGrid3D::LoadFromMap(const Map3D& map, const double sample_delta,
   // map3D boundary is given by multiple planes.  The planes can be obtained
   // from Faces() method.
 
-  for (const Plane3D& plane : map.Boundary().Faces()) {
+  for (const Polyhedron::Face& plane : map.Boundary().Faces()) {
     for (const Line3D& edge : plane.Edges()) {
       // Each line3d object has a start point and end point.
       for (int i = 0; i < 2; i++) {
@@ -1,8 +1,9 @@
 #include <ros/ros.h>
 
 #include <Eigen/Dense>
-#include <csignal>
+#include <chrono>
 #include <cstdlib>
+#include <iostream>
 #include <map>
 #include <memory>
 #include <sstream>
@@ -15,11 +16,13 @@
 #include "goal_watchdog.h"
 #include "map3d.h"
 #include "mediation_layer.h"
+#include "periodic_scheduler.h"
 #include "quad_state.h"
 #include "quad_state_subscriber_node.h"
 #include "quad_state_watchdog.h"
 #include "safety_monitor.h"
 #include "safety_monitor_status.h"
+#include "signal_handler.h"
 #include "trajectory.h"
 #include "trajectory_publisher_node.h"
 #include "trajectory_server.h"
@@ -30,15 +33,9 @@
 
 using namespace game_engine;
 
-namespace {
-// Signal variable and handler
-volatile std::sig_atomic_t kill_program;
-void SigIntHandler(int sig) { kill_program = 1; }
-}  // namespace
-
 int main(int argc, char** argv) {
   // Configure sigint handler
-  std::signal(SIGINT, SigIntHandler);
+  InstallSigIntHandler();
 
   // Start ROS
   ros::init(argc, argv, "mediation_layer", ros::init_options::NoSigintHandler);
@@ -385,21 +382,22 @@ int main(int argc, char** argv) {
   auto red_balloon_watchdog = std::make_shared<BalloonWatchdog>();
   auto blue_balloon_watchdog = std::make_shared<BalloonWatchdog>();
 
-  std::thread red_balloon_watchdog_thread([&]() {
-    red_balloon_watchdog->Run(
-        red_balloon_status_publisher_node, red_balloon_status_subscriber_node,
-        red_balloon_position_publisher_node, quad_state_warden, quad_names,
-        red_balloon_position, red_balloon_position_new,
-        red_balloon_max_move_time, gen, "manual_red_pop");
-  });
+  // The watchdogs are periodic tasks that share one small pool of threads
+  PeriodicScheduler watchdog_scheduler;
 
-  std::thread blue_balloon_watchdog_thread([&]() {
-    blue_balloon_watchdog->Run(
-        blue_balloon_status_publisher_node, blue_balloon_status_subscriber_node,
-        blue_balloon_position_publisher_node, quad_state_warden, quad_names,
-        blue_balloon_position, blue_balloon_position_new,
-        blue_balloon_max_move_time, gen, "manual_blue_pop");
-  });
+  red_balloon_watchdog->Schedule(
+      watchdog_scheduler, red_balloon_status_publisher_node,
+      red_balloon_status_subscriber_node, red_balloon_position_publisher_node,
+      quad_state_warden, quad_names, red_balloon_position,
+      red_balloon_position_new, red_balloon_max_move_time, gen,
+      "manual_red_pop");
+
+  blue_balloon_watchdog->Schedule(
+      watchdog_scheduler, blue_balloon_status_publisher_node,
+      blue_balloon_status_subscriber_node, blue_balloon_position_publisher_node,
+      quad_state_warden, quad_names, blue_balloon_position,
+      blue_balloon_position_new, blue_balloon_max_move_time, gen,
+      "manual_blue_pop");
 
   // Status watchdogs
   auto quad_state_watchdog_status = std::make_shared<QuadStateWatchdogStatus>();
@@ -414,17 +412,14 @@ int main(int argc, char** argv) {
 
   auto quad_state_watchdog =
       std::make_shared<QuadStateWatchdog>(quad_safety_limits, joy_mode);
-  std::thread quad_state_watchdog_thread([&]() {
-    quad_state_watchdog->Run(quad_state_warden, quad_names,
-                             quad_state_watchdog_status, map);
-  });
+  quad_state_watchdog->Schedule(watchdog_scheduler, quad_state_warden,
+                                quad_names, quad_state_watchdog_status, map);
 
   auto trajectory_watchdog = std::make_shared<TrajectoryWatchdog>();
-  std::thread trajectory_watchdog_thread([&]() {
-    trajectory_watchdog->Run(quad_names, quad_state_warden,
-                             trajectory_warden_srv, trajectory_warden_pub,
-                             trajectory_watchdog_status);
-  });
+  trajectory_watchdog->Schedule(watchdog_scheduler, quad_names,
+                                quad_state_warden, trajectory_warden_srv,
+                                trajectory_warden_pub,
+                                trajectory_watchdog_status);
 
   //  auto safety_monitor = std::make_shared<SafetyMonitor>(revision_mode);
   //  std::thread safety_monitor_thread(
@@ -448,17 +443,22 @@ int main(int argc, char** argv) {
       std::make_shared<GoalStatusPublisherNode>(goal_status_topics["home"]);
   auto goal_watchdog = std::make_shared<GoalWatchdog>();
 
-  std::thread goal_watchdog_thread([&]() {
-    goal_watchdog->Run(goal_status_publisher_node, goal_status_subscriber_node,
-                       quad_state_warden, quad_names, goal_position);
-  });
+  goal_watchdog->Schedule(watchdog_scheduler, goal_status_publisher_node,
+                          goal_status_subscriber_node, quad_state_warden,
+                          quad_names, goal_position);
+
+  std::thread watchdog_thread([&]() { watchdog_scheduler.Run(); });
 
   // Mediation layer thread. The mediation layer runs continuously, forward
   // integrating the proposed trajectories and modifying them so that the
   // various agents will not crash into each other. Data is asynchonously read
   // and written from the TrajectoryWardens
-  auto mediation_layer =
-      std::make_shared<MediationLayer>(quad_safety_limits, joy_mode);
+  // Optionally cut rejected trajectories short at their longest safe prefix
+  MediationLayer::Options mediation_layer_options;
+  nh.param("truncate_rejected_trajectories",
+           mediation_layer_options.truncate_rejected, false);
+  auto mediation_layer = std::make_shared<MediationLayer>(
+      quad_safety_limits, joy_mode, mediation_layer_options);
   std::thread mediation_layer_thread([&]() {
     mediation_layer->Run(map, trajectory_warden_srv, trajectory_warden_pub,
                          quad_state_warden, quad_state_watchdog_status,
@@ -466,28 +466,18 @@ int main(int argc, char** argv) {
                          trajectory_publishers);
   });
 
-  // Kill program thread. This thread sleeps for a second and then checks if the
-  // 'kill_program' variable has been set. If it has, it shuts ros down and
-  // sends stop signals to any other threads that might be running.
+  // Kill program thread. This thread blocks until SIGINT is received. It then
+  // shuts ros down and sends stop signals to any other threads that might be
+  // running.
   std::thread kill_thread([&]() {
-    while (true) {
-      if (true == kill_program) {
-        break;
-      } else {
-        std::this_thread::sleep_for(std::chrono::milliseconds(1000));
-      }
-    }
+    AwaitSigInt();
     ros::shutdown();
 
     mediation_layer->Stop();
     trajectory_warden_srv->Stop();
     trajectory_warden_pub->Stop();
     quad_state_warden->Stop();
-    red_balloon_watchdog->Stop();
-    blue_balloon_watchdog->Stop();
-    goal_watchdog->Stop();
-    quad_state_watchdog->Stop();
-    trajectory_watchdog->Stop();
+    watchdog_scheduler.Stop();
     //        safety_monitor->Stop();
   });
 
@@ -499,12 +489,17 @@ int main(int argc, char** argv) {
 
   // Wait for other threads to die
   mediation_layer_thread.join();
-  red_balloon_watchdog_thread.join();
-  blue_balloon_watchdog_thread.join();
-  goal_watchdog_thread.join();
-  quad_state_watchdog_thread.join();
-  trajectory_watchdog_thread.join();
+  watchdog_thread.join();
   //  safety_monitor_thread.join();
 
+  for (const PeriodicScheduler::TaskStats& stats : watchdog_scheduler.Stats()) {
+    std::cout << stats.name << ": " << stats.runs << " runs, "
+              << stats.deadline_misses << " missed deadlines, max "
+              << std::chrono::duration_cast<std::chrono::microseconds>(
+                     stats.max_execution_time)
+                     .count()
+              << " us" << std::endl;
+  }
+
   return EXIT_SUCCESS;
 }
@@ -1,7 +1,6 @@
 #include <ros/ros.h>
 
 #include <Eigen/Dense>
-#include <csignal>
 #include <cstdlib>
 #include <memory>
 #include <sstream>
@@ -22,6 +21,7 @@
 #include "quad_state.h"
 #include "quad_state_subscriber_node.h"
 #include "research-autonomy-protocols/multi_quad_autonomy_protocol.h"
+#include "signal_handler.h"
 #include "trajectory.h"
 #include "trajectory_client.h"
 #include "warden.h"
@@ -29,15 +29,9 @@
 
 using namespace game_engine;
 
-namespace {
-// Signal variable and handler
-volatile std::sig_atomic_t kill_program;
-void SigIntHandler(int sig) { kill_program = 1; }
-}  // namespace
-
 int main(int argc, char** argv) {
   // Configure sigint handler
-  std::signal(SIGINT, SigIntHandler);
+  InstallSigIntHandler();
 
   // Start ROS
   ros::init(argc, argv, "multi_quad_autonomy_protocol",
@@ -329,13 +323,7 @@ int main(int argc, char** argv) {
 
   // Start the kill thread
   std::thread kill_thread([&]() {
-    while (true) {
-      if (true == kill_program) {
-        break;
-      } else {
-        std::this_thread::sleep_for(std::chrono::milliseconds(1000));
-      }
-    }
+    AwaitSigInt();
 
     ros::shutdown();
 
@@ -1,7 +1,6 @@
 #include <ros/ros.h>
 
 #include <Eigen/Dense>
-#include <csignal>
 #include <cstdlib>
 #include <map>
 #include <memory>
@@ -16,6 +15,7 @@
 #include "physics_simulator.h"
 #include "quad_state.h"
 #include "quad_state_publisher_node.h"
+#include "signal_handler.h"
 #include "trajectory.h"
 #include "trajectory_subscriber_node.h"
 #include "warden.h"
@@ -24,15 +24,9 @@
 
 using namespace game_engine;
 
-namespace {
-// Signal variable and handler
-volatile std::sig_atomic_t kill_program;
-void SigIntHandler(int sig) { kill_program = 1; }
-}  // namespace
-
 int main(int argc, char** argv) {
   // Configure sigint handler
-  std::signal(SIGINT, SigIntHandler);
+  InstallSigIntHandler();
 
   // Start ROS
   ros::init(argc, argv, "physics_simulator",
@@ -171,17 +165,11 @@ int main(int argc, char** argv) {
     physics_simulator->Run(trajectory_warden_sub, quad_state_publishers, seed);
   });
 
-  // Kill program thread. This thread sleeps for a second and then checks if the
-  // 'kill_program' variable has been set. If it has, it shuts ros down and
-  // sends stop signals to any other threads that might be running.
+  // Kill program thread. This thread blocks until SIGINT is received. It then
+  // shuts ros down and sends stop signals to any other threads that might be
+  // running.
   std::thread kill_thread([&]() {
-    while (true) {
-      if (true == kill_program) {
-        break;
-      } else {
-        std::this_thread::sleep_for(std::chrono::milliseconds(1000));
-      }
-    }
+    AwaitSigInt();
     ros::shutdown();
 
     trajectory_warden_sub->Stop();
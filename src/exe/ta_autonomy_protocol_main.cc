@@ -2,7 +2,6 @@
 #include <string>
 #include <vector>
 #include <memory>
-#include <csignal>
 #include <Eigen/Dense>
 #include <ros/ros.h>
 #include <sstream>
@@ -10,6 +9,7 @@
 #include "yaml-cpp/yaml.h"
 #include "map3d.h"
 
+#include "signal_handler.h"
 #include "warden.h"
 #include "trajectory.h"
 #include "trajectory_client.h"
@@ -34,17 +34,9 @@
 
 using namespace game_engine;
 
-namespace {
-  // Signal variable and handler
-  volatile std::sig_atomic_t kill_program;
-  void SigIntHandler(int sig) {
-    kill_program = 1;
-  }
-}
-
 int main(int argc, char** argv) {
   // Configure sigint handler
-  std::signal(SIGINT, SigIntHandler);
+  InstallSigIntHandler();
 
   // Start ROS
   ros::init(argc, argv, "student_autonomy_protocol", ros::init_options::NoSigintHandler);
@@ -318,13 +310,7 @@ int main(int argc, char** argv) {
   // Start the kill thread
   std::thread kill_thread(
       [&]() {
-        while(true) {
-          if(true == kill_program) {
-            break;
-          } else {
-            std::this_thread::sleep_for(std::chrono::milliseconds(1000));
-          }
-        }
+        AwaitSigInt();
 
         ros::shutdown();
 
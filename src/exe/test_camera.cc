@@ -1,7 +1,6 @@
 #include <ros/ros.h>
 
 #include <Eigen/Dense>
-#include <csignal>
 #include <cstdlib>
 #include <memory>
 #include <sstream>
@@ -15,19 +14,15 @@
 #include "goal_status.h"
 #include "goal_status_publisher_node.h"
 #include "goal_status_subscriber_node.h"
+#include "signal_handler.h"
+#include "stop_token.h"
 #include "yaml-cpp/yaml.h"
 
 using namespace game_engine;
 
-namespace {
-// Signal variable and handler
-volatile std::sig_atomic_t kill_program;
-void SigIntHandler(int sig) { kill_program = 1; }
-}  // namespace
-
 class CameraHandler {
  protected:
-  volatile std::atomic<bool> ok_{true};
+  StopSource stop_source_;
 
  public:
   CameraHandler() {}
@@ -46,25 +41,28 @@ class CameraHandler {
            Eigen::Vector3d setStartPositionRed);
 };
 
-inline void CameraHandler::Stop() { ok_ = false; }
+inline void CameraHandler::Stop() { this->stop_source_.RequestStop(); }
 inline void CameraHandler::Run(std::shared_ptr<BalloonPositionPublisherNode>
                                    blue_balloon_position_publisher,
                                Eigen::Vector3d setStartPositionBlue,
                                std::shared_ptr<BalloonPositionPublisherNode>
                                    red_balloon_position_publisher,
                                Eigen::Vector3d setStartPositionRed) {
-  while (ok_) {
+  const StopToken stop_token = this->stop_source_.Token();
+  while (false == stop_token.StopRequested()) {
     blue_balloon_position_publisher->Publish(setStartPositionBlue);
     red_balloon_position_publisher->Publish(setStartPositionRed);
     std::cout << "red position: " << setStartPositionRed << std::endl;
     std::cout << "blue position: " << setStartPositionBlue << std::endl;
-    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    stop_token.WaitFor(std::chrono::milliseconds(50));
   }
+
+  this->stop_source_.Reset();
 }
 
 int main(int argc, char** argv) {
   // Configure sigint handler
-  std::signal(SIGINT, SigIntHandler);
+  InstallSigIntHandler();
 
   // Start ROS
   ros::init(argc, argv, "test_camera", ros::init_options::NoSigintHandler);
@@ -132,13 +130,7 @@ int main(int argc, char** argv) {
 
   // Start the kill thread
   std::thread kill_thread([&]() {
-    while (true) {
-      if (true == kill_program) {
-        break;
-      } else {
-        std::this_thread::sleep_for(std::chrono::milliseconds(1000));
-      }
-    }
+    AwaitSigInt();
 
     ros::shutdown();
     camera_handler->Stop();
@@ -1,7 +1,6 @@
 #include <ros/ros.h>
 
 #include <Eigen/Dense>
-#include <csignal>
 #include <cstdlib>
 #include <map>
 #include <memory>
@@ -17,21 +16,16 @@
 #include "quad_state.h"
 #include "quad_state_subscriber_node.h"
 #include "quad_state_watchdog.h"
+#include "signal_handler.h"
 #include "trajectory_visualizer_node.h"
 #include "view_manager.h"
 #include "yaml-cpp/yaml.h"
 
 using namespace game_engine;
 
-namespace {
-// Signal variable and handler
-volatile std::sig_atomic_t kill_program;
-void SigIntHandler(int sig) { kill_program = 1; }
-}  // namespace
-
 int main(int argc, char** argv) {
   // Configure sigint handler
-  std::signal(SIGINT, SigIntHandler);
+  InstallSigIntHandler();
 
   // Start ROS
   ros::init(argc, argv, "visualizer", ros::init_options::NoSigintHandler);
@@ -249,17 +243,11 @@ int main(int argc, char** argv) {
                       trajectory_view_options);
   });
 
-  // Kill program thread. This thread sleeps for a second and then checks if the
-  // 'kill_program' variable has been set. If it has, it shuts ros down and
-  // sends stop signals to any other threads that might be running.
+  // Kill program thread. This thread blocks until SIGINT is received. It then
+  // shuts ros down and sends stop signals to any other threads that might be
+  // running.
   std::thread kill_thread([&]() {
-    while (true) {
-      if (true == kill_program) {
-        break;
-      } else {
-        std::this_thread::sleep_for(std::chrono::milliseconds(1000));
-      }
-    }
+    AwaitSigInt();
     ros::shutdown();
 
     view_manager->Stop();
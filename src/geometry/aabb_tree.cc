@@ -0,0 +1,58 @@
+#include "aabb_tree.h"
+
+#include <algorithm>
+
+namespace game_engine {
+AabbTree::AabbTree(const std::vector<Box>& boxes) : boxes_(boxes) {
+  if (true == this->boxes_.empty()) {
+    return;
+  }
+
+  this->indices_.resize(this->boxes_.size());
+  for (size_t idx = 0; idx < this->indices_.size(); ++idx) {
+    this->indices_[idx] = idx;
+  }
+
+  // A binary tree with at least one box per leaf has fewer than 2n nodes
+  this->nodes_.reserve(2 * this->boxes_.size());
+  this->nodes_.emplace_back();
+  this->Build(0, 0, this->indices_.size());
+}
+
+void AabbTree::Build(const size_t node_idx, const size_t begin,
+                     const size_t end) {
+  Box box;
+  Box centroids;
+  for (size_t idx = begin; idx < end; ++idx) {
+    box.extend(this->boxes_[this->indices_[idx]]);
+    centroids.extend(this->boxes_[this->indices_[idx]].center());
+  }
+  this->nodes_[node_idx].box = box;
+
+  if (end - begin <= kMaxLeafSize) {
+    this->nodes_[node_idx].begin = begin;
+    this->nodes_[node_idx].count = end - begin;
+    return;
+  }
+
+  // Split at the median centroid along the axis in which the centroids are
+  // most spread out. Median splits keep the tree balanced, so its depth is
+  // logarithmic and the query stack cannot overflow.
+  Eigen::Vector3d::Index axis;
+  centroids.sizes().maxCoeff(&axis);
+  const size_t middle = begin + (end - begin) / 2;
+  std::nth_element(
+      this->indices_.begin() + begin, this->indices_.begin() + middle,
+      this->indices_.begin() + end, [&](const size_t lhs, const size_t rhs) {
+        return this->boxes_[lhs].center()(axis) <
+               this->boxes_[rhs].center()(axis);
+      });
+
+  const size_t child = this->nodes_.size();
+  this->nodes_[node_idx].child = child;
+  this->nodes_.emplace_back();
+  this->nodes_.emplace_back();
+  this->Build(child, begin, middle);
+  this->Build(child + 1, middle, end);
+}
+}  // namespace game_engine
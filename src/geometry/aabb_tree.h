@@ -0,0 +1,81 @@
+#pragma once
+
+#include <Eigen/Geometry>
+#include <cstdlib>
+#include <vector>
+
+namespace game_engine {
+// An AabbTree is a bounding volume hierarchy over a fixed set of axis-aligned
+// boxes. It answers which boxes intersect a query region while only visiting
+// boxes near the region. The tree is built once and is immutable, so it may be
+// queried from multiple threads.
+class AabbTree {
+ public:
+  using Box = Eigen::AlignedBox3d;
+
+  // Build a tree over the boxes. Query results are indices into boxes.
+  AabbTree(const std::vector<Box>& boxes = {});
+
+  // Invoke visitor with the index of every box that intersects the region.
+  // The visitor returns true to continue and false to end the query early.
+  // Returns false if the query was ended early.
+  template <class Visitor>
+  bool Query(const Box& region, Visitor&& visitor) const;
+
+  size_t Size() const { return this->boxes_.size(); }
+
+ private:
+  // Leaves reference the range [begin, begin + count) of indices_. Interior
+  // nodes have count == 0 and children at child and child + 1.
+  struct Node {
+    Box box;
+    size_t child = 0;
+    size_t begin = 0;
+    size_t count = 0;
+  };
+
+  static constexpr size_t kMaxLeafSize = 4;
+
+  std::vector<Box> boxes_;
+  std::vector<size_t> indices_;
+  std::vector<Node> nodes_;
+
+  // Build the subtree over indices_[begin, end) into nodes_[node_idx]
+  void Build(const size_t node_idx, const size_t begin, const size_t end);
+};
+
+//  ******************
+//  * IMPLEMENTATION *
+//  ******************
+template <class Visitor>
+bool AabbTree::Query(const Box& region, Visitor&& visitor) const {
+  if (true == this->nodes_.empty()) {
+    return true;
+  }
+
+  size_t stack[64];
+  size_t stack_size = 0;
+  stack[stack_size++] = 0;
+  while (0 < stack_size) {
+    const Node& node = this->nodes_[stack[--stack_size]];
+    if (false == node.box.intersects(region)) {
+      continue;
+    }
+
+    if (0 == node.count) {
+      stack[stack_size++] = node.child;
+      stack[stack_size++] = node.child + 1;
+      continue;
+    }
+
+    for (size_t idx = node.begin; idx < node.begin + node.count; ++idx) {
+      const size_t box_idx = this->indices_[idx];
+      if (true == this->boxes_[box_idx].intersects(region) &&
+          false == visitor(box_idx)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+}  // namespace game_engine
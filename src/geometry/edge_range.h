@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+
+#include "line3d.h"
+#include "types.h"
+
+namespace game_engine {
+// An EdgeRange is a view of the edges of a closed polygon whose vertices are
+// stored elsewhere. Edge idx runs from vertex idx to vertex idx + 1, and the
+// last edge returns to the first vertex. Edges are built when accessed, so a
+// range is only valid for as long as the vertices it views.
+//
+// Vertex idx of the polygon is vertices[indices[idx]], or vertices[idx] if
+// indices is null.
+class EdgeRange {
+ public:
+  class Iterator;
+
+  EdgeRange(const Point3D* vertices = nullptr, const size_t* indices = nullptr,
+            const size_t size = 0)
+      : vertices_(vertices), indices_(indices), size_(size) {}
+
+  // Number of edges, which is also the number of vertices
+  size_t size() const { return this->size_; }
+  bool empty() const { return 0 == this->size_; }
+
+  const Point3D& Vertex(const size_t idx) const {
+    return this->vertices_[nullptr == this->indices_ ? idx
+                                                     : this->indices_[idx]];
+  }
+
+  Line3D operator[](const size_t idx) const {
+    const size_t next = (idx + 1 == this->size_) ? 0 : idx + 1;
+    return Line3D(this->Vertex(idx), this->Vertex(next));
+  }
+
+  Iterator begin() const;
+  Iterator end() const;
+
+ private:
+  const Point3D* vertices_;
+  const size_t* indices_;
+  size_t size_;
+};
+
+// Iterators hold a copy of the range, so they remain valid after the range
+// itself is destroyed
+class EdgeRange::Iterator {
+ public:
+  using iterator_category = std::input_iterator_tag;
+  using value_type = Line3D;
+  using difference_type = std::ptrdiff_t;
+  using pointer = void;
+  using reference = Line3D;
+
+  Iterator(const EdgeRange& range, const size_t idx)
+      : range_(range), idx_(idx) {}
+
+  Line3D operator*() const { return this->range_[this->idx_]; }
+
+  Iterator& operator++() {
+    ++this->idx_;
+    return *this;
+  }
+
+  Iterator operator++(int) {
+    Iterator previous = *this;
+    ++this->idx_;
+    return previous;
+  }
+
+  bool operator==(const Iterator& rhs) const {
+    return this->idx_ == rhs.idx_;
+  }
+  bool operator!=(const Iterator& rhs) const {
+    return this->idx_ != rhs.idx_;
+  }
+
+ private:
+  EdgeRange range_;
+  size_t idx_;
+};
+
+inline EdgeRange::Iterator EdgeRange::begin() const {
+  return Iterator(*this, 0);
+}
+
+inline EdgeRange::Iterator EdgeRange::end() const {
+  return Iterator(*this, this->size_);
+}
+}  // namespace game_engine
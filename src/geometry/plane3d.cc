@@ -1,6 +1,25 @@
 #include "plane3d.h"
 
 namespace game_engine {
+Plane3D::Plane3D(const std::vector<Line3D>& edges) {
+  this->vertices_.reserve(edges.size() + 1);
+  for (const Line3D& edge : edges) {
+    this->vertices_.push_back(edge.Start());
+  }
+
+  if (false == edges.empty() &&
+      edges.back().End() != edges.front().Start() &&
+      edges.back().End() != edges.back().Start()) {
+    this->vertices_.push_back(edges.back().End());
+  }
+}
+
+Plane3D Plane3D::FromVertices(const std::vector<Point3D>& vertices) {
+  Plane3D plane;
+  plane.vertices_ = vertices;
+  return plane;
+}
+
 Eigen::Vector4d Plane3D::Equation() const {
   // Determine the equation for the plane. The equation can be found in the
   // following manner:
@@ -8,21 +27,24 @@ Eigen::Vector4d Plane3D::Equation() const {
   //  2) A = v(0), B = v(1), C = v(2), D = dot(v, -point) where point is any
   //     point on the plane
   Eigen::Vector4d equation;
-  const Vec3D cross_vec =
-      this->edges_[0].AsVector().cross(this->edges_[1].AsVector());
+  const Vec3D cross_vec = this->NormalVector(false);
   equation(0) = cross_vec[0];
   equation(1) = cross_vec[1];
   equation(2) = cross_vec[2];
-  equation(3) = cross_vec.dot(-1 * this->edges_[0].Start());
+  equation(3) = cross_vec.dot(-1 * this->vertices_[0]);
   return equation;
 }
 
-const std::vector<Line3D>& Plane3D::Edges() const { return this->edges_; }
+EdgeRange Plane3D::Edges() const {
+  return EdgeRange(this->vertices_.data(), nullptr, this->vertices_.size());
+}
+
+const std::vector<Point3D>& Plane3D::Vertices() const {
+  return this->vertices_;
+}
 
 bool Plane3D::OnLeftSide(const Point3D& point) const {
-  return (point - this->edges_[0].Start())
-             .dot(this->edges_[0].AsVector().cross(
-                 this->edges_[1].AsVector())) > 0;
+  return (point - this->vertices_[0]).dot(this->NormalVector(false)) > 0;
 }
 
 Point3D Plane3D::ClosestPoint(const Point3D& point) const {
@@ -52,9 +74,8 @@ bool Plane3D::Contains(const Point3D& point) const {
     return false;
   }
 
-  const Vec3D normal =
-      this->edges_[0].AsVector().cross(this->edges_[1].AsVector());
-  for (const Line3D& edge : this->edges_) {
+  const Vec3D normal = this->NormalVector(false);
+  for (const Line3D& edge : this->Edges()) {
     if (0 > normal.dot((edge.AsVector()).cross((point - edge.Start())))) {
       return false;
     }
@@ -62,10 +83,9 @@ bool Plane3D::Contains(const Point3D& point) const {
   return true;
 }
 
-Vec3D Plane3D::NormalVector() const {
-  return this->edges_[0]
-      .AsVector()
-      .cross(this->edges_[1].AsVector())
-      .normalized();
+Vec3D Plane3D::NormalVector(const bool normalized) const {
+  const Vec3D normal = (this->vertices_[1] - this->vertices_[0])
+                           .cross(this->vertices_[2] - this->vertices_[1]);
+  return (true == normalized) ? normal.normalized() : normal;
 }
 }  // namespace game_engine
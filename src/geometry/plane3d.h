@@ -5,6 +5,7 @@
 #include <cmath>
 #include <vector>
 
+#include "edge_range.h"
 #include "line3d.h"
 #include "plane3d.h"
 #include "yaml-cpp/yaml.h"
@@ -21,21 +22,31 @@ namespace game_engine {
 //     edges points towards the center of the convex region
 //  3) All edges must lie on the same 3D plane
 //
+// Only the start point of each edge is stored. The end point of each edge is
+// taken to be the start point of the next edge. An open chain of edges is
+// closed by an edge from its last end point back to its first start point.
+//
 // TODO: Add checks for convex and closed properties
 class Plane3D {
  private:
-  // Edges defining the boundaries of the plane
-  std::vector<Line3D> edges_;
+  // Vertices of the boundary of the plane, in the order of the edges
+  std::vector<Point3D> vertices_;
 
   // Forward declare parser
   friend class YAML::convert<Plane3D>;
 
  public:
   // Constructor
-  Plane3D(const std::vector<Line3D>& edges = {}) : edges_(edges){};
+  Plane3D(const std::vector<Line3D>& edges = {});
+
+  // Builds a plane from the start points of its edges, in order
+  static Plane3D FromVertices(const std::vector<Point3D>& vertices);
+
+  // Edges accessor. Edges are built from the vertices when accessed.
+  EdgeRange Edges() const;
 
-  // Edges accessor
-  const std::vector<Line3D>& Edges() const;
+  // Vertices accessor
+  const std::vector<Point3D>& Vertices() const;
 
   // A point is on the left side of a plane if, given given a
   // counter-clockwise-ordered set of edges, the dot product between the
@@ -55,8 +66,9 @@ class Plane3D {
   // edges
   bool Contains(const Point3D& point) const;
 
-  // Returns the vector normal to the surface of the plane
-  Vec3D NormalVector() const;
+  // Returns the vector normal to the surface of the plane: the cross product
+  // of the first two edges, normalized unless requested otherwise
+  Vec3D NormalVector(const bool normalized = true) const;
 };
 }  // namespace game_engine
 
@@ -64,8 +76,13 @@ namespace YAML {
 template <>
 struct convert<game_engine::Plane3D> {
   static Node encode(const game_engine::Plane3D& rhs) {
+    std::vector<game_engine::Line3D> edges;
+    for (const game_engine::Line3D& edge : rhs.Edges()) {
+      edges.push_back(edge);
+    }
+
     Node node;
-    node.push_back(rhs.edges_);
+    node.push_back(edges);
     return node;
   }
 
@@ -80,7 +97,7 @@ struct convert<game_engine::Plane3D> {
       edges.push_back(node[idx].as<game_engine::Line3D>());
     }
 
-    rhs.edges_ = edges;
+    rhs = game_engine::Plane3D(edges);
     return true;
   }
 };
@@ -1,5 +1,7 @@
 #include "polygon.h"
 
+#include <algorithm>
+
 namespace game_engine {
 Polygon Polygon::Expand(double dist) const {
   // Find the arithmetic mean of the vertices. For a convex polygon,
@@ -49,41 +51,43 @@ bool Polygon::IsConvex() const {
 }
 
 void Polygon::ConvexHullFromPoints(const std::vector<Point2D>& points) {
-  std::vector<Point2D> vertices;
-
-  Point2D left_most_point;
-  double min_x = std::numeric_limits<double>::max();
-  for (const Point2D& point : points) {
-    if (point.x() < min_x) {
-      left_most_point = point;
-      min_x = point.x();
-    }
-  }
-  vertices.push_back(left_most_point);
-
-  Point2D from = left_most_point;
-  while (true) {
-    for (const Point2D& to : points) {
-      if (from == to) {
-        continue;
-      }
-      Line2D line(from, to);
-      bool all_points_left = true;
-      for (const Point2D& other : points) {
-        if (false == line.OnLeftSide(other)) {
-          all_points_left = false;
-          break;
-        }
-      }
-      if (true == all_points_left) {
-        vertices.push_back(to);
-        from = to;
-        break;
+  std::vector<Point2D> sorted = points;
+  const auto lexicographic = [](const Point2D& lhs, const Point2D& rhs) {
+    return lhs.x() < rhs.x() || (lhs.x() == rhs.x() && lhs.y() < rhs.y());
+  };
+  std::sort(sorted.begin(), sorted.end(), lexicographic);
+  sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+
+  // Positive if origin, a and b make a counter-clockwise turn
+  const auto cross = [](const Point2D& origin, const Point2D& a,
+                        const Point2D& b) {
+    return (a.x() - origin.x()) * (b.y() - origin.y()) -
+           (a.y() - origin.y()) * (b.x() - origin.x());
+  };
+
+  // The lower hull is built left to right and the upper hull right to left,
+  // each dropping points that do not make a counter-clockwise turn. The last
+  // point of the upper hull is the first point of the lower hull.
+  std::vector<Point2D> vertices(sorted);
+  if (3 <= sorted.size()) {
+    vertices.resize(2 * sorted.size());
+    size_t size = 0;
+    for (const Point2D& point : sorted) {
+      while (2 <= size &&
+             0 >= cross(vertices[size - 2], vertices[size - 1], point)) {
+        --size;
       }
+      vertices[size++] = point;
     }
-    if (left_most_point == vertices.back()) {
-      break;
+    const size_t lower_size = size;
+    for (size_t idx = sorted.size() - 1; idx-- > 0;) {
+      while (lower_size < size &&
+             0 >= cross(vertices[size - 2], vertices[size - 1], sorted[idx])) {
+        --size;
+      }
+      vertices[size++] = sorted[idx];
     }
+    vertices.resize(size - 1);
   }
 
   std::vector<Line2D> edges;
@@ -72,8 +72,12 @@ class Polygon {
   // Returns a rectangle that bounds this polygon
   Polygon BoundingBox() const;
 
-  // Constructs a convex polygon from the convex hull of a set of points.
-  // Reference: https://en.wikipedia.org/wiki/Gift_wrapping_algorithm
+  // Constructs a convex polygon from the convex hull of a set of points, in
+  // O(n log n) time. Vertices are counter-clockwise, starting from the
+  // lowest of the left-most points. Points on the boundary that are not
+  // corners are left out.
+  // Reference: Andrew, "Another efficient algorithm for convex hulls in two
+  // dimensions", Information Processing Letters 9(5), 1979
   void ConvexHullFromPoints(const std::vector<Point2D>& points);
 
   // Constructs the polygon from a list of points. When traversed, the list
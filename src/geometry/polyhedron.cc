@@ -1,11 +1,559 @@
 #include "polyhedron.h"
 
+#include <Eigen/Dense>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <numeric>
+#include <tuple>
+
 namespace game_engine {
-const std::vector<Plane3D>& Polyhedron::Faces() const { return this->faces_; }
+namespace {
+// Triangle of a convex hull under construction. Its vertices are
+// counter-clockwise when seen from outside of the hull, and neighbors[idx] is
+// the triangle across the edge from vertices[idx] to vertices[idx + 1].
+struct HullFace {
+  std::array<size_t, 3> vertices;
+  std::array<size_t, 3> neighbors;
+
+  // Outward unit normal. Points on the plane of the face satisfy
+  // normal.dot(point) == offset.
+  Vec3D normal;
+  double offset;
+
+  // Points that are above the face and not yet on the hull
+  std::vector<size_t> outside;
+
+  bool alive = true;
+  size_t visited = 0;
+};
+
+// Incremental quickhull. Starting from a tetrahedron, the point furthest
+// above any face is added to the hull by replacing every face it can see with
+// a cone of faces from the horizon of those faces to the point.
+class QuickHull {
+ public:
+  QuickHull(const std::vector<Point3D>& points);
+
+  // Returns the hull, or an empty polyhedron if the points do not span a
+  // volume
+  Polyhedron Build();
+
+ private:
+  const std::vector<Point3D>& points_;
+
+  // Points closer than this to the plane of a face are considered on it
+  double tolerance_;
+
+  // Faces are never removed, only marked dead, so indices remain valid
+  std::vector<HullFace> faces_;
+
+  // Visible faces and horizon edges of the point being added. Horizon edges
+  // are (face, edge) pairs of visible faces, in counter-clockwise order.
+  size_t step_ = 0;
+  std::vector<size_t> visible_;
+  std::vector<std::pair<size_t, size_t>> horizon_;
+
+  // Depth-first search state of FindHorizon(). A frame is a visible face,
+  // the next of its edges to visit, and how many edges remain.
+  struct HorizonFrame {
+    size_t face_idx;
+    size_t edge;
+    size_t remaining;
+  };
+  std::vector<HorizonFrame> horizon_stack_;
+
+  double Distance(const size_t face_idx, const size_t point_idx) const {
+    return this->faces_[face_idx].normal.dot(this->points_[point_idx]) -
+           this->faces_[face_idx].offset;
+  }
+
+  size_t AddFace(const size_t a, const size_t b, const size_t c);
+  bool AddSimplex();
+  void AddPoint(const size_t face_idx);
+  void FindHorizon(const size_t eye, const size_t face_idx);
+
+  // Adds point_idx to the outside set of the face in [begin, end) that it
+  // is furthest above, if any
+  void Assign(const size_t point_idx, const size_t begin, const size_t end);
+
+  // Merges coplanar triangles into polygons and builds the polyhedron
+  Polyhedron Extract() const;
+};
+
+QuickHull::QuickHull(const std::vector<Point3D>& points) : points_(points) {
+  Vec3D max_abs = Vec3D::Zero();
+  for (const Point3D& point : points) {
+    max_abs = max_abs.cwiseMax(point.cwiseAbs());
+  }
+  this->tolerance_ = 3 * std::numeric_limits<double>::epsilon() * max_abs.sum();
+}
+
+size_t QuickHull::AddFace(const size_t a, const size_t b, const size_t c) {
+  HullFace face;
+  face.vertices = {a, b, c};
+  face.neighbors = {0, 0, 0};
+  face.normal = (this->points_[b] - this->points_[a])
+                    .cross(this->points_[c] - this->points_[a])
+                    .normalized();
+  face.offset = face.normal.dot(this->points_[a]);
+  this->faces_.push_back(std::move(face));
+  return this->faces_.size() - 1;
+}
+
+bool QuickHull::AddSimplex() {
+  const std::vector<Point3D>& points = this->points_;
+
+  // The two points that are extreme along some axis and furthest apart
+  std::vector<size_t> extremes;
+  for (Eigen::Index axis = 0; axis < 3; ++axis) {
+    const auto less = [&](const Point3D& lhs, const Point3D& rhs) {
+      return lhs(axis) < rhs(axis);
+    };
+    const auto minmax = std::minmax_element(points.begin(), points.end(), less);
+    extremes.push_back(minmax.first - points.begin());
+    extremes.push_back(minmax.second - points.begin());
+  }
+  size_t a = 0, b = 0;
+  for (const size_t lhs : extremes) {
+    for (const size_t rhs : extremes) {
+      if ((points[lhs] - points[rhs]).norm() > (points[a] - points[b]).norm()) {
+        a = lhs;
+        b = rhs;
+      }
+    }
+  }
+  if ((points[a] - points[b]).norm() <= this->tolerance_) {
+    return false;
+  }
+
+  // The point furthest from the line through them
+  const Vec3D direction = (points[b] - points[a]).normalized();
+  size_t c = a;
+  double max_distance = 0;
+  for (size_t idx = 0; idx < points.size(); ++idx) {
+    const double distance = (points[idx] - points[a]).cross(direction).norm();
+    if (distance > max_distance) {
+      c = idx;
+      max_distance = distance;
+    }
+  }
+  if (max_distance <= this->tolerance_) {
+    return false;
+  }
+
+  // The point furthest from the plane through all three
+  const Vec3D normal =
+      (points[b] - points[a]).cross(points[c] - points[a]).normalized();
+  size_t d = a;
+  max_distance = 0;
+  for (size_t idx = 0; idx < points.size(); ++idx) {
+    const double distance = std::abs(normal.dot(points[idx] - points[a]));
+    if (distance > max_distance) {
+      d = idx;
+      max_distance = distance;
+    }
+  }
+  if (max_distance <= this->tolerance_) {
+    return false;
+  }
+
+  // Each face of the tetrahedron faces away from the vertex it omits
+  const std::array<size_t, 4> simplex = {a, b, c, d};
+  for (size_t omit = 0; omit < 4; ++omit) {
+    std::array<size_t, 3> vertices;
+    for (size_t idx = 0, count = 0; idx < 4; ++idx) {
+      if (idx != omit) {
+        vertices[count++] = simplex[idx];
+      }
+    }
+    const size_t face_idx = this->AddFace(vertices[0], vertices[1], vertices[2]);
+    if (this->Distance(face_idx, simplex[omit]) > 0) {
+      this->faces_.pop_back();
+      this->AddFace(vertices[0], vertices[2], vertices[1]);
+    }
+  }
+
+  for (HullFace& face : this->faces_) {
+    for (size_t edge = 0; edge < 3; ++edge) {
+      const size_t start = face.vertices[edge];
+      const size_t end = face.vertices[(edge + 1) % 3];
+      for (size_t other = 0; other < this->faces_.size(); ++other) {
+        const std::array<size_t, 3>& vertices = this->faces_[other].vertices;
+        for (size_t other_edge = 0; other_edge < 3; ++other_edge) {
+          if (end == vertices[other_edge] &&
+              start == vertices[(other_edge + 1) % 3]) {
+            face.neighbors[edge] = other;
+          }
+        }
+      }
+    }
+  }
+
+  for (size_t idx = 0; idx < points.size(); ++idx) {
+    if (simplex.end() == std::find(simplex.begin(), simplex.end(), idx)) {
+      this->Assign(idx, 0, this->faces_.size());
+    }
+  }
+  return true;
+}
+
+void QuickHull::Assign(const size_t point_idx, const size_t begin,
+                       const size_t end) {
+  size_t best_idx = end;
+  double max_distance = this->tolerance_;
+  for (size_t face_idx = begin; face_idx < end; ++face_idx) {
+    const double distance = this->Distance(face_idx, point_idx);
+    if (distance > max_distance) {
+      best_idx = face_idx;
+      max_distance = distance;
+    }
+  }
+  if (end != best_idx) {
+    this->faces_[best_idx].outside.push_back(point_idx);
+  }
+}
+
+void QuickHull::FindHorizon(const size_t eye, const size_t face_idx) {
+  // The search uses an explicit stack, since an eye that sees a large part of
+  // a big hull would otherwise recurse once per visible face. Edges are
+  // visited counter-clockwise, starting after the edge that was crossed to
+  // reach a face, so that the horizon is found in order.
+  this->faces_[face_idx].visited = this->step_;
+  this->visible_.push_back(face_idx);
+  this->horizon_stack_.clear();
+  this->horizon_stack_.push_back({face_idx, 0, 3});
+
+  while (false == this->horizon_stack_.empty()) {
+    HorizonFrame& frame = this->horizon_stack_.back();
+    if (0 == frame.remaining) {
+      this->horizon_stack_.pop_back();
+      continue;
+    }
+
+    const size_t current = frame.face_idx;
+    const size_t edge = frame.edge;
+    frame.edge = (frame.edge + 1) % 3;
+    --frame.remaining;
+
+    const size_t neighbor = this->faces_[current].neighbors[edge];
+    if (this->step_ == this->faces_[neighbor].visited) {
+      continue;
+    }
+
+    if (this->Distance(neighbor, eye) > this->tolerance_) {
+      size_t back = 0;
+      while (current != this->faces_[neighbor].neighbors[back]) {
+        ++back;
+      }
+      this->faces_[neighbor].visited = this->step_;
+      this->visible_.push_back(neighbor);
+      this->horizon_stack_.push_back({neighbor, (back + 1) % 3, 2});
+    } else {
+      this->horizon_.emplace_back(current, edge);
+    }
+  }
+}
+
+void QuickHull::AddPoint(const size_t face_idx) {
+  const std::vector<size_t>& outside = this->faces_[face_idx].outside;
+  const size_t eye = *std::max_element(
+      outside.begin(), outside.end(), [&](const size_t lhs, const size_t rhs) {
+        return this->Distance(face_idx, lhs) < this->Distance(face_idx, rhs);
+      });
+
+  ++this->step_;
+  this->visible_.clear();
+  this->horizon_.clear();
+  this->FindHorizon(eye, face_idx);
+
+  // Cone of new faces from the horizon to the eye. New face idx shares its
+  // edges from and to the eye with new faces idx + 1 and idx - 1.
+  const size_t first = this->faces_.size();
+  const size_t num_new = this->horizon_.size();
+  for (size_t idx = 0; idx < num_new; ++idx) {
+    const size_t visible_idx = this->horizon_[idx].first;
+    const size_t edge = this->horizon_[idx].second;
+    const size_t opposite = this->faces_[visible_idx].neighbors[edge];
+    const size_t new_idx =
+        this->AddFace(this->faces_[visible_idx].vertices[edge],
+                      this->faces_[visible_idx].vertices[(edge + 1) % 3], eye);
+    this->faces_[new_idx].neighbors = {opposite,
+                                       first + (idx + 1) % num_new,
+                                       first + (idx + num_new - 1) % num_new};
+    for (size_t& neighbor : this->faces_[opposite].neighbors) {
+      if (visible_idx == neighbor) {
+        neighbor = new_idx;
+      }
+    }
+  }
+
+  // Points above the visible faces are either above the new faces or inside
+  // of the hull
+  for (const size_t visible_idx : this->visible_) {
+    std::vector<size_t> points;
+    points.swap(this->faces_[visible_idx].outside);
+    this->faces_[visible_idx].alive = false;
+    for (const size_t point_idx : points) {
+      if (eye != point_idx) {
+        this->Assign(point_idx, first, this->faces_.size());
+      }
+    }
+  }
+}
+
+Polyhedron QuickHull::Build() {
+  if (this->points_.size() < 4 || false == this->AddSimplex()) {
+    return Polyhedron();
+  }
+
+  // Faces are processed depth-first. Faces that died while waiting are
+  // skipped.
+  std::vector<size_t> pending(this->faces_.size());
+  std::iota(pending.begin(), pending.end(), 0);
+  while (false == pending.empty()) {
+    const size_t face_idx = pending.back();
+    pending.pop_back();
+    if (false == this->faces_[face_idx].alive ||
+        true == this->faces_[face_idx].outside.empty()) {
+      continue;
+    }
+
+    const size_t first = this->faces_.size();
+    this->AddPoint(face_idx);
+    for (size_t new_idx = first; new_idx < this->faces_.size(); ++new_idx) {
+      pending.push_back(new_idx);
+    }
+  }
+
+  return this->Extract();
+}
+
+Polyhedron QuickHull::Extract() const {
+  // Union-find over the faces. Adjacent faces whose opposite vertices lie on
+  // each other's planes are merged into one polygon.
+  std::vector<size_t> parent(this->faces_.size());
+  std::iota(parent.begin(), parent.end(), 0);
+  const auto find = [&parent](size_t idx) {
+    while (parent[idx] != idx) {
+      parent[idx] = parent[parent[idx]];
+      idx = parent[idx];
+    }
+    return idx;
+  };
+
+  for (size_t face_idx = 0; face_idx < this->faces_.size(); ++face_idx) {
+    const HullFace& face = this->faces_[face_idx];
+    if (false == face.alive) {
+      continue;
+    }
+    for (size_t edge = 0; edge < 3; ++edge) {
+      const size_t neighbor_idx = face.neighbors[edge];
+      const HullFace& neighbor = this->faces_[neighbor_idx];
+      size_t back = 0;
+      while (face_idx != neighbor.neighbors[back]) {
+        ++back;
+      }
+      const size_t apex = face.vertices[(edge + 2) % 3];
+      const size_t neighbor_apex = neighbor.vertices[(back + 2) % 3];
+      if (face_idx < neighbor_idx && 0 < face.normal.dot(neighbor.normal) &&
+          std::abs(this->Distance(face_idx, neighbor_apex)) <=
+              this->tolerance_ &&
+          std::abs(this->Distance(neighbor_idx, apex)) <= this->tolerance_) {
+        parent[find(face_idx)] = find(neighbor_idx);
+      }
+    }
+  }
+
+  // Edges on the boundary of each polygon, as (polygon, start, end), where
+  // the boundary is counter-clockwise when seen from outside
+  std::vector<std::tuple<size_t, size_t, size_t>> boundary;
+  for (size_t face_idx = 0; face_idx < this->faces_.size(); ++face_idx) {
+    const HullFace& face = this->faces_[face_idx];
+    if (false == face.alive) {
+      continue;
+    }
+    const size_t polygon = find(face_idx);
+    for (size_t edge = 0; edge < 3; ++edge) {
+      if (polygon != find(face.neighbors[edge])) {
+        boundary.emplace_back(polygon, face.vertices[edge],
+                              face.vertices[(edge + 1) % 3]);
+      }
+    }
+  }
+  std::sort(boundary.begin(), boundary.end());
+
+  std::vector<Point3D> vertices;
+  std::map<size_t, size_t> vertex_indices;
+  std::vector<std::vector<size_t>> faces;
+  for (size_t begin = 0, end = 0; begin < boundary.size(); begin = end) {
+    std::map<size_t, size_t> next;
+    for (end = begin; end < boundary.size() &&
+                      std::get<0>(boundary[end]) == std::get<0>(boundary[begin]);
+         ++end) {
+      next[std::get<1>(boundary[end])] = std::get<2>(boundary[end]);
+    }
+
+    std::vector<size_t> loop;
+    size_t vertex = std::get<1>(boundary[begin]);
+    do {
+      loop.push_back(vertex);
+      vertex = next[vertex];
+    } while (vertex != loop.front() && loop.size() <= next.size());
+
+    // Polyhedron faces are clockwise when seen from outside. Vertices that
+    // are collinear with their neighbors are dropped.
+    std::vector<size_t> face;
+    for (size_t idx = loop.size(); idx-- > 0;) {
+      const Point3D& previous = this->points_[loop[(idx + 1) % loop.size()]];
+      const Point3D& current = this->points_[loop[idx]];
+      const Point3D& following =
+          this->points_[loop[(idx + loop.size() - 1) % loop.size()]];
+      const Vec3D in = current - previous;
+      const Vec3D out = following - current;
+      if (in.cross(out).norm() <=
+          this->tolerance_ * std::max(in.norm(), out.norm())) {
+        continue;
+      }
+
+      const auto inserted = vertex_indices.emplace(loop[idx], vertices.size());
+      if (true == inserted.second) {
+        vertices.push_back(current);
+      }
+      face.push_back(inserted.first->second);
+    }
+    if (3 <= face.size()) {
+      faces.push_back(face);
+    }
+  }
+
+  return Polyhedron(vertices, faces);
+}
+}  // namespace
+
+EdgeRange Polyhedron::Face::Edges() const {
+  const size_t begin = this->polyhedron_->face_begin_[this->idx_];
+  const size_t end = this->polyhedron_->face_begin_[this->idx_ + 1];
+  return EdgeRange(this->polyhedron_->vertices_.data(),
+                   this->polyhedron_->face_indices_.data() + begin,
+                   end - begin);
+}
+
+Plane3D Polyhedron::Face::ToPlane3D() const {
+  const EdgeRange edges = this->Edges();
+  std::vector<Point3D> vertices;
+  vertices.reserve(edges.size());
+  for (size_t idx = 0; idx < edges.size(); ++idx) {
+    vertices.push_back(edges.Vertex(idx));
+  }
+  return Plane3D::FromVertices(vertices);
+}
+
+Polyhedron::Polyhedron(const std::vector<Plane3D>& faces) {
+  this->BuildMesh(faces);
+  this->BuildHalfSpaces();
+}
+
+Polyhedron::Polyhedron(const std::vector<Point3D>& vertices,
+                       const std::vector<std::vector<size_t>>& faces)
+    : vertices_(vertices) {
+  this->face_begin_.reserve(faces.size() + 1);
+  this->face_begin_.push_back(0);
+  for (const std::vector<size_t>& face : faces) {
+    this->face_indices_.insert(this->face_indices_.end(), face.begin(),
+                               face.end());
+    this->face_begin_.push_back(this->face_indices_.size());
+  }
+  this->BuildHalfSpaces();
+}
+
+Polyhedron::FaceRange Polyhedron::Faces() const { return FaceRange(this); }
+
+const std::vector<Point3D>& Polyhedron::Vertices() const {
+  return this->vertices_;
+}
+
+void Polyhedron::BuildMesh(const std::vector<Plane3D>& faces) {
+  const auto lexicographic = [](const Point3D& lhs, const Point3D& rhs) {
+    return std::lexicographical_compare(lhs.data(), lhs.data() + 3,
+                                        rhs.data(), rhs.data() + 3);
+  };
+  std::map<Point3D, size_t, decltype(lexicographic)> indices(lexicographic);
+
+  this->vertices_.clear();
+  this->face_indices_.clear();
+  this->face_begin_.assign(1, 0);
+  for (const Plane3D& face : faces) {
+    for (const Point3D& vertex : face.Vertices()) {
+      const auto inserted = indices.emplace(vertex, this->vertices_.size());
+      if (true == inserted.second) {
+        this->vertices_.push_back(vertex);
+      }
+      this->face_indices_.push_back(inserted.first->second);
+    }
+    this->face_begin_.push_back(this->face_indices_.size());
+  }
+}
+
+void Polyhedron::BuildHalfSpaces() {
+  const size_t num_faces = this->face_begin_.size() - 1;
+  this->normals_.resize(num_faces, 3);
+  this->offsets_.resize(num_faces);
+  for (size_t idx = 0; idx < num_faces; ++idx) {
+    const size_t* loop = this->face_indices_.data() + this->face_begin_[idx];
+    const Point3D& v0 = this->vertices_[loop[0]];
+    const Point3D& v1 = this->vertices_[loop[1]];
+    const Point3D& v2 = this->vertices_[loop[2]];
+    const Vec3D normal = (v1 - v0).cross(v2 - v1).normalized();
+    this->normals_.row(idx) = normal.transpose();
+    this->offsets_(idx) = normal.dot(v0);
+  }
+
+  this->BuildVertexDirections();
+}
+
+void Polyhedron::BuildVertexDirections() {
+  // A vertex stays on the planes of its faces as they move outwards at unit
+  // speed if its direction d satisfies normal.dot(d) == -1 for each of them.
+  // The least-squares solution is exact for vertices where three faces meet,
+  // and for any vertex whose faces have redundant planes.
+  const size_t num_faces = this->face_begin_.size() - 1;
+  std::vector<Eigen::Matrix3d> gram(this->vertices_.size(),
+                                    Eigen::Matrix3d::Zero());
+  this->vertex_directions_.setZero(this->vertices_.size(), 3);
+  for (size_t face_idx = 0; face_idx < num_faces; ++face_idx) {
+    const Vec3D normal = this->normals_.row(face_idx).transpose();
+    for (size_t idx = this->face_begin_[face_idx];
+         idx < this->face_begin_[face_idx + 1]; ++idx) {
+      const size_t vertex_idx = this->face_indices_[idx];
+      gram[vertex_idx] += normal * normal.transpose();
+      this->vertex_directions_.row(vertex_idx) -= normal.transpose();
+    }
+  }
+  for (size_t idx = 0; idx < this->vertices_.size(); ++idx) {
+    const Vec3D rhs = this->vertex_directions_.row(idx).transpose();
+    this->vertex_directions_.row(idx) =
+        gram[idx].completeOrthogonalDecomposition().solve(rhs).transpose();
+  }
+
+  this->bounding_box_.setEmpty();
+  for (const Point3D& vertex : this->vertices_) {
+    this->bounding_box_.extend(vertex);
+  }
+}
 
 bool Polyhedron::Contains(const Point3D& point) const {
-  for (const Plane3D& face : this->faces_) {
-    if (false == face.OnLeftSide(point)) {
+  // A point outside of the bounding box cannot be on the left side of every
+  // face
+  if (0 < this->normals_.rows() &&
+      false == this->bounding_box_.contains(point)) {
+    return false;
+  }
+
+  for (Eigen::Index idx = 0; idx < this->normals_.rows(); ++idx) {
+    if (false == (this->normals_.row(idx).dot(point) > this->offsets_(idx))) {
       return false;
     }
   }
@@ -13,30 +561,116 @@ bool Polyhedron::Contains(const Point3D& point) const {
   return true;
 }
 
-bool Polyhedron::IsConvex() const {
-  std::cerr << "Polyhedron::IsConvex() is not yet implemented!" << std::endl;
-  std::exit(EXIT_FAILURE);
+std::vector<bool> Polyhedron::ContainsBatch(
+    const std::vector<Point3D>& points) const {
+  // Points are tested in blocks so that the matrix of distances from every
+  // face stays in cache. The vector may be empty, so its storage is mapped
+  // without dereferencing data().
+  constexpr Eigen::Index kBlockSize = 256;
+  const Eigen::Map<const Eigen::Matrix<double, 3, Eigen::Dynamic>> matrix(
+      reinterpret_cast<const double*>(points.data()), 3, points.size());
+
+  std::vector<bool> contained(points.size());
+  Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic> distances;
+  for (Eigen::Index begin = 0; begin < matrix.cols(); begin += kBlockSize) {
+    const Eigen::Index size = std::min(kBlockSize, matrix.cols() - begin);
+    distances.noalias() = this->normals_ * matrix.middleCols(begin, size);
+    distances.colwise() -= this->offsets_;
+    const auto inside = (distances.array() > 0).colwise().all();
+    for (Eigen::Index idx = 0; idx < size; ++idx) {
+      contained[begin + idx] = inside(idx);
+    }
+  }
+  return contained;
+}
+
+bool Polyhedron::IntersectsSegment(const Point3D& start,
+                                   const Point3D& end) const {
+  // The segment is start + t * (end - start) for t in [0, 1]. Each face
+  // restricts t to the side of its plane where OnLeftSide() holds. The
+  // segment intersects the polyhedron if the restrictions leave an interval.
+  double t_enter = 0.0;
+  double t_exit = 1.0;
+  for (Eigen::Index idx = 0; idx < this->normals_.rows(); ++idx) {
+    const double start_distance =
+        this->normals_.row(idx).dot(start) - this->offsets_(idx);
+    const double end_distance =
+        this->normals_.row(idx).dot(end) - this->offsets_(idx);
+
+    if (start_distance <= 0 && end_distance <= 0) {
+      return false;
+    }
+    if (start_distance > 0 && end_distance > 0) {
+      continue;
+    }
+
+    const double t = start_distance / (start_distance - end_distance);
+    if (start_distance <= 0) {
+      t_enter = std::max(t_enter, t);
+    } else {
+      t_exit = std::min(t_exit, t);
+    }
 
-  return false;
+    if (t_enter >= t_exit) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+Polyhedron::Overlap Polyhedron::Classify(
+    const Eigen::AlignedBox3d& box) const {
+  const Point3D center = box.center();
+  const Vec3D half_sizes = box.sizes() / 2;
+
+  bool inside = true;
+  for (Eigen::Index idx = 0; idx < this->normals_.rows(); ++idx) {
+    // The signed distance used by Contains() is linear, so its extremes
+    // over the box lie within radius of its value at the center. The margin
+    // is far larger than the rounding error of Contains().
+    const Vec3D normal = this->normals_.row(idx).transpose();
+    const double distance = normal.dot(center) - this->offsets_(idx);
+    const double radius = half_sizes.dot(normal.cwiseAbs());
+    const double margin =
+        1e-9 * (1.0 + center.lpNorm<Eigen::Infinity>() +
+                half_sizes.maxCoeff() + std::abs(this->offsets_(idx)));
+
+    if (distance + radius + margin <= 0) {
+      return Overlap::kOutside;
+    }
+    if (distance - radius - margin <= 0) {
+      inside = false;
+    }
+  }
+
+  return (true == inside) ? Overlap::kInside : Overlap::kPartial;
+}
+
+Eigen::AlignedBox3d Polyhedron::BoundingBox() const {
+  return this->bounding_box_;
+}
+
+bool Polyhedron::IsConvex() const {
+  return 0 < this->normals_.rows() && true == this->VerticesOnPlanes() &&
+         true == this->VerticesInside();
 }
 
 Polyhedron Polyhedron::ConvexHull() const {
-  std::cerr << "Polyhedron::ConvexHull() is not yet implemented!" << std::endl;
-  std::exit(EXIT_FAILURE);
+  return ConvexHullFromPoints(this->vertices_);
+}
 
-  return Polyhedron();
+Polyhedron Polyhedron::ConvexHullFromPoints(
+    const std::vector<Point3D>& points) {
+  return QuickHull(points).Build();
 }
 
 Point3D Polyhedron::InteriorPoint() const {
   Point3D sum(0, 0, 0);
-  size_t counter = 0;
-  for (const Plane3D& face : this->Faces()) {
-    for (const Line3D edge : face.Edges()) {
-      sum = sum + edge.Start() + edge.End();
-      counter += 2;
-    }
+  for (const Point3D& vertex : this->vertices_) {
+    sum += vertex;
   }
-  return sum / counter;
+  return sum / this->vertices_.size();
 }
 
 Polyhedron Polyhedron::Shrink(const double distance) const {
@@ -44,36 +678,198 @@ Polyhedron Polyhedron::Shrink(const double distance) const {
 }
 
 Polyhedron Polyhedron::Expand(const double distance) const {
-  const Point3D interior_point = this->InteriorPoint();
-  std::vector<Plane3D> new_faces;
-  for (const Plane3D& old_face : this->faces_) {
-    std::vector<Line3D> new_edges;
-    for (const Line3D& old_edge : old_face.Edges()) {
-      const Vec3D start_vec = old_edge.Start() - interior_point;
-      const Vec3D end_vec = old_edge.End() - interior_point;
-
-      auto sign = [](double el) {
-        if (el < 0) {
-          return -1;
+  // Offsetting the faces leaves their normals, and so the vertex directions,
+  // unchanged
+  Polyhedron expanded = *this;
+  expanded.offsets_.array() -= distance;
+  expanded.bounding_box_.setEmpty();
+  for (size_t idx = 0; idx < expanded.vertices_.size(); ++idx) {
+    expanded.vertices_[idx] +=
+        distance * this->vertex_directions_.row(idx).transpose();
+    expanded.bounding_box_.extend(expanded.vertices_[idx]);
+  }
+
+  // The offset changed which faces meet at some vertex. Offsetting the
+  // planes cannot turn an edge, so this shows as an edge that collapsed and
+  // reversed, or as a vertex whose faces no longer meet at one point. A
+  // polyhedron left with no vertices by an earlier offset is also rebuilt.
+  if (true == this->vertices_.empty() ||
+      false == expanded.VerticesOnPlanes() ||
+      false == expanded.EdgesAlignedWith(*this)) {
+    return expanded.IntersectHalfSpaces();
+  }
+  return expanded;
+}
+
+double Polyhedron::Tolerance() const {
+  const double max_coordinate =
+      (true == this->bounding_box_.isEmpty())
+          ? 0.0
+          : this->bounding_box_.min().cwiseAbs().cwiseMax(
+                this->bounding_box_.max().cwiseAbs()).maxCoeff();
+  return 1e-9 *
+         (1.0 + this->offsets_.lpNorm<Eigen::Infinity>() + max_coordinate);
+}
+
+bool Polyhedron::VerticesOnPlanes() const {
+  const double tolerance = this->Tolerance();
+  for (size_t face_idx = 0; face_idx + 1 < this->face_begin_.size();
+       ++face_idx) {
+    for (size_t idx = this->face_begin_[face_idx];
+         idx < this->face_begin_[face_idx + 1]; ++idx) {
+      const Point3D& vertex = this->vertices_[this->face_indices_[idx]];
+      if (std::abs(this->normals_.row(face_idx).dot(vertex) -
+                   this->offsets_(face_idx)) > tolerance) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+bool Polyhedron::VerticesInside() const {
+  // Vertices are tested in blocks, as in ContainsBatch()
+  constexpr Eigen::Index kBlockSize = 256;
+  const Eigen::Map<const Eigen::Matrix<double, 3, Eigen::Dynamic>> vertices(
+      reinterpret_cast<const double*>(this->vertices_.data()), 3,
+      this->vertices_.size());
+
+  const double tolerance = this->Tolerance();
+  Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic> distances;
+  for (Eigen::Index begin = 0; begin < vertices.cols(); begin += kBlockSize) {
+    const Eigen::Index size = std::min(kBlockSize, vertices.cols() - begin);
+    distances.noalias() = this->normals_ * vertices.middleCols(begin, size);
+    distances.colwise() -= this->offsets_;
+    if (0 < distances.size() && distances.minCoeff() < -tolerance) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool Polyhedron::EdgesAlignedWith(const Polyhedron& original) const {
+  for (size_t face_idx = 0; face_idx + 1 < this->face_begin_.size();
+       ++face_idx) {
+    const Face face(this, face_idx);
+    const Face original_face(&original, face_idx);
+    const EdgeRange edges = face.Edges();
+    const EdgeRange original_edges = original_face.Edges();
+    for (size_t idx = 0; idx < edges.size(); ++idx) {
+      if (edges[idx].AsVector().dot(original_edges[idx].AsVector()) < 0) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+Polyhedron Polyhedron::IntersectHalfSpaces() const {
+  const Eigen::Index num_faces = this->normals_.rows();
+  const double tolerance =
+      1e-9 * (1.0 + this->offsets_.lpNorm<Eigen::Infinity>());
+
+  // Every vertex of the intersection is a point where three of the planes
+  // meet that is on the left side of, or on, every other plane. Vertices
+  // where more than three planes meet are found several times.
+  std::vector<Point3D> vertices;
+  for (Eigen::Index i = 0; i < num_faces; ++i) {
+    for (Eigen::Index j = i + 1; j < num_faces; ++j) {
+      for (Eigen::Index k = j + 1; k < num_faces; ++k) {
+        Eigen::Matrix3d planes;
+        planes << this->normals_.row(i), this->normals_.row(j),
+            this->normals_.row(k);
+        const Eigen::FullPivLU<Eigen::Matrix3d> lu(planes);
+        if (false == lu.isInvertible()) {
+          continue;
         }
-        if (el > 0) {
-          return +1;
-        } else {
-          return 0;
+
+        const Point3D vertex = lu.solve(Vec3D(
+            this->offsets_(i), this->offsets_(j), this->offsets_(k)));
+        const double vertex_tolerance =
+            tolerance * (1.0 + vertex.lpNorm<Eigen::Infinity>());
+        if ((this->normals_ * vertex - this->offsets_).minCoeff() <
+            -vertex_tolerance) {
+          continue;
         }
-      };
 
-      const Vec3D unit_start = start_vec.unaryExpr(sign).cast<double>();
-      const Vec3D unit_end = end_vec.unaryExpr(sign).cast<double>();
+        const bool found = std::any_of(
+            vertices.begin(), vertices.end(), [&](const Point3D& other) {
+              return (other - vertex).lpNorm<Eigen::Infinity>() <=
+                     vertex_tolerance;
+            });
+        if (false == found) {
+          vertices.push_back(vertex);
+        }
+      }
+    }
+  }
+
+  // Each face is the loop of the vertices on its plane, ordered
+  // counter-clockwise about its normal. A plane that touches the
+  // intersection in fewer than three vertices no longer bounds a face.
+  Polyhedron intersection;
+  intersection.vertices_ = vertices;
+  std::vector<Eigen::Index> kept_faces;
+  for (Eigen::Index face_idx = 0; face_idx < num_faces; ++face_idx) {
+    const Vec3D normal = this->normals_.row(face_idx).transpose();
+    std::vector<size_t> loop;
+    Point3D center(0, 0, 0);
+    for (size_t idx = 0; idx < vertices.size(); ++idx) {
+      if (std::abs(normal.dot(vertices[idx]) - this->offsets_(face_idx)) <=
+          tolerance * (1.0 + vertices[idx].lpNorm<Eigen::Infinity>())) {
+        loop.push_back(idx);
+        center += vertices[idx];
+      }
+    }
+    if (loop.size() < 3) {
+      continue;
+    }
 
-      const Point3D new_start = old_edge.Start() + distance * unit_start;
-      const Point3D new_end = old_edge.End() + distance * unit_end;
+    // A face that holds every vertex means the intersection has no volume
+    if (loop.size() == vertices.size()) {
+      kept_faces.clear();
+      break;
+    }
 
-      new_edges.emplace_back(new_start, new_end);
+    center /= loop.size();
+    const Vec3D u = (vertices[loop[0]] - center).normalized();
+    const Vec3D v = normal.cross(u);
+    std::vector<double> angles(vertices.size());
+    for (const size_t idx : loop) {
+      const Vec3D offset = vertices[idx] - center;
+      angles[idx] = std::atan2(offset.dot(v), offset.dot(u));
     }
-    new_faces.emplace_back(new_edges);
+    std::sort(loop.begin(), loop.end(), [&](const size_t lhs, const size_t rhs) {
+      return angles[lhs] < angles[rhs];
+    });
+
+    intersection.face_indices_.insert(intersection.face_indices_.end(),
+                                      loop.begin(), loop.end());
+    intersection.face_begin_.push_back(intersection.face_indices_.size());
+    kept_faces.push_back(face_idx);
   }
-  return Polyhedron(new_faces);
+
+  // With no volume left, the planes are kept so that the result contains no
+  // point, but there are no vertices and every face is empty
+  if (kept_faces.size() < 4) {
+    intersection = *this;
+    intersection.vertices_.clear();
+    intersection.face_indices_.clear();
+    intersection.face_begin_.assign(num_faces + 1, 0);
+    intersection.vertex_directions_.resize(0, 3);
+    intersection.bounding_box_.setEmpty();
+    return intersection;
+  }
+
+  // The planes are kept exactly rather than recomputed from the vertices
+  intersection.normals_.resize(kept_faces.size(), 3);
+  intersection.offsets_.resize(kept_faces.size());
+  for (size_t idx = 0; idx < kept_faces.size(); ++idx) {
+    intersection.normals_.row(idx) = this->normals_.row(kept_faces[idx]);
+    intersection.offsets_(idx) = this->offsets_(kept_faces[idx]);
+  }
+  intersection.BuildVertexDirections();
+  return intersection;
 }
 
 Point3D Polyhedron::ClosestPoint(const Point3D& point) const {
@@ -86,10 +882,15 @@ Point3D Polyhedron::ClosestPoint(const Point3D& point) const {
            (p2 - point).lpNorm<Eigen::Infinity>();
   };
 
+  std::vector<Plane3D> faces;
+  for (const Face& face : this->Faces()) {
+    faces.push_back(face.ToPlane3D());
+  }
+
   // if inside of polygon, simply choose from the closest points on each face
   if (this->Contains(point)) {
-    candidate_point = faces_[0].ClosestPoint(point);
-    for (const Plane3D& face : faces_) {
+    candidate_point = faces[0].ClosestPoint(point);
+    for (const Plane3D& face : faces) {
       candidate_points.push_back(face.ClosestPoint(point));
     }
     std::sort(candidate_points.begin(), candidate_points.end(), nearest);
@@ -98,7 +899,7 @@ Point3D Polyhedron::ClosestPoint(const Point3D& point) const {
 
   // when outside, first check if the point is closest to a face, in which case
   // these are the only possible solutions
-  for (const Plane3D& face : faces_) {
+  for (const Plane3D& face : faces) {
     candidate_point = face.ClosestPoint(point);
     if (face.Contains(candidate_point))
       candidate_points.push_back(candidate_point);
@@ -111,7 +912,7 @@ Point3D Polyhedron::ClosestPoint(const Point3D& point) const {
   // if not closest to a face, have to check all edges.
   // This is a separate loop, since there is no way to
   // get the set of unique edges of the polyhedron
-  for (const Plane3D& face : faces_) {
+  for (const Plane3D& face : faces) {
     for (const Line3D& edge : face.Edges())
       candidate_points.push_back(edge.ClosestBoundedPoint(point));
   }
@@ -2,10 +2,12 @@
 
 #pragma once
 
+#include <Eigen/Geometry>
 #include <cstdlib>
 #include <iostream>
 #include <vector>
 
+#include "edge_range.h"
 #include "plane3d.h"
 #include "yaml-cpp/yaml.h"
 
@@ -13,23 +15,120 @@ namespace game_engine {
 // A polyhedron is represented by a connected set of convex polygons that
 // encapsulate a closed, convex, 3D space.
 //
+// The polygons are stored as an indexed mesh: every distinct vertex is stored
+// once, and each face is a loop of indices into the vertices. Faces and edges
+// are exposed as views of the mesh.
+//
 // TODO: Put checks into place to ensure that the polyhedron is convex and
 // closed
 class Polyhedron {
+ public:
+  // Relation of a region of space to a polyhedron
+  enum class Overlap { kInside, kOutside, kPartial };
+
+  // View of a face of a polyhedron. A face is only valid for as long as the
+  // polyhedron it belongs to.
+  class Face {
+   public:
+    Face(const Polyhedron* polyhedron = nullptr, const size_t idx = 0)
+        : polyhedron_(polyhedron), idx_(idx) {}
+
+    // Edges of the face, ordered as those of a Plane3D
+    EdgeRange Edges() const;
+
+    // Copies the face into a standalone plane
+    Plane3D ToPlane3D() const;
+
+   private:
+    const Polyhedron* polyhedron_;
+    size_t idx_;
+  };
+
+  // View of all faces of a polyhedron
+  class FaceRange {
+   public:
+    class Iterator;
+
+    FaceRange(const Polyhedron* polyhedron) : polyhedron_(polyhedron) {}
+
+    size_t size() const { return this->polyhedron_->face_begin_.size() - 1; }
+    bool empty() const { return 0 == this->size(); }
+    Face operator[](const size_t idx) const {
+      return Face(this->polyhedron_, idx);
+    }
+
+    Iterator begin() const;
+    Iterator end() const;
+
+   private:
+    const Polyhedron* polyhedron_;
+  };
+
  private:
-  // Set of convex polygons embedded in a 3D space that make up the boundary
-  // of the polyhedron
-  std::vector<Plane3D> faces_;
+  // Every distinct vertex of the polyhedron
+  std::vector<Point3D> vertices_;
+
+  // Faces are loops of indices into vertices_, stored back to back. The loop
+  // of face idx is face_indices_[face_begin_[idx], face_begin_[idx + 1]).
+  std::vector<size_t> face_indices_;
+  std::vector<size_t> face_begin_;
+
+  // Half-space representation of the faces, built whenever the faces are
+  // set. Row idx of normals_ is the unit normal of face idx, and a point
+  // is on the left side of that face if normals_.row(idx).dot(point) >
+  // offsets_(idx).
+  Eigen::Matrix<double, Eigen::Dynamic, 3> normals_;
+  Eigen::VectorXd offsets_;
+
+  // Direction in which each vertex moves as the faces are offset. Moving
+  // every face outwards by distance moves vertex idx to vertices_[idx] +
+  // distance * vertex_directions_.row(idx).
+  Eigen::Matrix<double, Eigen::Dynamic, 3> vertex_directions_;
+
+  // Bounding box of the vertices
+  Eigen::AlignedBox3d bounding_box_;
 
   // Forward-declare parser
   friend class YAML::convert<Polyhedron>;
 
+  // Replaces the mesh with the given faces, merging identical vertices
+  void BuildMesh(const std::vector<Plane3D>& faces);
+
+  void BuildHalfSpaces();
+
+  // Builds vertex_directions_ and bounding_box_ from the mesh and normals_
+  void BuildVertexDirections();
+
+  // Tolerance of the checks below, relative to the size of the polyhedron
+  double Tolerance() const;
+
+  // Determines if every vertex lies on the planes of its faces
+  bool VerticesOnPlanes() const;
+
+  // Determines if every vertex is on the left side of, or on, every face
+  bool VerticesInside() const;
+
+  // Determines if every edge points the same way as the same edge of an
+  // original polyhedron with the same faces
+  bool EdgesAlignedWith(const Polyhedron& original) const;
+
+  // Rebuilds the mesh from the half-spaces alone. Vertices are found from
+  // every intersection of three planes, so this takes O(F^4) time, and faces
+  // whose planes no longer bound the intersection are dropped.
+  Polyhedron IntersectHalfSpaces() const;
+
  public:
-  // Constructor
-  Polyhedron(const std::vector<Plane3D>& faces = {}) : faces_(faces) {}
+  // Constructors. Faces given as loops of indices into vertices are ordered as
+  // the edges of a Plane3D.
+  Polyhedron(const std::vector<Plane3D>& faces = {});
+  Polyhedron(const std::vector<Point3D>& vertices,
+             const std::vector<std::vector<size_t>>& faces);
 
   // Faces accessor
-  const std::vector<Plane3D>& Faces() const;
+  FaceRange Faces() const;
+
+  // Vertices accessor. Every distinct vertex appears once.
+  const std::vector<Point3D>& Vertices() const;
 
   // Determines if a 3D point is contained within the polyhedron. A point is
   // contained within a polyhedron if, given a convex polyhedron and a set
@@ -37,39 +136,124 @@ class Polyhedron {
   // to the left of the faces
   bool Contains(const Point3D& point) const;
 
-  // Determines if the polyhedron is convex
+  // Batch form of Contains(). Element idx of the result is whether
+  // points[idx] is contained. All points are tested against all faces with
+  // one matrix product, so the result may differ from Contains() for points
+  // within rounding error of a face.
+  std::vector<bool> ContainsBatch(const std::vector<Point3D>& points) const;
+
+  // Determines if any point on the segment between start and end is
+  // contained within the polyhedron, in the same sense as Contains(). The
+  // segment is clipped against the half-space of every face.
+  bool IntersectsSegment(const Point3D& start, const Point3D& end) const;
+
+  // Classifies an axis-aligned box in the sense of Contains(). kInside and
+  // kOutside are returned only if they hold for every point of the box,
+  // allowing for rounding in Contains(). Boxes that are outside of the
+  // polyhedron but not separated from it by any face are kPartial.
+  Overlap Classify(const Eigen::AlignedBox3d& box) const;
+
+  // Returns the smallest axis-aligned box containing every vertex
+  Eigen::AlignedBox3d BoundingBox() const;
+
+  // Determines if the polyhedron is convex: every face is planar and no
+  // vertex is on the right side of any face. Closedness is not checked.
   bool IsConvex() const;
 
-  // Returns the convex hull of the polyhedron
+  // Returns the convex hull of the vertices of the polyhedron. Faces that
+  // lie on the same plane are merged.
   Polyhedron ConvexHull() const;
 
+  // Constructs the convex hull of a set of points with quickhull, in
+  // O(n log n) expected time. Points within rounding error of the hull are
+  // treated as on it, so each face is a convex polygon with no three
+  // collinear vertices. Returns an empty polyhedron if the points do not
+  // span a volume.
+  // Reference: Barber, Dobkin and Huhdanpaa, "The Quickhull Algorithm for
+  // Convex Hulls", ACM TOMS 22(4), 1996
+  static Polyhedron ConvexHullFromPoints(const std::vector<Point3D>& points);
+
   // Returns a point on the interior of the polyhedron. The point is
-  // determined by taking the average of all of the vertices of the
+  // determined by taking the average of all of the distinct vertices of the
   // polyhedron. This function requires that the polyhedron be convex.
   Point3D InteriorPoint() const;
 
-  // Shrinks a polyhedron by a set distance. All componenents of all
-  // vertices are shrunk by the same distance. As a result, aspect ratio is
-  // not necessarily conserved.
+  // Shrinks a polyhedron by a set distance. Every face is moved inwards along
+  // its normal by the distance.
   Polyhedron Shrink(const double distance) const;
 
-  // Expands a polyhedron by a set distance. All componenents of all
-  // vertices are expanded by the same distance. As a result, aspect ratio
-  // is not necessarily conserved.
+  // Expands a polyhedron by a set distance. Every face is moved outwards
+  // along its normal by the distance, so the result contains every point
+  // within the distance of the polyhedron.
+  //
+  // Vertices move along with the faces as long as the offset does not change
+  // which faces meet at each vertex. If it does, as when shrinking removes a
+  // face, the mesh is rebuilt from the offset planes in O(F^4) time. If no
+  // volume is left, the result keeps the planes of its faces, so it contains
+  // no point, but it has no vertices and every face is empty.
   Polyhedron Expand(const double distance) const;
 
   // Return the point on the surface of the polyhedron
   // closest to the given point
   Point3D ClosestPoint(const Point3D& point) const;
 };
+
+class Polyhedron::FaceRange::Iterator {
+ public:
+  using iterator_category = std::input_iterator_tag;
+  using value_type = Face;
+  using difference_type = std::ptrdiff_t;
+  using pointer = void;
+  using reference = Face;
+
+  Iterator(const Polyhedron* polyhedron, const size_t idx)
+      : polyhedron_(polyhedron), idx_(idx) {}
+
+  Face operator*() const { return Face(this->polyhedron_, this->idx_); }
+
+  Iterator& operator++() {
+    ++this->idx_;
+    return *this;
+  }
+
+  Iterator operator++(int) {
+    Iterator previous = *this;
+    ++this->idx_;
+    return previous;
+  }
+
+  bool operator==(const Iterator& rhs) const {
+    return this->idx_ == rhs.idx_;
+  }
+  bool operator!=(const Iterator& rhs) const {
+    return this->idx_ != rhs.idx_;
+  }
+
+ private:
+  const Polyhedron* polyhedron_;
+  size_t idx_;
+};
+
+inline Polyhedron::FaceRange::Iterator Polyhedron::FaceRange::begin() const {
+  return Iterator(this->polyhedron_, 0);
+}
+
+inline Polyhedron::FaceRange::Iterator Polyhedron::FaceRange::end() const {
+  return Iterator(this->polyhedron_, this->size());
+}
 }  // namespace game_engine
 
 namespace YAML {
 template <>
 struct convert<game_engine::Polyhedron> {
   static Node encode(const game_engine::Polyhedron& rhs) {
+    std::vector<game_engine::Plane3D> faces;
+    for (const game_engine::Polyhedron::Face& face : rhs.Faces()) {
+      faces.push_back(face.ToPlane3D());
+    }
+
     Node node;
-    node.push_back(rhs.faces_);
+    node.push_back(faces);
     return node;
   }
 
@@ -84,7 +268,8 @@ struct convert<game_engine::Polyhedron> {
       faces.push_back(node[idx].as<game_engine::Plane3D>());
     }
 
-    rhs.faces_ = faces;
+    rhs.BuildMesh(faces);
+    rhs.BuildHalfSpaces();
     return true;
   }
 };
@@ -3,12 +3,12 @@
 #include <ros/ros.h>
 
 #include <chrono>
-#include <thread>
 
 #include "balloon_status.h"
 
 namespace game_engine {
-void BalloonWatchdog::Run(
+void BalloonWatchdog::Schedule(
+    PeriodicScheduler& scheduler,
     std::shared_ptr<BalloonStatusPublisherNode> balloon_status_publisher,
     std::shared_ptr<BalloonStatusSubscriberNode> balloon_status_subscriber,
     std::shared_ptr<BalloonPositionPublisherNode> balloon_position_publisher,
@@ -16,83 +16,106 @@ void BalloonWatchdog::Run(
     const std::vector<std::string>& quad_names,
     Eigen::Vector3d& balloon_position, Eigen::Vector3d& new_balloon_position,
     double max_move_time, std::mt19937& gen, const std::string& topic) {
-  // Data to be populated when balloon is popped
-  bool balloon_popped = false;
-  std::chrono::system_clock::time_point start_time =
-      std::chrono::system_clock::now();
+  std::shared_ptr<Context> context = std::make_shared<Context>();
+  context->balloon_status_publisher = balloon_status_publisher;
+  context->balloon_status_subscriber = balloon_status_subscriber;
+  context->balloon_position_publisher = balloon_position_publisher;
+  context->quad_state_warden = quad_state_warden;
+  for (const std::string& quad_name : quad_names) {
+    QuadId id;
+    if (MediationLayerCode::Success == quad_state_warden->Id(quad_name, id)) {
+      context->quad_names.push_back(quad_name);
+      context->quad_ids.push_back(id);
+    }
+  }
 
   std::uniform_int_distribution<int> distribution(0.0, max_move_time);
-  double move_time = distribution(gen);
+  context->move_time = distribution(gen);
+  context->position = balloon_position;
+  context->new_balloon_position = new_balloon_position;
+  context->start_time = std::chrono::system_clock::now();
 
-  double balloon_pop_time = -1.0;  // initial (invalid) time before popping
-  std::string quad_popper = "null";
+  // Set up subscriber for manual pop of balloon
+  context->node_handle = ros::NodeHandle("/game_engine/");
+  context->subscriber = context->node_handle.subscribe(
+      topic, 1, &BalloonWatchdog::ManualCallback, this);
 
-  bool set_start;
-  bool started = false;  // set to true after SAP starts
+  scheduler.AddTask("balloon_watchdog:" + topic, this->options_.period,
+                    [this, context]() { this->Check(*context); });
+}
 
-  Eigen::Vector3d position = balloon_position;
+void BalloonWatchdog::Run(
+    std::shared_ptr<BalloonStatusPublisherNode> balloon_status_publisher,
+    std::shared_ptr<BalloonStatusSubscriberNode> balloon_status_subscriber,
+    std::shared_ptr<BalloonPositionPublisherNode> balloon_position_publisher,
+    std::shared_ptr<QuadStateWarden> quad_state_warden,
+    const std::vector<std::string>& quad_names,
+    Eigen::Vector3d& balloon_position, Eigen::Vector3d& new_balloon_position,
+    double max_move_time, std::mt19937& gen, const std::string& topic) {
+  PeriodicScheduler::Options scheduler_options;
+  scheduler_options.worker_threads = 1;
+  PeriodicScheduler scheduler(scheduler_options);
+  this->Schedule(scheduler, balloon_status_publisher, balloon_status_subscriber,
+                 balloon_position_publisher, quad_state_warden, quad_names,
+                 balloon_position, new_balloon_position, max_move_time, gen,
+                 topic);
+  scheduler.Run(this->stop_source_.Token());
+
+  this->stop_source_.Reset();
+}
 
-  // Set up subscriber for manual pop of balloon
-  ros::NodeHandle node_handle_ = ros::NodeHandle("/game_engine/");
-  ros::Subscriber subscriber_ =
-      node_handle_.subscribe(topic, 1, &BalloonWatchdog::ManualCallback, this);
-
-  // Main loop
-  while (ok_) {
-    // read start time from existing balloon_status
-    set_start = balloon_status_subscriber->balloon_status_->set_start;
-    if (set_start && !started) {
-      // resets clock after SAP starts
-      start_time = std::chrono::system_clock::now();
-      started = true;
-    }
+void BalloonWatchdog::Check(Context& context) {
+  // read start time from existing balloon_status
+  const bool set_start =
+      context.balloon_status_subscriber->balloon_status_->set_start;
+  if (set_start && !context.started) {
+    // resets clock after SAP starts
+    context.start_time = std::chrono::system_clock::now();
+    context.started = true;
+  }
 
-    if (started) {
-      auto now = std::chrono::system_clock::now();
-      std::chrono::duration<double> difference = now - start_time;
-      double elapsed_sec = difference.count();
+  if (context.started) {
+    auto now = std::chrono::system_clock::now();
+    std::chrono::duration<double> difference = now - context.start_time;
+    double elapsed_sec = difference.count();
 
-      // move balloon if enough time has passed
-      if (elapsed_sec >= move_time) {
-        position = new_balloon_position;
-      }
+    // move balloon if enough time has passed
+    if (elapsed_sec >= context.move_time) {
+      context.position = context.new_balloon_position;
+    }
 
-      for (const std::string& quad_name : quad_names) {
-        QuadState quad_state;
-        quad_state_warden->Read(quad_name, quad_state);
+    for (size_t idx = 0; idx < context.quad_ids.size(); ++idx) {
+      QuadState quad_state;
+      context.quad_state_warden->Read(context.quad_ids[idx], quad_state);
 
-        const Eigen::Vector3d quad_pos = quad_state.Position();
-        const double distance_to_balloon = (quad_pos - position).norm();
+      const Eigen::Vector3d quad_pos = quad_state.Position();
+      const double distance_to_balloon = (quad_pos - context.position).norm();
 
-        if (manualPop || this->options_.pop_distance >= distance_to_balloon) {
-          if (false == balloon_popped) {
-            ROS_INFO_STREAM("Balloon popped @ elapsed: " << elapsed_sec);
-            balloon_popped = true;
+      if (manualPop || this->options_.pop_distance >= distance_to_balloon) {
+        if (false == context.balloon_popped) {
+          ROS_INFO_STREAM("Balloon popped @ elapsed: " << elapsed_sec);
+          context.balloon_popped = true;
 
-            balloon_pop_time = elapsed_sec;
-            quad_popper = quad_name;
-          }
+          context.balloon_pop_time = elapsed_sec;
+          context.quad_popper = context.quad_names[idx];
         }
       }
     }
+  }
 
-    // Publish
-    BalloonStatus balloon_status{
-        .popped = balloon_popped,
-        .popper = quad_popper,
-        .pop_time = balloon_pop_time,
-        .set_start = set_start  // only set to true from SAP
-    };
-
-    balloon_status_publisher->Publish(balloon_status);
-    balloon_position_publisher->Publish(position);
+  // Publish
+  BalloonStatus balloon_status{
+      .popped = context.balloon_popped,
+      .popper = context.quad_popper,
+      .pop_time = context.balloon_pop_time,
+      .set_start = set_start  // only set to true from SAP
+  };
 
-    // 50 Hz
-    std::this_thread::sleep_for(std::chrono::milliseconds(20));
-  }
+  context.balloon_status_publisher->Publish(balloon_status);
+  context.balloon_position_publisher->Publish(context.position);
 }
 
-void BalloonWatchdog::Stop() { this->ok_ = false; }
+void BalloonWatchdog::Stop() { this->stop_source_.RequestStop(); }
 
 void BalloonWatchdog::ManualCallback(const std_msgs::Bool& msg) {
   if (msg.data) {
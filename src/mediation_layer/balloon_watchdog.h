@@ -1,6 +1,9 @@
 #pragma once
 
+#include <ros/ros.h>
+
 #include <Eigen/Core>
+#include <chrono>
 #include <memory>
 #include <random>
 #include <string>
@@ -9,6 +12,9 @@
 #include "balloon_position_publisher_node.h"
 #include "balloon_status_publisher_node.h"
 #include "balloon_status_subscriber_node.h"
+#include "periodic_scheduler.h"
+#include "quad_id.h"
+#include "stop_token.h"
 #include "warden.h"
 
 namespace game_engine {
@@ -16,7 +22,8 @@ namespace game_engine {
 // the quadcopter has popped the balloon. If it has, update the status of the
 // balloons over ROS.
 //
-// Should be run as its own thread
+// Should either be run as its own thread or scheduled on a shared
+// PeriodicScheduler
 class BalloonWatchdog {
  public:
   struct Options {
@@ -24,12 +31,27 @@ class BalloonWatchdog {
     // 'pop' a balloon in meters
     double pop_distance = 0.30;
 
+    // Period at which the balloon is checked and its status published
+    std::chrono::milliseconds period = std::chrono::milliseconds(20);
+
     Options() {}
   };
 
   BalloonWatchdog(const Options& options = Options()) : options_(options) {}
 
-  // Main thread function
+  // Register the watchdog with a scheduler. The scheduler owns the thread;
+  // stopping the scheduler stops the watchdog.
+  void Schedule(
+      PeriodicScheduler& scheduler,
+      std::shared_ptr<BalloonStatusPublisherNode> balloon_status_publisher,
+      std::shared_ptr<BalloonStatusSubscriberNode> balloon_status_subscriber,
+      std::shared_ptr<BalloonPositionPublisherNode> balloon_position_publisher,
+      std::shared_ptr<QuadStateWarden> quad_state_warden,
+      const std::vector<std::string>& quad_names,
+      Eigen::Vector3d& balloon_position, Eigen::Vector3d& new_balloon_position,
+      double max_move_time, std::mt19937& gen, const std::string& topic);
+
+  // Main thread function. Runs the watchdog on its own scheduler.
   void Run(
       std::shared_ptr<BalloonStatusPublisherNode> balloon_status_publisher,
       std::shared_ptr<BalloonStatusSubscriberNode> balloon_status_subscriber,
@@ -39,14 +61,43 @@ class BalloonWatchdog {
       Eigen::Vector3d& balloon_position, Eigen::Vector3d& new_balloon_position,
       double max_move_time, std::mt19937& gen, const std::string& topic);
 
-  // Stop this thread
+  // Stop this thread. Wakes it immediately if it is sleeping. Once Run()
+  // has returned, it may be called again.
   void Stop();
 
   void ManualCallback(const std_msgs::Bool& msg);
 
  private:
+  // State carried between checks
+  struct Context {
+    std::shared_ptr<BalloonStatusPublisherNode> balloon_status_publisher;
+    std::shared_ptr<BalloonStatusSubscriberNode> balloon_status_subscriber;
+    std::shared_ptr<BalloonPositionPublisherNode> balloon_position_publisher;
+    std::shared_ptr<QuadStateWarden> quad_state_warden;
+    std::vector<std::string> quad_names;
+    std::vector<QuadId> quad_ids;
+
+    // Subscriber for manual pop of balloon
+    ros::NodeHandle node_handle;
+    ros::Subscriber subscriber;
+
+    Eigen::Vector3d position;
+    Eigen::Vector3d new_balloon_position;
+    double move_time = 0;
+
+    // Data to be populated when balloon is popped
+    bool balloon_popped = false;
+    double balloon_pop_time = -1.0;  // initial (invalid) time before popping
+    std::string quad_popper = "null";
+
+    bool started = false;  // set to true after SAP starts
+    std::chrono::system_clock::time_point start_time;
+  };
+
+  void Check(Context& context);
+
   volatile bool manualPop = false;
-  volatile std::atomic_bool ok_{true};
+  StopSource stop_source_;
   Options options_;
 };
 }  // namespace game_engine
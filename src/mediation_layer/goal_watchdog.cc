@@ -1,7 +1,6 @@
 #include "goal_watchdog.h"
 
 #include <chrono>
-#include <thread>
 
 #include "balloon_position_publisher_node.h"
 #include "balloon_position_subscriber_node.h"
@@ -11,97 +10,118 @@
 #include "goal_status.h"
 
 namespace game_engine {
-void GoalWatchdog::Run(
+void GoalWatchdog::Schedule(
+    PeriodicScheduler& scheduler,
     std::shared_ptr<GoalStatusPublisherNode> goal_status_publisher,
     std::shared_ptr<GoalStatusSubscriberNode> goal_status_subscriber,
     std::shared_ptr<QuadStateWarden> quad_state_warden,
     const std::vector<std::string>& quad_names,
     Eigen::Vector3d& goal_position) {
-  // Data to be populated when goal is reached
-  bool active = false;
-  bool goal_reached = false;
-  std::chrono::system_clock::time_point start_time =
-      std::chrono::system_clock::now();
-
-  double goal_reach_time = -1.0;  // initial (invalid) time before popping
-  std::string quad_scorer = "null";
-
-  bool set_start;
-  bool started = false;  // set to true after SAP starts
+  std::shared_ptr<Context> context = std::make_shared<Context>();
+  context->goal_status_publisher = goal_status_publisher;
+  context->goal_status_subscriber = goal_status_subscriber;
+  context->quad_state_warden = quad_state_warden;
+  for (const std::string& quad_name : quad_names) {
+    QuadId id;
+    if (MediationLayerCode::Success == quad_state_warden->Id(quad_name, id)) {
+      context->quad_names.push_back(quad_name);
+      context->quad_ids.push_back(id);
+    }
+  }
+  context->goal_position = goal_position;
+  context->start_time = std::chrono::system_clock::now();
 
   // Get the balloon states
   std::map<std::string, std::string> balloon_status_topics;
-  auto red_balloon_status = std::make_shared<BalloonStatus>();
-  auto blue_balloon_status = std::make_shared<BalloonStatus>();
+  context->red_balloon_status = std::make_shared<BalloonStatus>();
+  context->blue_balloon_status = std::make_shared<BalloonStatus>();
 
-  auto red_balloon_status_subscriber_node =
+  context->red_balloon_status_subscriber_node =
       std::make_shared<BalloonStatusSubscriberNode>(
-          balloon_status_topics["red"], red_balloon_status);
-  auto blue_balloon_status_subscriber_node =
+          balloon_status_topics["red"], context->red_balloon_status);
+  context->blue_balloon_status_subscriber_node =
       std::make_shared<BalloonStatusSubscriberNode>(
-          balloon_status_topics["blue"], blue_balloon_status);
-
-  // Main loop
-  while (true == this->ok_) {
-    // read start time from existing goal status
-    set_start = goal_status_subscriber->goal_status_->set_start;
-    if (set_start && !started) {
-      // reset clock after SAP starts
-      start_time = std::chrono::system_clock::now();
-      started = true;
-    }
+          balloon_status_topics["blue"], context->blue_balloon_status);
+
+  scheduler.AddTask("goal_watchdog", this->options_.period,
+                    [this, context]() { this->Check(*context); });
+}
+
+void GoalWatchdog::Run(
+    std::shared_ptr<GoalStatusPublisherNode> goal_status_publisher,
+    std::shared_ptr<GoalStatusSubscriberNode> goal_status_subscriber,
+    std::shared_ptr<QuadStateWarden> quad_state_warden,
+    const std::vector<std::string>& quad_names,
+    Eigen::Vector3d& goal_position) {
+  PeriodicScheduler::Options scheduler_options;
+  scheduler_options.worker_threads = 1;
+  PeriodicScheduler scheduler(scheduler_options);
+  this->Schedule(scheduler, goal_status_publisher, goal_status_subscriber,
+                 quad_state_warden, quad_names, goal_position);
+  scheduler.Run(this->stop_source_.Token());
+
+  this->stop_source_.Reset();
+}
 
-    if (started) {
-      auto now = std::chrono::system_clock::now();
-      std::chrono::duration<double> difference = now - start_time;
-      double elapsed_sec = difference.count();
-
-      for (const std::string& quad_name : quad_names) {
-        QuadState quad_state;
-        quad_state_warden->Read(quad_name, quad_state);
-
-        const Eigen::Vector3d quad_pos = quad_state.Position();
-        const double quad_speed = (quad_state.Velocity()).norm();
-        const double distance_to_goal = (quad_pos - goal_position).norm();
-
-        if (this->options_.reach_distance >= distance_to_goal &&
-            quad_speed <= this->options_.reach_speed) {
-          if (false == goal_reached &&
-              elapsed_sec >= this->options_.time_fuze) {
-            goal_reached = true;
-            active = true;
-
-            goal_reach_time = elapsed_sec;
-            quad_scorer = quad_name;
-            if (!red_balloon_status->popped && !blue_balloon_status->popped) {
-              ROS_INFO_STREAM("Goal Reached @ elapsed: " << goal_reach_time);
-            }
-          } else {
-            active = true;
+void GoalWatchdog::Check(Context& context) {
+  // read start time from existing goal status
+  const bool set_start = context.goal_status_subscriber->goal_status_->set_start;
+  if (set_start && !context.started) {
+    // reset clock after SAP starts
+    context.start_time = std::chrono::system_clock::now();
+    context.started = true;
+  }
+
+  if (context.started) {
+    auto now = std::chrono::system_clock::now();
+    std::chrono::duration<double> difference = now - context.start_time;
+    double elapsed_sec = difference.count();
+
+    for (size_t idx = 0; idx < context.quad_ids.size(); ++idx) {
+      QuadState quad_state;
+      context.quad_state_warden->Read(context.quad_ids[idx], quad_state);
+
+      const Eigen::Vector3d quad_pos = quad_state.Position();
+      const double quad_speed = (quad_state.Velocity()).norm();
+      const double distance_to_goal =
+          (quad_pos - context.goal_position).norm();
+
+      if (this->options_.reach_distance >= distance_to_goal &&
+          quad_speed <= this->options_.reach_speed) {
+        if (false == context.goal_reached &&
+            elapsed_sec >= this->options_.time_fuze) {
+          context.goal_reached = true;
+          context.active = true;
+
+          context.goal_reach_time = elapsed_sec;
+          context.quad_scorer = context.quad_names[idx];
+          if (!context.red_balloon_status->popped &&
+              !context.blue_balloon_status->popped) {
+            ROS_INFO_STREAM(
+                "Goal Reached @ elapsed: " << context.goal_reach_time);
           }
         } else {
-          active = false;
+          context.active = true;
         }
+      } else {
+        context.active = false;
       }
     }
-
-    // Publish
-    GoalStatus goal_status{
-        .active = active,
-        .reached = goal_reached,
-        .scorer = quad_scorer,
-        .reach_time = goal_reach_time,
-        .position = goal_position,
-        .set_start = set_start  // only set to true from SAP
-    };
-
-    goal_status_publisher->Publish(goal_status);
-
-    // 50 Hz
-    std::this_thread::sleep_for(std::chrono::milliseconds(20));
   }
+
+  // Publish
+  GoalStatus goal_status{
+      .active = context.active,
+      .reached = context.goal_reached,
+      .scorer = context.quad_scorer,
+      .reach_time = context.goal_reach_time,
+      .position = context.goal_position,
+      .set_start = set_start  // only set to true from SAP
+  };
+
+  context.goal_status_publisher->Publish(goal_status);
 }
 
-void GoalWatchdog::Stop() { this->ok_ = false; }
+void GoalWatchdog::Stop() { this->stop_source_.RequestStop(); }
 
 }  // namespace game_engine
@@ -1,13 +1,19 @@
 #pragma once
 
 #include <Eigen/Core>
+#include <chrono>
 #include <memory>
 #include <random>
 #include <string>
 #include <vector>
 
+#include "balloon_status.h"
+#include "balloon_status_subscriber_node.h"
 #include "goal_status_publisher_node.h"
 #include "goal_status_subscriber_node.h"
+#include "periodic_scheduler.h"
+#include "quad_id.h"
+#include "stop_token.h"
 #include "warden.h"
 
 namespace game_engine {
@@ -15,7 +21,8 @@ namespace game_engine {
 // the quadcopter has reached the goal. If it has, update the status of the
 // goal over ROS.
 //
-// Should be run as its own thread
+// Should either be run as its own thread or scheduled on a shared
+// PeriodicScheduler
 class GoalWatchdog {
  public:
   struct Options {
@@ -29,23 +36,65 @@ class GoalWatchdog {
     // time that must elapse before goal can be reached
     double time_fuze = 20.0;
 
+    // Period at which the goal is checked and its status published
+    std::chrono::milliseconds period = std::chrono::milliseconds(20);
+
     Options() {}
   };
 
   GoalWatchdog(const Options& options = Options()) : options_(options) {}
 
-  // Main thread function
+  // Register the watchdog with a scheduler. The scheduler owns the thread;
+  // stopping the scheduler stops the watchdog.
+  void Schedule(PeriodicScheduler& scheduler,
+                std::shared_ptr<GoalStatusPublisherNode> goal_status_publisher,
+                std::shared_ptr<GoalStatusSubscriberNode> goal_status_subscriber,
+                std::shared_ptr<QuadStateWarden> quad_state_warden,
+                const std::vector<std::string>& quad_names,
+                Eigen::Vector3d& goal_position);
+
+  // Main thread function. Runs the watchdog on its own scheduler.
   void Run(std::shared_ptr<GoalStatusPublisherNode> goal_status_publisher,
            std::shared_ptr<GoalStatusSubscriberNode> goal_status_subscriber,
            std::shared_ptr<QuadStateWarden> quad_state_warden,
            const std::vector<std::string>& quad_names,
            Eigen::Vector3d& goal_position);
 
-  // Stop this thread
+  // Stop this thread. Wakes it immediately if it is sleeping. Once Run()
+  // has returned, it may be called again.
   void Stop();
 
  private:
-  volatile std::atomic_bool ok_{true};
+  // State carried between checks
+  struct Context {
+    std::shared_ptr<GoalStatusPublisherNode> goal_status_publisher;
+    std::shared_ptr<GoalStatusSubscriberNode> goal_status_subscriber;
+    std::shared_ptr<QuadStateWarden> quad_state_warden;
+    std::vector<std::string> quad_names;
+    std::vector<QuadId> quad_ids;
+    Eigen::Vector3d goal_position;
+
+    // Balloon states
+    std::shared_ptr<BalloonStatus> red_balloon_status;
+    std::shared_ptr<BalloonStatus> blue_balloon_status;
+    std::shared_ptr<BalloonStatusSubscriberNode>
+        red_balloon_status_subscriber_node;
+    std::shared_ptr<BalloonStatusSubscriberNode>
+        blue_balloon_status_subscriber_node;
+
+    // Data to be populated when goal is reached
+    bool active = false;
+    bool goal_reached = false;
+    double goal_reach_time = -1.0;  // initial (invalid) time before popping
+    std::string quad_scorer = "null";
+
+    bool started = false;  // set to true after SAP starts
+    std::chrono::system_clock::time_point start_time;
+  };
+
+  void Check(Context& context);
+
+  StopSource stop_source_;
   Options options_;
 };
 }  // namespace game_engine
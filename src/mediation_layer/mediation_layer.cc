@@ -1,9 +1,11 @@
 #include "mediation_layer.h"
 
+#include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <limits>
 #include <thread>
-
-#include "trajectory_vetter.h"
+#include <utility>
 
 namespace game_engine {
 TrajectoryVector3D MediationLayer::FreezeQuad(
@@ -26,12 +28,11 @@ TrajectoryVector3D MediationLayer::FreezeQuad(
          0, current_time + idx * 0.01)
             .finished());
   }
-  const Trajectory freeze_trajectory(freeze_trajectory_vector);
   return freeze_trajectory_vector;
 }
 
 bool MediationLayer::IsQuadMovingAwayFromOtherQuad(
-    const Trajectory main_trajectory, const Polyhedron violation_space) {
+    const Trajectory& main_trajectory, const Polyhedron& violation_space) {
   // lookahead 15 trajectory points
   size_t look = 15;
   // or pick the total number of points if that is smaller
@@ -55,7 +56,7 @@ bool MediationLayer::IsQuadMovingAwayFromOtherQuad(
 }
 
 bool MediationLayer::IsQuadMovingAwayFromObstacle(
-    const Trajectory main_trajectory, const Map3D inflated_map) {
+    const Trajectory& main_trajectory, const Map3D& inflated_map) {
   // lookahead 15 trajectory points
   size_t look = 15;
   // or pick the total number of points if that is smaller
@@ -112,147 +113,218 @@ Polyhedron MediationLayer::ExpandQuad(const Eigen::Vector3d cm,
   return new_poly;
 }
 
-void MediationLayer::TransferData(
-    const std::string& key, const Map3D& map,
+TrajectoryCode MediationLayer::Truncate(
+    Trajectory& trajectory, const TrajectoryCode& trajectory_code,
+    const Map3D& map, const TrajectoryVetter& trajectory_vetter,
+    std::shared_ptr<QuadStateWarden> quad_state_warden,
+    const std::string& key) {
+  const size_t prefix =
+      trajectory_vetter.SafePrefix(trajectory, map, quad_state_warden, key);
+  if (prefix < 2) {
+    return trajectory_code;
+  }
+
+  const TrajectoryVector3D& samples = trajectory.Data();
+  TrajectoryVector3D truncated(samples.begin(), samples.begin() + prefix);
+
+  // Decelerate uniformly against the final velocity until the quad is at
+  // rest, sampling at half the maximum time between samples
+  const Eigen::Matrix<double, 11, 1> last = truncated.back();
+  const Eigen::Vector3d velocity = last.segment<3>(3);
+  const double speed = velocity.norm();
+  const double deceleration =
+      this->options_.stop_acceleration_fraction *
+      trajectory_vetter.options_.max_acceleration_magnitude;
+  const double delta_t = 0.5 * trajectory_vetter.options_.max_delta_t;
+  if (0 < speed && 0 < deceleration && 0 < delta_t) {
+    const Eigen::Vector3d acceleration = -deceleration / speed * velocity;
+    const double stop_time = speed / deceleration;
+    const size_t steps = std::ceil(stop_time / delta_t);
+    for (size_t step = 1; step <= steps; ++step) {
+      const double time = std::min(step * delta_t, stop_time);
+      Eigen::Matrix<double, 11, 1> sample = last;
+      sample.head<3>() += velocity * time + 0.5 * acceleration * time * time;
+      sample.segment<3>(3) = velocity + acceleration * time;
+      sample.segment<3>(6) = acceleration;
+      sample(10) += time;
+      truncated.push_back(sample);
+    }
+    truncated.back().segment<3>(3).setZero();
+    truncated.back().segment<3>(6).setZero();
+  }
+
+  // The stop itself may violate the requirements, for example by running
+  // into an obstacle
+  Trajectory stopped(std::move(truncated));
+  if (MediationLayerCode::Success !=
+      trajectory_vetter.Vet(stopped, map, quad_state_warden, key).code) {
+    return trajectory_code;
+  }
+
+  TrajectoryCode truncated_code;
+  truncated_code.code = MediationLayerCode::TrajectoryTruncated;
+  truncated_code.index = prefix;
+  truncated_code.value = stopped.Time(stopped.Size() - 1);
+  trajectory = std::move(stopped);
+  return truncated_code;
+}
+
+void MediationLayer::MediateQuad(
+    QuadContext& context, const Map3D& map, const Map3D& inflated_map,
+    const TrajectoryVetter& trajectory_vetter,
     std::shared_ptr<TrajectoryWardenServer> trajectory_warden_srv,
     std::shared_ptr<TrajectoryWardenPublisher> trajectory_warden_pub,
     std::shared_ptr<QuadStateWarden> quad_state_warden,
     std::shared_ptr<QuadStateWatchdogStatus> quad_state_watchdog_status,
-    std::shared_ptr<TrajectoryWatchdogStatus> trajectory_watchdog_status,
-    std::shared_ptr<SafetyMonitorStatus> safety_monitor_status,
-    std::shared_ptr<TrajectoryPublisherNode> publisher) {
-  TrajectoryVetter trajectory_vetter(quad_safety_limits_);
-  const Map3D inflated_map = map.Inflate(inflation_distance_);
-
-  while (this->ok_) {
-    // 1) Determine if trajectory has violated constraints
-    // 2) Grab lock
-    // 3) Check if modified
-    // 4) if true, grab trajectory, vet, and then publish
-    // 5) else continue
-
-    // Determine if quad has violated state constraints. If it has, freeze it in
-    // place
-    QuadState current_state;
-    quad_state_warden->Read(key, current_state);
-    // Get the current position of the quad
-    Eigen::Vector3d current_position = current_state.Position();
-
-    if ((quad_state_watchdog_status->Read(key)).code ==
-        MediationLayerCode::QuadViolatesMapBoundaries) {
-      //          std::cout << key << " Outside boundaries." << std::endl;
-      TrajectoryCode trajectoryCode;
-      trajectoryCode.code = MediationLayerCode::QuadViolatesMapBoundaries;
-      trajectory_warden_srv->SetTrajectoryStatus(key, trajectoryCode);
+    std::shared_ptr<TrajectoryWatchdogStatus> trajectory_watchdog_status) {
+  using Clock = KeyedEventQueue<size_t>::Clock;
+  const Clock::time_point now = Clock::now();
+  const std::string& key = context.key;
 
+  // Determine if quad has violated state constraints. If it has, freeze it in
+  // place
+  QuadState current_state;
+  quad_state_warden->Read(context.state_id, current_state);
+  // Get the current position of the quad
+  const Eigen::Vector3d current_position = current_state.Position();
+
+  const MediationLayerCode state_code =
+      (quad_state_watchdog_status->Read(context.quad_state_watchdog_id)).code;
+  if (state_code == MediationLayerCode::QuadViolatesMapBoundaries ||
+      state_code == MediationLayerCode::QuadTooCloseToAnotherQuad) {
+    // Freeze the quad at its current position, and keep re-freezing it on a
+    // timer for as long as the violation persists
+    if (false == context.frozen || context.refreeze_time <= now) {
       TrajectoryVector3D freeze_trajectory_vector =
           FreezeQuad(key, current_position);
-      trajectory_warden_pub->Write(key, freeze_trajectory_vector, publisher);
-      std::this_thread::sleep_for(std::chrono::milliseconds(1000));
-
-      if (joy_mode_) {
-        // if joy mode is true we want the walls of the arena to act as "padded
-        // walls", meaning we don't have a permanent game over freeze as we do
-        // with regular autonomy protocols
-        if (trajectory_warden_srv->ModifiedStatus(key)) {
-          Trajectory trajectory;
-          trajectory_warden_srv->Await(key, trajectory);
-
-          bool safe_to_move =
-              IsQuadMovingAwayFromObstacle(trajectory, inflated_map);
-          if (safe_to_move) {
-            TrajectoryCode trajectoryCode =
-                trajectory_vetter.Vet(trajectory, map, quad_state_warden, key);
-            trajectory_warden_srv->SetTrajectoryStatus(key, trajectoryCode);
-            if (trajectoryCode.code != MediationLayerCode::Success) {
-              std::cout
-                  << "Trajectory did not pass vetting: rejected with code "
-                  << static_cast<unsigned int>(trajectoryCode.code) << "."
-                  << std::endl;
-              continue;
-            }
-            quad_state_watchdog_status->SetExecution(key, true);
-            trajectory_warden_pub->Write(key, trajectory, publisher);
+      trajectory_warden_pub->Write(context.pub_id, freeze_trajectory_vector,
+                                   context.publisher);
+      context.frozen = true;
+      context.refreeze_time = now + this->options_.freeze_period;
+      this->events_->NotifyAt(context.index, context.refreeze_time);
+    }
+
+    if (false == trajectory_warden_srv->ModifiedStatus(context.srv_id)) {
+      return;
+    }
+
+    Trajectory trajectory;
+    uint64_t version = 0;
+    if (MediationLayerCode::Success !=
+        trajectory_warden_srv->Await(context.srv_id, trajectory, version)) {
+      return;
+    }
+
+    // A frozen quad may only be released by a trajectory that moves it away
+    // from the violation. If joy mode is true we want the walls of the arena
+    // to act as "padded walls", meaning we don't have a permanent game over
+    // freeze as we do with regular autonomy protocols
+    bool safe_to_move = false;
+    if (state_code == MediationLayerCode::QuadViolatesMapBoundaries) {
+      safe_to_move =
+          joy_mode_ && IsQuadMovingAwayFromObstacle(trajectory, inflated_map);
+    } else {
+      // Check that the quad moves away from the closest other quad
+      double closest_distance = std::numeric_limits<double>::max();
+      Eigen::Vector3d closest_position = current_position;
+      const QuadId num_quads = quad_state_warden->Keys().size();
+      for (QuadId other_id = 0; other_id < num_quads; ++other_id) {
+        if (other_id != context.state_id) {
+          QuadState other_quad_current_state;
+          quad_state_warden->Read(other_id, other_quad_current_state);
+          const Eigen::Vector3d other_quad_current_position =
+              other_quad_current_state.Position();
+          const double distance =
+              (other_quad_current_position - current_position).norm();
+          if (distance < closest_distance) {
+            closest_distance = distance;
+            closest_position = other_quad_current_position;
           }
         }
       }
-    } else if ((quad_state_watchdog_status->Read(key)).code ==
-               MediationLayerCode::QuadTooCloseToAnotherQuad) {
-      //          std::cout << key << " Quad too close to another quad." <<
-      //          std::endl;
+      const Polyhedron expanded_quad = ExpandQuad(closest_position, 1.0);
+      safe_to_move = IsQuadMovingAwayFromOtherQuad(trajectory, expanded_quad);
+    }
+
+    if (false == safe_to_move) {
       TrajectoryCode trajectoryCode;
-      trajectoryCode.code = MediationLayerCode::QuadTooCloseToAnotherQuad;
-      trajectory_warden_srv->SetTrajectoryStatus(key, trajectoryCode);
+      trajectoryCode.code = state_code;
+      trajectory_warden_srv->SetTrajectoryStatus(context.srv_id, version,
+                                                 trajectoryCode);
+      return;
+    }
 
-      TrajectoryVector3D freeze_trajectory_vector =
-          FreezeQuad(key, current_position);
-      trajectory_warden_pub->Write(key, freeze_trajectory_vector, publisher);
-      std::this_thread::sleep_for(std::chrono::milliseconds(1000));
-
-      if (trajectory_warden_srv->ModifiedStatus(key)) {
-        Trajectory trajectory;
-        trajectory_warden_srv->Await(key, trajectory);
-
-        const std::set<std::string> quad_names = quad_state_warden->Keys();
-        // Check if current quad too close to another quad
-        for (const std::string& other_quad_name : quad_names) {
-          if (other_quad_name != key) {
-            // Grab position of other quad
-            QuadState other_quad_current_state;
-            quad_state_warden->Read(other_quad_name, other_quad_current_state);
-            const Eigen::Vector3d other_quad_current_position =
-                other_quad_current_state.Position();
-            const Polyhedron expanded_quad =
-                ExpandQuad(other_quad_current_position, 1.0);
-
-            bool safe_to_move =
-                IsQuadMovingAwayFromOtherQuad(trajectory, expanded_quad);
-            if (safe_to_move) {
-              TrajectoryCode trajectoryCode = trajectory_vetter.Vet(
-                  trajectory, map, quad_state_warden, key);
-              trajectory_warden_srv->SetTrajectoryStatus(key, trajectoryCode);
-              if (trajectoryCode.code != MediationLayerCode::Success) {
-                std::cout
-                    << "Trajectory did not pass vetting: rejected with code "
-                    << static_cast<unsigned int>(trajectoryCode.code) << "."
-                    << std::endl;
-                continue;
-              }
-              quad_state_watchdog_status->SetExecution(key, true);
-              trajectory_warden_pub->Write(key, trajectory, publisher);
-            }
-          }
-        }
-      }
-    } else if ((trajectory_watchdog_status->Read(key)).code ==
-               MediationLayerCode::QuadTrajectoryCollidesWithAnotherQuad) {
+    TrajectoryCode trajectoryCode = trajectory_vetter.VetIncremental(
+        trajectory, context.accepted, map, quad_state_warden, key);
+    trajectory_warden_srv->SetTrajectoryStatus(context.srv_id, version,
+                                               trajectoryCode);
+    if (trajectoryCode.code != MediationLayerCode::Success) {
+      std::cout << "Trajectory did not pass vetting: rejected with code "
+                << static_cast<unsigned int>(trajectoryCode.code) << "."
+                << std::endl;
+      return;
+    }
+    quad_state_watchdog_status->SetExecution(context.quad_state_watchdog_id,
+                                             true);
+    trajectory_warden_pub->Write(context.pub_id, trajectory, context.publisher);
+    context.accepted = std::move(trajectory);
+
+    // Give the watchdog a full period to acknowledge the recovery before
+    // the quad is frozen again
+    context.refreeze_time = now + this->options_.freeze_period;
+    this->events_->NotifyAt(context.index, context.refreeze_time);
+    return;
+  }
+  context.frozen = false;
+
+  const TrajectoryCode trajectory_watchdog_code =
+      trajectory_watchdog_status->Read(context.trajectory_watchdog_id);
+  if (trajectory_watchdog_code.code !=
+      context.trajectory_watchdog_code) {
+    context.trajectory_watchdog_code = trajectory_watchdog_code.code;
+    if (trajectory_watchdog_code.code ==
+        MediationLayerCode::QuadTrajectoryCollidesWithAnotherQuad) {
       // Figure out where it hits the other quad
-      Trajectory main_trajectory;
-      trajectory_warden_pub->Read(key, main_trajectory);
-      double time =
-          main_trajectory.Time((trajectory_watchdog_status->Read(key)).index);
-      std::cout << key << " Trajectory collides with another quad in " << time
-                << " seconds." << std::endl;
-      if (time < 5.0) {
-        // intervene in some way
+      std::shared_ptr<const Trajectory> main_trajectory;
+      trajectory_warden_pub->Snapshot(context.pub_id, main_trajectory);
+      if (static_cast<size_t>(trajectory_watchdog_code.index) <
+          main_trajectory->Size()) {
+        double time = main_trajectory->Time(trajectory_watchdog_code.index);
+        std::cout << key << " Trajectory collides with another quad in "
+                  << time << " seconds." << std::endl;
+        if (time < 5.0) {
+          // intervene in some way
+        }
       }
     }
+  }
 
-    if (trajectory_warden_srv->ModifiedStatus(key)) {
-      Trajectory trajectory;
-      trajectory_warden_srv->Await(key, trajectory);
-      TrajectoryCode trajectoryCode =
-          trajectory_vetter.Vet(trajectory, map, quad_state_warden, key);
-      trajectory_warden_srv->SetTrajectoryStatus(key, trajectoryCode);
-      if (trajectoryCode.code != MediationLayerCode::Success) {
-        std::cerr << "Trajectory did not pass vetting: rejected with code "
-                  << static_cast<unsigned int>(trajectoryCode.code) << "."
-                  << std::endl;
-        continue;
-      }
-      trajectory_warden_pub->Write(key, trajectory, publisher);
+  if (trajectory_warden_srv->ModifiedStatus(context.srv_id)) {
+    Trajectory trajectory;
+    uint64_t version = 0;
+    if (MediationLayerCode::Success !=
+        trajectory_warden_srv->Await(context.srv_id, trajectory, version)) {
+      return;
+    }
+    TrajectoryCode trajectoryCode = trajectory_vetter.VetIncremental(
+        trajectory, context.accepted, map, quad_state_warden, key);
+    if (trajectoryCode.code != MediationLayerCode::Success &&
+        true == this->options_.truncate_rejected) {
+      trajectoryCode = this->Truncate(trajectory, trajectoryCode, map,
+                                      trajectory_vetter, quad_state_warden,
+                                      key);
+    }
+    trajectory_warden_srv->SetTrajectoryStatus(context.srv_id, version,
+                                               trajectoryCode);
+    if (trajectoryCode.code != MediationLayerCode::Success &&
+        trajectoryCode.code != MediationLayerCode::TrajectoryTruncated) {
+      std::cerr << "Trajectory did not pass vetting: rejected with code "
+                << static_cast<unsigned int>(trajectoryCode.code) << "."
+                << std::endl;
+      return;
     }
-    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    trajectory_warden_pub->Write(context.pub_id, trajectory, context.publisher);
+    context.accepted = std::move(trajectory);
   }
 }
 
@@ -266,40 +338,110 @@ void MediationLayer::Run(
     std::shared_ptr<SafetyMonitorStatus> safety_monitor_status,
     std::unordered_map<std::string, std::shared_ptr<TrajectoryPublisherNode>>
         trajectory_publishers) {
-  // Local thread pool
-  std::vector<std::thread> thread_pool;
+  const TrajectoryVetter trajectory_vetter(quad_safety_limits_);
+  const std::shared_ptr<const Map3D> inflated_map_ptr =
+      map.Inflated(inflation_distance_);
+  const Map3D& inflated_map = *inflated_map_ptr;
 
   // Get all registered trajectories
   const std::set<std::string> state_keys = quad_state_warden->Keys();
 
-  // Assign a thread to await changes in each trajectory
+  // Per-quad state. The vector is fully populated before any worker starts.
+  // The id maps translate the QuadId reported by each table's listener into
+  // an index into contexts.
+  constexpr size_t kNoContext = std::numeric_limits<size_t>::max();
+  std::vector<QuadContext> contexts;
+  std::vector<size_t> srv_contexts;
+  std::vector<size_t> quad_state_watchdog_contexts;
+  std::vector<size_t> trajectory_watchdog_contexts;
   for (const std::string& key : state_keys) {
-    thread_pool.push_back(std::move(std::thread([&]() {
-      TransferData(key, map, trajectory_warden_srv, trajectory_warden_pub,
-                   quad_state_warden, quad_state_watchdog_status,
-                   trajectory_watchdog_status, safety_monitor_status,
-                   trajectory_publishers[key]);
-    })));
+    QuadContext context;
+    context.key = key;
+    context.index = contexts.size();
+    context.publisher = trajectory_publishers[key];
+    if (MediationLayerCode::Success !=
+            trajectory_warden_srv->Id(key, context.srv_id) ||
+        MediationLayerCode::Success !=
+            trajectory_warden_pub->Id(key, context.pub_id) ||
+        MediationLayerCode::Success !=
+            quad_state_warden->Id(key, context.state_id) ||
+        false == quad_state_watchdog_status->Id(
+                     key, context.quad_state_watchdog_id) ||
+        false == trajectory_watchdog_status->Id(
+                     key, context.trajectory_watchdog_id)) {
+      std::cerr << "MediationLayer: " << key
+                << " is not registered with every table. Not mediating."
+                << std::endl;
+      continue;
+    }
+
+    auto assign = [&](std::vector<size_t>& table, const QuadId id) {
+      if (id >= table.size()) {
+        table.resize(id + 1, kNoContext);
+      }
+      table[id] = context.index;
+    };
+    assign(srv_contexts, context.srv_id);
+    assign(quad_state_watchdog_contexts, context.quad_state_watchdog_id);
+    assign(trajectory_watchdog_contexts, context.trajectory_watchdog_id);
+    contexts.push_back(context);
   }
 
-  // Wait for this thread to receive a stop command
-  std::thread kill_thread([&, this]() {
-    while (true) {
-      if (false == ok_) {
-        break;
-      } else {
-        std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+  // Wake up whenever a trajectory is submitted or a watchdog status changes.
+  // Ids that belong to quads without a context are ignored.
+  std::shared_ptr<KeyedEventQueue<size_t>> events = this->events_;
+  auto notifier = [events](const std::vector<size_t>& table) {
+    return [events, table](const QuadId id) {
+      if (id < table.size() && kNoContext != table[id]) {
+        events->Notify(table[id]);
       }
-    }
-  });
+    };
+  };
+  const ListenerList::Handle srv_listener =
+      trajectory_warden_srv->AddListener(notifier(srv_contexts));
+  const ListenerList::Handle quad_state_watchdog_listener =
+      quad_state_watchdog_status->AddListener(
+          notifier(quad_state_watchdog_contexts));
+  const ListenerList::Handle trajectory_watchdog_listener =
+      trajectory_watchdog_status->AddListener(
+          notifier(trajectory_watchdog_contexts));
+
+  // Handle anything that happened before the listeners were attached
+  for (const QuadContext& context : contexts) {
+    events->Notify(context.index);
+  }
 
-  kill_thread.join();
+  // Local thread pool. The event queue guarantees that a quad is only
+  // mediated by one worker at a time.
+  std::vector<std::thread> thread_pool;
+  const size_t worker_threads = std::max<size_t>(1, options_.worker_threads);
+  for (size_t idx = 0; idx < worker_threads; ++idx) {
+    thread_pool.emplace_back([&]() {
+      size_t index;
+      while (events->Acquire(index)) {
+        // A listener removed by an earlier run may still report an index
+        // that this run does not have
+        if (index < contexts.size()) {
+          MediateQuad(contexts[index], map, inflated_map, trajectory_vetter,
+                      trajectory_warden_srv, trajectory_warden_pub,
+                      quad_state_warden, quad_state_watchdog_status,
+                      trajectory_watchdog_status);
+        }
+        events->Release(index);
+      }
+    });
+  }
 
   // Wait for thread pool to terminate
   for (std::thread& t : thread_pool) {
     t.join();
   }
+
+  trajectory_warden_srv->RemoveListener(srv_listener);
+  quad_state_watchdog_status->RemoveListener(quad_state_watchdog_listener);
+  trajectory_watchdog_status->RemoveListener(trajectory_watchdog_listener);
+  events->Reset();
 }
 
-void MediationLayer::Stop() { ok_ = false; }
+void MediationLayer::Stop() { events_->Stop(); }
 }  // namespace game_engine
@@ -1,17 +1,21 @@
 #pragma once
 
 #include <atomic>
+#include <chrono>
 #include <random>
 #include <string>
 
+#include "keyed_event_queue.h"
 #include "map3d.h"
 #include "polyhedron.h"
+#include "quad_id.h"
 #include "quad_safety_status.h"
 #include "quad_state_watchdog_status.h"
 #include "safety_monitor_status.h"
 #include "trajectory_client.h"
 #include "trajectory_code.h"
 #include "trajectory_publisher_node.h"
+#include "trajectory_vetter.h"
 #include "trajectory_watchdog_status.h"
 #include "types.h"
 #include "warden.h"
@@ -25,36 +29,95 @@ namespace game_engine {
 // obstacles in the environment.
 //
 class MediationLayer {
+ public:
+  struct Options {
+    // Number of worker threads that mediate trajectories. Each quad is only
+    // ever handled by one worker at a time.
+    size_t worker_threads = 2;
+
+    // Period at which a frozen quad is re-frozen at its current position
+    std::chrono::milliseconds freeze_period = std::chrono::milliseconds(1000);
+
+    // Whether a trajectory that fails vetting is cut short rather than
+    // rejected. The longest prefix that passes vetting is published,
+    // followed by a stop, and TrajectoryTruncated is returned with the
+    // number of samples that were kept.
+    bool truncate_rejected = false;
+
+    // Fraction of the vetter's maximum acceleration used to stop at the end
+    // of a truncated trajectory
+    double stop_acceleration_fraction = 0.9;
+
+    Options() {}
+  };
+
  private:
   int quad_safety_limits_ = 0;
   bool joy_mode_ = false;
   double inflation_distance_ = 0;
-  volatile std::atomic_bool ok_{true};
+  Options options_;
+
+  // Wakes the workers whenever a trajectory is submitted, a watchdog status
+  // changes, or a freeze timer expires. Keys are indices into the contexts
+  // built by Run().
+  std::shared_ptr<KeyedEventQueue<size_t>> events_;
 
-  // Transfers data associated with key from trajectory_warden_srv to
-  // trajectory_warden_pub
-  void TransferData(
-      const std::string& key, const Map3D& map,
+  // Mediation state kept for every quad between events. The QuadIds of each
+  // table are resolved once in Run() so that mediation never hashes the quad
+  // name.
+  struct QuadContext {
+    std::string key;
+    size_t index = 0;
+    QuadId srv_id = 0;
+    QuadId pub_id = 0;
+    QuadId state_id = 0;
+    QuadId quad_state_watchdog_id = 0;
+    QuadId trajectory_watchdog_id = 0;
+    std::shared_ptr<TrajectoryPublisherNode> publisher;
+    bool frozen = false;
+    KeyedEventQueue<size_t>::Clock::time_point refreeze_time;
+    MediationLayerCode trajectory_watchdog_code = MediationLayerCode::Success;
+
+    // The last trajectory that passed vetting. Submissions that share a
+    // prefix with it only have the rest of their samples vetted.
+    Trajectory accepted;
+  };
+
+  // Handles every pending event for the quad associated with context
+  void MediateQuad(
+      QuadContext& context, const Map3D& map, const Map3D& inflated_map,
+      const TrajectoryVetter& trajectory_vetter,
       std::shared_ptr<TrajectoryWardenServer> trajectory_warden_srv,
       std::shared_ptr<TrajectoryWardenPublisher> trajectory_warden_pub,
       std::shared_ptr<QuadStateWarden> quad_state_warden,
       std::shared_ptr<QuadStateWatchdogStatus> quad_state_watchdog_status,
-      std::shared_ptr<TrajectoryWatchdogStatus> trajectory_watchdog_status,
-      std::shared_ptr<SafetyMonitorStatus> safety_monitor_status,
-      std::shared_ptr<TrajectoryPublisherNode> publisher);
+      std::shared_ptr<TrajectoryWatchdogStatus> trajectory_watchdog_status);
+
+  // Replaces a trajectory that failed vetting with its longest safe prefix
+  // followed by a stop. Returns TrajectoryTruncated if the trajectory was
+  // replaced, or trajectory_code if no safe prefix can be stopped safely.
+  TrajectoryCode Truncate(
+      Trajectory& trajectory, const TrajectoryCode& trajectory_code,
+      const Map3D& map, const TrajectoryVetter& trajectory_vetter,
+      std::shared_ptr<QuadStateWarden> quad_state_warden,
+      const std::string& key);
 
   TrajectoryVector3D FreezeQuad(const std::string& key,
                                 const Eigen::Vector3d freeze_quad_position);
-  bool IsQuadMovingAwayFromOtherQuad(const Trajectory main_trajectory,
-                                     const Polyhedron violation_space);
-  bool IsQuadMovingAwayFromObstacle(const Trajectory main_trajectory,
-                                    const Map3D inflated_map);
+  bool IsQuadMovingAwayFromOtherQuad(const Trajectory& main_trajectory,
+                                     const Polyhedron& violation_space);
+  bool IsQuadMovingAwayFromObstacle(const Trajectory& main_trajectory,
+                                    const Map3D& inflated_map);
   Polyhedron ExpandQuad(const Eigen::Vector3d cm,
                         const double inflation_distance);
 
  public:
-  MediationLayer(const int& quad_safety_limits, const bool& joy_mode)
-      : quad_safety_limits_(quad_safety_limits), joy_mode_(joy_mode) {
+  MediationLayer(const int& quad_safety_limits, const bool& joy_mode,
+                 const Options& options = Options())
+      : quad_safety_limits_(quad_safety_limits),
+        joy_mode_(joy_mode),
+        options_(options),
+        events_(std::make_shared<KeyedEventQueue<size_t>>()) {
     if (quad_safety_limits_ == 2) {
       // extreme mode
       inflation_distance_ =
@@ -69,7 +132,8 @@ class MediationLayer {
     }
   }
 
-  // Run the mediation layer.
+  // Run the mediation layer. Rather than polling, a small pool of workers
+  // sleeps until a trajectory is submitted or a watchdog status changes.
   //
   // Note: These values are intentionally copied
   void Run(
@@ -83,7 +147,8 @@ class MediationLayer {
       std::unordered_map<std::string, std::shared_ptr<TrajectoryPublisherNode>>
           trajectory_publishers);
 
-  // Stop this thread and all sub-threads
+  // Stop this thread and all sub-threads. Once Run() has returned, it may be
+  // called again.
   void Stop();
 };
 }  // namespace game_engine
@@ -221,29 +221,46 @@ void PhysicsSimulator::Run(
   // Integrator
   RungeKutta4<Eigen::Matrix<double, 9, 1>> rk4;
 
-  // Extract quad names
+  // Extract quad names and resolve their QuadIds once. Quads without a
+  // trajectory are not simulated.
   std::vector<std::string> quad_names;
+  std::vector<QuadId> quad_ids;
+  std::vector<std::shared_ptr<QuadStatePublisherNode>> publishers;
   for (const auto& kv : quad_state_publishers) {
+    QuadId id;
+    if (MediationLayerCode::Success !=
+        trajectory_warden_sub->Id(kv.first, id)) {
+      continue;
+    }
     quad_names.push_back(kv.first);
+    quad_ids.push_back(id);
+    publishers.push_back(kv.second);
   }
 
-  // Store the last location of the quads
-  std::map<std::string, Eigen::Matrix<double, 9, 1>, std::less<std::string>,
-           Eigen::aligned_allocator<
-               std::pair<const std::string, Eigen::Matrix<double, 9, 1>>>>
+  // Store the last location of the quads, indexed like quad_names
+  std::vector<Eigen::Matrix<double, 9, 1>,
+              Eigen::aligned_allocator<Eigen::Matrix<double, 9, 1>>>
       pva_perturbed_register;
 
   // Initially, the quads are in their current state
   for (const std::string& quad_name : quad_names) {
-    pva_perturbed_register[quad_name] =
+    pva_perturbed_register.push_back(
         (Eigen::Matrix<double, 9, 1>()
              << this->options_.initial_quad_positions[quad_name](0),
          this->options_.initial_quad_positions[quad_name](1),
          this->options_.initial_quad_positions[quad_name](2), 0, 0, 0, 0, 0, 0)
-            .finished();
+            .finished());
   }
 
-  while (this->ok_) {
+  // The trajectory each quad is following. A snapshot is only re-fetched
+  // when the warden reports a newer version. The index found on the
+  // previous tick is kept so that the time search resumes from there.
+  std::vector<std::shared_ptr<const Trajectory>> trajectories(quad_ids.size());
+  std::vector<uint64_t> trajectory_versions(quad_ids.size(), 0);
+  std::vector<size_t> trajectory_indices(quad_ids.size(), 0);
+
+  const StopToken stop_token = this->stop_source_.Token();
+  while (false == stop_token.StopRequested()) {
     // Current time
     const auto current_time = std::chrono::system_clock::now();
 
@@ -258,10 +275,19 @@ void PhysicsSimulator::Run(
             current_time.time_since_epoch() + this->options_.simulation_time)
             .count();
 
-    for (const std::string& quad_name : quad_names) {
-      // Read the most current trajectory
-      Trajectory trajectory;
-      trajectory_warden_sub->Read(quad_name, trajectory);
+    for (size_t quad_idx = 0; quad_idx < quad_ids.size(); ++quad_idx) {
+      // Share the most current trajectory. The snapshot is immutable, so it
+      // does not need to be copied out of the warden.
+      if (MediationLayerCode::Success ==
+          trajectory_warden_sub->SnapshotIfNewer(
+              quad_ids[quad_idx], trajectory_versions[quad_idx],
+              trajectories[quad_idx])) {
+        trajectory_indices[quad_idx] = 0;
+      }
+      if (nullptr == trajectories[quad_idx]) {
+        continue;
+      }
+      const Trajectory& trajectory = *trajectories[quad_idx];
 
       // Require a trajectory to be published
       const size_t trajectory_size = trajectory.Size();
@@ -274,12 +300,14 @@ void PhysicsSimulator::Run(
       // A trajectory may not have been updated between simulation periods.
       // Must find the index in the trajectory that most closely aligns with
       // the current time. Assume a zero-order-hold for intended trajectory
-      // inputs. Always round down.
-      size_t trajectory_idx = 0;
+      // inputs. Always round down. Time only moves forward, so the search
+      // starts from the index found on the previous tick.
+      const size_t search_start = trajectory_indices[quad_idx];
+      size_t trajectory_idx = search_start;
       if (trajectory.Time(trajectory_size - 1) < current_time_float) {
         trajectory_idx = trajectory.Size() - 1;
       } else {
-        for (size_t idx = 0; idx < trajectory_size; ++idx) {
+        for (size_t idx = search_start; idx < trajectory_size; ++idx) {
           if (trajectory.Time(idx) > current_time_float) {
             trajectory_idx = ((idx == 0) ? 0 : idx - 1);
             break;
@@ -287,12 +315,14 @@ void PhysicsSimulator::Run(
         }
       }
 
+      trajectory_indices[quad_idx] = trajectory_idx;
+
       // Forward simulate
       // If simulation window extends beyond the provided trajectory window,
       // hold the last position.
       Eigen::Matrix<double, 9, 1> pva_intended = trajectory.PVA(trajectory_idx);
       Eigen::Matrix<double, 9, 1> pva_perturbed =
-          pva_perturbed_register[quad_name];
+          pva_perturbed_register[quad_idx];
       TimeSpan ts(0, 1, 0.5);
       while (true) {
         if (trajectory_idx != trajectory_size - 1) {
@@ -414,26 +444,29 @@ void PhysicsSimulator::Run(
         }
       }
 
-      pva_perturbed_register[quad_name] = pva_perturbed;
+      pva_perturbed_register[quad_idx] = pva_perturbed;
     }
 
-    std::this_thread::sleep_until(current_time +
-                                  this->options_.simulation_time);
+    if (true == stop_token.WaitUntil(current_time +
+                                     this->options_.simulation_time)) {
+      break;
+    }
 
     // Publish
-    for (const auto& kv : quad_state_publishers) {
-      const std::string& quad_name = kv.first;
+    for (size_t quad_idx = 0; quad_idx < publishers.size(); ++quad_idx) {
       const Eigen::Matrix<double, 9, 1> pva_perturbed =
-          pva_perturbed_register[quad_name];
+          pva_perturbed_register[quad_idx];
       QuadState quad_state((Eigen::Matrix<double, 13, 1>() << pva_perturbed(0),
                             pva_perturbed(1), pva_perturbed(2),
                             pva_perturbed(3), pva_perturbed(4),
                             pva_perturbed(5), 1, 0, 0, 0, 0, 0, 0)
                                .finished());
-      quad_state_publishers[quad_name]->Publish(quad_state);
+      publishers[quad_idx]->Publish(quad_state);
     }
   }
+
+  this->stop_source_.Reset();
 }
 
-void PhysicsSimulator::Stop() { this->ok_ = false; }
+void PhysicsSimulator::Stop() { this->stop_source_.RequestStop(); }
 }  // namespace game_engine
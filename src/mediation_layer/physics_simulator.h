@@ -13,6 +13,7 @@
 #include <utility>
 
 #include "quad_state_publisher_node.h"
+#include "stop_token.h"
 #include "warden.h"
 
 namespace game_engine {
@@ -92,10 +93,12 @@ class PhysicsSimulator {
           quad_state_publishers,
       unsigned int seed);
 
+  // Stop this thread. Wakes it immediately if it is sleeping. Once Run()
+  // has returned, it may be called again.
   void Stop();
 
  private:
   Options options_;
-  volatile std::atomic_bool ok_{true};
+  StopSource stop_source_;
 };
 }  // namespace game_engine
@@ -38,11 +38,16 @@ Polyhedron QuadStateWatchdog::CreateQuad(const Eigen::Vector3d cm) {
   return poly;
 }
 
-void QuadStateWatchdog::Run(
+void QuadStateWatchdog::Schedule(
+    PeriodicScheduler& scheduler,
     std::shared_ptr<QuadStateWarden> quad_state_warden,
     const std::vector<std::string>& quad_names,
     std::shared_ptr<QuadStateWatchdogStatus> quad_state_watchdog_status,
-    const Map3D map) {
+    const Map3D& map) {
+  std::shared_ptr<Context> context = std::make_shared<Context>();
+  context->quad_state_warden = quad_state_warden;
+  context->quad_state_watchdog_status = quad_state_watchdog_status;
+
   // Inflate the map by min_distance. This creates a new map whose obstacles
   // have been expanded by min_distance and whose boundaries have been shrunk
   // by min_distance. After inflating the map, the quadcopter may be treated
@@ -51,89 +56,135 @@ void QuadStateWatchdog::Run(
   // whether the quad's center point is intersecting any of the inflate
   // obstacles. The distance between quads is also determined and a violation
   // is reported if the quads get too close.
-  const Map3D inflated_map = map.Inflate(this->options_.min_distance);
+  context->inflated_map = map.Inflated(this->options_.min_distance);
+
+  // Resolve the QuadIds of every quad once. Quads that are missing from
+  // either table are not watched.
   for (const std::string& quad_name : quad_names) {
-    this->locked_freeze_[quad_name] = false;
+    QuadId state_id, status_id;
+    if (MediationLayerCode::Success !=
+            quad_state_warden->Id(quad_name, state_id) ||
+        false == quad_state_watchdog_status->Id(quad_name, status_id)) {
+      continue;
+    }
+    context->state_ids.push_back(state_id);
+    context->status_ids.push_back(status_id);
   }
+  context->locked_freeze.assign(context->state_ids.size(), false);
 
-  while (this->ok_) {
-    for (const std::string& quad_name : quad_names) {
-      // Read in the current state
-      QuadState current_state;
-      quad_state_warden->Read(quad_name, current_state);
-      // Get the current position of the quad
-      Eigen::Vector3d current_position = current_state.Position();
-
-      // Evaluate whether the current position intersects an obstacle
-      bool infraction_occurred = !inflated_map.IsFreeSpace(current_position) ||
-                                 !inflated_map.Contains(current_position);
-
-      if (infraction_occurred || locked_freeze_.at(quad_name)) {
-        quad_state_watchdog_status->Write(
-            quad_name, MediationLayerCode::QuadViolatesMapBoundaries);
-        if (!joy_mode_) {
-          locked_freeze_[quad_name] = true;
-        } else {
-          if (quad_state_watchdog_status->ReadExecution(quad_name)) {
-            quad_state_watchdog_status->Write(quad_name,
-                                              MediationLayerCode::Success);
-            std::this_thread::sleep_for(std::chrono::milliseconds(1500));
-          }
+  scheduler.AddTask("quad_state_watchdog", this->options_.period,
+                    [this, context]() { this->Check(*context); });
+}
+
+void QuadStateWatchdog::Run(
+    std::shared_ptr<QuadStateWarden> quad_state_warden,
+    const std::vector<std::string>& quad_names,
+    std::shared_ptr<QuadStateWatchdogStatus> quad_state_watchdog_status,
+    const Map3D map) {
+  PeriodicScheduler::Options scheduler_options;
+  scheduler_options.worker_threads = 1;
+  PeriodicScheduler scheduler(scheduler_options);
+  this->Schedule(scheduler, quad_state_warden, quad_names,
+                 quad_state_watchdog_status, map);
+  scheduler.Run(this->stop_source_.Token());
+
+  this->stop_source_.Reset();
+}
+
+void QuadStateWatchdog::Check(Context& context) {
+  const PeriodicScheduler::Clock::time_point now =
+      PeriodicScheduler::Clock::now();
+  if (now < context.resume_time) {
+    return;
+  }
+
+  const Map3D& inflated_map = *context.inflated_map;
+  const std::vector<QuadId>& state_ids = context.state_ids;
+  const std::shared_ptr<QuadStateWarden>& quad_state_warden =
+      context.quad_state_warden;
+  const std::shared_ptr<QuadStateWatchdogStatus>& quad_state_watchdog_status =
+      context.quad_state_watchdog_status;
+
+  for (size_t quad_idx = 0; quad_idx < state_ids.size(); ++quad_idx) {
+    const QuadId state_id = state_ids[quad_idx];
+    const QuadId status_id = context.status_ids[quad_idx];
+
+    // Read in the current state
+    QuadState current_state;
+    quad_state_warden->Read(state_id, current_state);
+    // Get the current position of the quad
+    Eigen::Vector3d current_position = current_state.Position();
+
+    // Evaluate whether the current position intersects an obstacle
+    bool infraction_occurred = !inflated_map.IsFreeSpace(current_position) ||
+                               !inflated_map.Contains(current_position);
+
+    if (infraction_occurred || context.locked_freeze[quad_idx]) {
+      quad_state_watchdog_status->Write(
+          status_id, MediationLayerCode::QuadViolatesMapBoundaries);
+      if (!joy_mode_) {
+        context.locked_freeze[quad_idx] = true;
+      } else {
+        if (quad_state_watchdog_status->ReadExecution(status_id)) {
+          quad_state_watchdog_status->Write(status_id,
+                                            MediationLayerCode::Success);
+          context.resume_time = now + this->options_.recovery_hold;
+          return;
         }
       }
+    }
 
-      else if (quad_state_watchdog_status->ReadExecution(quad_name)) {
-        quad_state_watchdog_status->Write(quad_name,
-                                          MediationLayerCode::Success);
-        std::this_thread::sleep_for(std::chrono::milliseconds(1500));
-      }
+    else if (quad_state_watchdog_status->ReadExecution(status_id)) {
+      quad_state_watchdog_status->Write(status_id,
+                                        MediationLayerCode::Success);
+      context.resume_time = now + this->options_.recovery_hold;
+      return;
+    }
 
-      // Check if current quad too close to another quad
-      else if (quad_names.size() > 1) {
-        //          inflated_map.ClearDynamicObstacles();
-        for (const std::string& other_quad_name : quad_names) {
-          if (other_quad_name != quad_name) {
-            // Grab position of other quad
-            QuadState other_quad_current_state;
-            quad_state_warden->Read(other_quad_name, other_quad_current_state);
-            Eigen::Vector3d other_quad_current_position =
-                other_quad_current_state.Position();
-
-            quad_state_warden->Read(quad_name, current_state);
-            // Get the current position of the quad
-            current_position = current_state.Position();
-            //              inflated_map.AddInflatedDynamicObstacle(other_quad_name,
-            //              CreateQuad(other_quad_current_position),
-            //              this->options_.min_distance_btwn_quads);
-            //
-            //              if(!inflated_map.IsFreeDynamicSpace(other_quad_name,
-            //              current_position)) {
-            //                quad_state_watchdog_status->Write(quad_name,
-            //                MediationLayerCode::QuadTooCloseToAnotherQuad);
-            //              } else {
-            //                quad_state_watchdog_status->Write(quad_name,
-            //                MediationLayerCode::Success);
-            //              }
-            //              // Check if distance between quads is less than the
-            //              limit
-            if ((other_quad_current_position - current_position).norm() <
-                this->options_.min_distance_btwn_quads) {
-              quad_state_watchdog_status->Write(
-                  quad_name, MediationLayerCode::QuadTooCloseToAnotherQuad);
-            } else {
-              quad_state_watchdog_status->Write(quad_name,
-                                                MediationLayerCode::Success);
-            }
+    // Check if current quad too close to another quad
+    else if (state_ids.size() > 1) {
+      //          inflated_map.ClearDynamicObstacles();
+      for (const QuadId other_state_id : state_ids) {
+        if (other_state_id != state_id) {
+          // Grab position of other quad
+          QuadState other_quad_current_state;
+          quad_state_warden->Read(other_state_id, other_quad_current_state);
+          Eigen::Vector3d other_quad_current_position =
+              other_quad_current_state.Position();
+
+          quad_state_warden->Read(state_id, current_state);
+          // Get the current position of the quad
+          current_position = current_state.Position();
+          //              inflated_map.AddInflatedDynamicObstacle(other_quad_name,
+          //              CreateQuad(other_quad_current_position),
+          //              this->options_.min_distance_btwn_quads);
+          //
+          //              if(!inflated_map.IsFreeDynamicSpace(other_quad_name,
+          //              current_position)) {
+          //                quad_state_watchdog_status->Write(status_id,
+          //                MediationLayerCode::QuadTooCloseToAnotherQuad);
+          //              } else {
+          //                quad_state_watchdog_status->Write(status_id,
+          //                MediationLayerCode::Success);
+          //              }
+          //              // Check if distance between quads is less than the
+          //              limit
+          if ((other_quad_current_position - current_position).norm() <
+              this->options_.min_distance_btwn_quads) {
+            quad_state_watchdog_status->Write(
+                status_id, MediationLayerCode::QuadTooCloseToAnotherQuad);
+          } else {
+            quad_state_watchdog_status->Write(status_id,
+                                              MediationLayerCode::Success);
           }
         }
-      } else {
-        quad_state_watchdog_status->Write(quad_name,
-                                          MediationLayerCode::Success);
       }
+    } else {
+      quad_state_watchdog_status->Write(status_id,
+                                        MediationLayerCode::Success);
     }
-    std::this_thread::sleep_for(std::chrono::milliseconds(30));
   }
 }
 
-void QuadStateWatchdog::Stop() { this->ok_ = false; }
+void QuadStateWatchdog::Stop() { this->stop_source_.RequestStop(); }
 }  // namespace game_engine
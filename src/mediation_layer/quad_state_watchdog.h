@@ -1,11 +1,15 @@
 #pragma once
 
+#include <chrono>
 #include <memory>
 #include <string>
 #include <vector>
 
 #include "map3d.h"
+#include "periodic_scheduler.h"
+#include "quad_id.h"
 #include "quad_state_watchdog_status.h"
+#include "stop_token.h"
 #include "trajectory_code.h"
 #include "warden.h"
 
@@ -21,6 +25,13 @@ class QuadStateWatchdog {
     // Minimum l-infinity distance from all other quads that a quad may fly
     double min_distance_btwn_quads = 1.0;
 
+    // Period at which the quads are checked
+    std::chrono::milliseconds period = std::chrono::milliseconds(30);
+
+    // After a quad is released to execute a recovery trajectory, checks are
+    // suspended for this long to give it time to move away
+    std::chrono::milliseconds recovery_hold = std::chrono::milliseconds(1500);
+
     Options() {}
   };
 
@@ -41,7 +52,16 @@ class QuadStateWatchdog {
     }
   }
 
-  // Main thread function
+  // Register the watchdog with a scheduler. The scheduler owns the thread;
+  // stopping the scheduler stops the watchdog.
+  void Schedule(
+      PeriodicScheduler& scheduler,
+      std::shared_ptr<QuadStateWarden> quad_state_warden,
+      const std::vector<std::string>& quad_names,
+      std::shared_ptr<QuadStateWatchdogStatus> quad_state_watchdog_status,
+      const Map3D& map);
+
+  // Main thread function. Runs the watchdog on its own scheduler.
   void Run(std::shared_ptr<QuadStateWarden> quad_state_warden,
            const std::vector<std::string>& quad_names,
            std::shared_ptr<QuadStateWatchdogStatus> quad_state_watchdog_status,
@@ -49,14 +69,32 @@ class QuadStateWatchdog {
 
   Polyhedron CreateQuad(const Eigen::Vector3d cm);
 
-  // Stop this thread
+  // Stop this thread. Wakes it immediately if it is sleeping. Once Run()
+  // has returned, it may be called again.
   void Stop();
 
  private:
-  volatile std::atomic_bool ok_{true};
+  // State carried between checks
+  struct Context {
+    std::shared_ptr<QuadStateWarden> quad_state_warden;
+    std::shared_ptr<QuadStateWatchdogStatus> quad_state_watchdog_status;
+    std::shared_ptr<const Map3D> inflated_map;
+
+    // The QuadIds of every watched quad in each table, and whether it has
+    // been permanently frozen
+    std::vector<QuadId> state_ids;
+    std::vector<QuadId> status_ids;
+    std::vector<bool> locked_freeze;
+
+    // Checks are suspended until this time
+    PeriodicScheduler::Clock::time_point resume_time;
+  };
+
+  void Check(Context& context);
+
+  StopSource stop_source_;
   Options options_;
   int quad_safety_limits_;
   bool joy_mode_;
-  std::unordered_map<std::string, bool> locked_freeze_;
 };
 }  // namespace game_engine
@@ -2,58 +2,130 @@
 
 namespace game_engine {
 void QuadStateWatchdogStatus::Register(const std::string& quad_name) {
-  std::lock_guard<std::mutex> lock(mtx_);
   InfractionInfo info = {MediationLayerCode::RegisterQuadWithWatchdog, 0};
-  this->infraction_map_[quad_name] = info;
-  this->allow_execution_[quad_name] = false;
+  const auto it = this->ids_.find(quad_name);
+  if (this->ids_.end() != it) {
+    this->slots_[it->second].infraction.Store(info);
+    this->slots_[it->second].allow_execution = false;
+    return;
+  }
+
+  this->ids_[quad_name] = this->slots_.size();
+  this->slots_.emplace_back();
+  this->slots_.back().infraction.Store(info);
 }
 
-InfractionInfo QuadStateWatchdogStatus::Read(
-    const std::string& quad_name) const {
-  std::lock_guard<std::mutex> lock(mtx_);
-  try {
-    return this->infraction_map_.at(quad_name);
-  } catch (std::out_of_range e) {
+bool QuadStateWatchdogStatus::Id(const std::string& quad_name,
+                                 QuadId& id) const {
+  const auto it = this->ids_.find(quad_name);
+  if (this->ids_.end() == it) {
     std::cerr << "Quad with name " << quad_name
               << " is not registered with the QuadStateWatchdog." << std::endl;
+    return false;
+  }
+  id = it->second;
+  return true;
+}
+
+QuadStateWatchdogStatus::Slot* QuadStateWatchdogStatus::Find(const QuadId id) {
+  if (id >= this->slots_.size()) {
+    std::cerr << "Quad with id " << id
+              << " is not registered with the QuadStateWatchdog." << std::endl;
+    return nullptr;
+  }
+  return &this->slots_[id];
+}
+
+const QuadStateWatchdogStatus::Slot* QuadStateWatchdogStatus::Find(
+    const QuadId id) const {
+  return const_cast<QuadStateWatchdogStatus*>(this)->Find(id);
+}
+
+InfractionInfo QuadStateWatchdogStatus::Read(
+    const std::string& quad_name) const {
+  QuadId id;
+  if (false == this->Id(quad_name, id)) {
     return {MediationLayerCode::QuadNotRegistered, 0};
   }
+  return this->Read(id);
+}
+
+InfractionInfo QuadStateWatchdogStatus::Read(const QuadId id) const {
+  const Slot* slot = this->Find(id);
+  if (nullptr == slot) {
+    return {MediationLayerCode::QuadNotRegistered, 0};
+  }
+  return slot->infraction.Load();
 }
 
 void QuadStateWatchdogStatus::Write(
     const std::string& quad_name,
     const MediationLayerCode infraction_occurred) {
-  std::lock_guard<std::mutex> lock(mtx_);
-  try {
-    std::chrono::time_point<std::chrono::system_clock> now =
-        std::chrono::system_clock::now();
-    auto time = std::chrono::duration_cast<std::chrono::milliseconds>(
-                    now.time_since_epoch())
-                    .count();
-
-    InfractionInfo info = {infraction_occurred, time};
-    this->infraction_map_.at(quad_name) = info;
-  } catch (std::out_of_range e) {
-    std::cerr << "Quad with name " << quad_name
-              << " is not registered with the QuadStateWatchdog." << std::endl;
+  QuadId id;
+  if (true == this->Id(quad_name, id)) {
+    this->Write(id, infraction_occurred);
+  }
+}
+
+void QuadStateWatchdogStatus::Write(
+    const QuadId id, const MediationLayerCode infraction_occurred) {
+  Slot* slot = this->Find(id);
+  if (nullptr == slot) {
     return;
   }
+
+  std::chrono::time_point<std::chrono::system_clock> now =
+      std::chrono::system_clock::now();
+  auto time = std::chrono::duration_cast<std::chrono::milliseconds>(
+                  now.time_since_epoch())
+                  .count();
+
+  InfractionInfo info = {infraction_occurred, time};
+  const InfractionInfo previous = slot->infraction.Exchange(info);
+
+  if (previous.code != infraction_occurred) {
+    this->listeners_.Notify(id);
+  }
 }
 
 void QuadStateWatchdogStatus::SetExecution(const std::string& quad_name,
                                            const bool execution) {
-  this->allow_execution_[quad_name] = execution;
+  QuadId id;
+  if (true == this->Id(quad_name, id)) {
+    this->SetExecution(id, execution);
+  }
+}
+
+void QuadStateWatchdogStatus::SetExecution(const QuadId id,
+                                           const bool execution) {
+  if (id < this->slots_.size()) {
+    this->slots_[id].allow_execution = execution;
+  }
 }
 
 bool QuadStateWatchdogStatus::ReadExecution(const std::string& quad_name) {
-  try {
-    bool allow = this->allow_execution_.at(quad_name);
-    SetExecution(quad_name, false);
-    return allow;
-  } catch (std::out_of_range e) {
-    std::cerr << "Quad with name " << quad_name
-              << " is not registered with the QuadStateWatchdog." << std::endl;
+  QuadId id;
+  if (false == this->Id(quad_name, id)) {
     return false;
   }
+  return this->ReadExecution(id);
+}
+
+bool QuadStateWatchdogStatus::ReadExecution(const QuadId id) {
+  Slot* slot = this->Find(id);
+  if (nullptr == slot) {
+    return false;
+  }
+  return slot->allow_execution.exchange(false);
+}
+
+ListenerList::Handle QuadStateWatchdogStatus::AddListener(
+    const ListenerList::Listener& listener) {
+  return this->listeners_.Add(listener);
+}
+
+void QuadStateWatchdogStatus::RemoveListener(
+    const ListenerList::Handle handle) {
+  this->listeners_.Remove(handle);
 }
 }  // namespace game_engine
@@ -2,12 +2,17 @@
 
 #include <atomic>
 #include <chrono>
+#include <deque>
+#include <functional>
 #include <iostream>
-#include <mutex>
 #include <stdexcept>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
+#include "listener_list.h"
+#include "quad_id.h"
+#include "seqlock.h"
 #include "trajectory_code.h"
 
 namespace game_engine {
@@ -18,23 +23,56 @@ struct InfractionInfo {
 // Struct that contains information about the status of the QuadStateWatchdog.
 // If the QuadStateWatchdog determines that a quadcopter has flown too close to
 // an obstacle, an instance of this status is updated to reflect that.
+//
+// Quads are assigned dense QuadIds in registration order. The QuadId overloads
+// index per-quad slots; the name overloads resolve the id first.
+//
+// Reads and writes never lock. Registration is not synchronized with them, so
+// every quad must be registered before other threads use the table.
 class QuadStateWatchdogStatus {
  public:
   QuadStateWatchdogStatus() {}
   void Register(const std::string& quad_name);
+  // Look up the QuadId assigned to a quad. Returns false if not registered.
+  bool Id(const std::string& quad_name, QuadId& id) const;
+
   InfractionInfo Read(const std::string& quad_name) const;
+  InfractionInfo Read(const QuadId id) const;
   void Write(const std::string& quad_name,
              const MediationLayerCode infraction_occurred);
+  void Write(const QuadId id, const MediationLayerCode infraction_occurred);
   void SetExecution(const std::string& quad_name, const bool execution);
+  void SetExecution(const QuadId id, const bool execution);
   bool ReadExecution(const std::string& quad_name);
+  bool ReadExecution(const QuadId id);
+
+  // Register a callback that is invoked with the QuadId whenever its
+  // infraction code changes. Listeners may be added and removed while other
+  // threads write; see ListenerList.
+  ListenerList::Handle AddListener(const ListenerList::Listener& listener);
+  void RemoveListener(const ListenerList::Handle handle);
 
  private:
-  // Mutex to manage multi-threaded access
-  mutable std::mutex mtx_;
+  // The status of one quad. The trailing padding keeps the data of
+  // neighbouring slots at least a cache line apart, so writes to one quad do
+  // not stall readers of another.
+  struct Slot {
+    // Whether or not an infraction has occurred
+    SeqLock<InfractionInfo> infraction;
+    std::atomic<bool> allow_execution{false};
+    char padding[64];
+  };
+
+  // Map from quad name to QuadId
+  std::unordered_map<std::string, QuadId> ids_;
+
+  // Indexed by QuadId. A deque never moves its elements as it grows.
+  std::deque<Slot> slots_;
 
-  // Map from quad name to whether or not an infraction has occurred
-  std::unordered_map<std::string, InfractionInfo> infraction_map_;
+  ListenerList listeners_;
 
-  std::unordered_map<std::string, bool> allow_execution_;
+  // Returns nullptr and reports the error if the id is not registered
+  Slot* Find(const QuadId id);
+  const Slot* Find(const QuadId id) const;
 };
 }  // namespace game_engine
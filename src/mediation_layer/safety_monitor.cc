@@ -13,7 +13,8 @@ void SafetyMonitor::Run(
     std::shared_ptr<TrajectoryWatchdogStatus> trajectory_watchdog_status) {
   bool finished = false;
 
-  while (this->ok_) {
+  const StopToken stop_token = this->stop_source_.Token();
+  while (false == stop_token.StopRequested()) {
     Trajectory trajectory;
     trajectory_warden_pub->Read(key, trajectory);
 
@@ -29,8 +30,10 @@ void SafetyMonitor::Run(
       // Waypoint mode
       WaypointRevision();
     }
-    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    stop_token.WaitFor(std::chrono::milliseconds(20));
   }
+
+  this->stop_source_.Reset();
 }
 
 void SafetyMonitor::TimeRevision(){};
@@ -39,5 +42,5 @@ void SafetyMonitor::ShapeRevision(){};
 
 void SafetyMonitor::WaypointRevision(){};
 
-void SafetyMonitor::Stop() { this->ok_ = false; }
+void SafetyMonitor::Stop() { this->stop_source_.RequestStop(); }
 }  // namespace game_engine
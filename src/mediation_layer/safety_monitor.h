@@ -13,6 +13,7 @@
 #include "quad_safety_status.h"
 #include "quad_state_watchdog_status.h"
 #include "safety_monitor_status.h"
+#include "stop_token.h"
 #include "trajectory_watchdog_status.h"
 #include "warden.h"
 
@@ -20,7 +21,7 @@ namespace game_engine {
 
 class SafetyMonitor {
  private:
-  volatile std::atomic_bool ok_{true};
+  StopSource stop_source_;
   int revision_mode_;
 
  public:
@@ -40,7 +41,8 @@ class SafetyMonitor {
 
   void WaypointRevision();
 
-  // Stop this thread
+  // Stop this thread. Wakes it immediately if it is sleeping. Once Run()
+  // has returned, it may be called again.
   void Stop();
 };
 }  // namespace game_engine
@@ -1,33 +1,115 @@
 #include "trajectory.h"
 
+#include <atomic>
+#include <utility>
+
 namespace game_engine {
-const size_t Trajectory::Size() const { return this->data_.size(); }
+namespace {
+// Shared by every empty trajectory so that default construction does not
+// allocate
+const std::shared_ptr<const TrajectoryVector3D>& EmptyData() {
+  static const std::shared_ptr<const TrajectoryVector3D> empty =
+      std::make_shared<const TrajectoryVector3D>();
+  return empty;
+}
+}  // namespace
+
+Trajectory::Trajectory() : data_(EmptyData()) {}
+
+Trajectory::Trajectory(const TrajectoryVector3D& data)
+    : data_(data.empty() ? EmptyData()
+                         : std::make_shared<const TrajectoryVector3D>(data)) {}
+
+Trajectory::Trajectory(TrajectoryVector3D&& data)
+    : data_(data.empty() ? EmptyData()
+                         : std::make_shared<const TrajectoryVector3D>(
+                               std::move(data))) {}
+
+Trajectory::Trajectory(std::shared_ptr<const TrajectoryVector3D> data)
+    : data_(nullptr == data ? EmptyData() : std::move(data)) {}
+
+const size_t Trajectory::Size() const { return this->data_->size(); }
+
+const TrajectoryVector3D& Trajectory::Data() const { return *this->data_; }
 
 const Eigen::Vector3d Trajectory::Position(const size_t idx) const {
-  return this->data_[idx].segment(0, 3);
+  return (*this->data_)[idx].segment(0, 3);
 }
 
 const Eigen::Vector3d Trajectory::Velocity(const size_t idx) const {
-  return this->data_[idx].segment(3, 3);
+  return (*this->data_)[idx].segment(3, 3);
 }
 
 const Eigen::Vector3d Trajectory::Acceleration(const size_t idx) const {
-  return this->data_[idx].segment(6, 3);
+  return (*this->data_)[idx].segment(6, 3);
 }
 
 const double Trajectory::Yaw(const size_t idx) const {
-  return this->data_[idx](9);
+  return (*this->data_)[idx](9);
 }
 
 const double Trajectory::Time(const size_t idx) const {
-  return this->data_[idx](10);
+  return (*this->data_)[idx](10);
 }
 
 const Eigen::Matrix<double, 9, 1> Trajectory::PVA(const size_t idx) const {
-  return this->data_[idx].segment(0, 9);
+  return (*this->data_)[idx].segment(0, 9);
 }
 
 const Eigen::Matrix<double, 11, 1> Trajectory::PVAYT(const size_t idx) const {
-  return this->data_[idx];
+  return (*this->data_)[idx];
+}
+
+TrajectoryBuilder::TrajectoryBuilder() {}
+
+TrajectoryBuilder::TrajectoryBuilder(std::shared_ptr<TrajectoryVector3D> buffer)
+    : data_(std::move(buffer)) {
+  if (nullptr != this->data_) {
+    this->data_->clear();
+  }
+}
+
+TrajectoryVector3D& TrajectoryBuilder::Buffer() {
+  if (nullptr == this->data_) {
+    this->data_ = std::make_shared<TrajectoryVector3D>();
+  }
+  return *this->data_;
+}
+
+void TrajectoryBuilder::Reserve(const size_t size) {
+  this->Buffer().reserve(size);
+}
+
+void TrajectoryBuilder::PushBack(const Eigen::Matrix<double, 11, 1>& instant) {
+  this->Buffer().push_back(instant);
+}
+
+size_t TrajectoryBuilder::Size() const {
+  return (nullptr == this->data_) ? 0 : this->data_->size();
+}
+
+Trajectory TrajectoryBuilder::Build() {
+  return Trajectory(
+      std::shared_ptr<const TrajectoryVector3D>(std::move(this->data_)));
+}
+
+TrajectoryBuilder TrajectoryPool::Builder() {
+  // A buffer referenced only by the pool is no longer part of any
+  // Trajectory. Nothing else can acquire a reference to it, so the check is
+  // safe even while other threads hold trajectories from this pool.
+  for (const std::shared_ptr<TrajectoryVector3D>& buffer : this->buffers_) {
+    if (1 == buffer.use_count()) {
+      // Order the reuse after the last reader's accesses
+      std::atomic_thread_fence(std::memory_order_acquire);
+      return TrajectoryBuilder(buffer);
+    }
+  }
+
+  std::shared_ptr<TrajectoryVector3D> buffer =
+      std::make_shared<TrajectoryVector3D>();
+  if (this->buffers_.size() < this->options_.max_buffers) {
+    this->buffers_.push_back(buffer);
+  }
+  return TrajectoryBuilder(buffer);
 }
 }  // namespace game_engine
@@ -2,21 +2,31 @@
 
 #include <Eigen/Dense>
 #include <Eigen/StdVector>
+#include <memory>
+#include <vector>
 
 #include "types.h"
 
 namespace game_engine {
+// Convenient type definitions
+using TrajectoryVector3D =
+    std::vector<Eigen::Matrix<double, 11, 1>,
+                Eigen::aligned_allocator<Eigen::Matrix<double, 11, 1>>>;
+
 // Abstract class representing a continuous trajectory sampled in time. At the
 // most basic view, the class is just a list of Eigen::Vectors. Provides
 // convenient methods for accessing the data.
+//
+// The samples are held in an immutable, reference-counted buffer. Copying a
+// Trajectory shares the buffer rather than the samples, so a trajectory may be
+// passed between threads and wardens without being duplicated. Use a
+// TrajectoryBuilder to construct a new trajectory.
 class Trajectory {
  private:
   // Underlying data structure. Formatted as follows:
   //   [ pos(3), vel(3), acc(3), yaw(1), time(1)]
   // Time is a floating point value measuring the seconds since the unix epoch
-  std::vector<Eigen::Matrix<double, 11, 1>,
-              Eigen::aligned_allocator<Eigen::Matrix<double, 11, 1>>>
-      data_;
+  std::shared_ptr<const TrajectoryVector3D> data_;
 
  public:
   // Required by Eigen
@@ -24,11 +34,12 @@ class Trajectory {
 
   // Constructor. Data must be passed in the following format:
   //   [ pos, vel, acc, yaw, time]
-  Trajectory(
-      const std::vector<Eigen::Matrix<double, 11, 1>,
-                        Eigen::aligned_allocator<Eigen::Matrix<double, 11, 1>>>&
-          data = {})
-      : data_(data) {}
+  Trajectory();
+  Trajectory(const TrajectoryVector3D& data);
+  Trajectory(TrajectoryVector3D&& data);
+
+  // Share an existing buffer. A null buffer is treated as empty.
+  explicit Trajectory(std::shared_ptr<const TrajectoryVector3D> data);
 
   // Data access functions
   const Eigen::Vector3d Position(const size_t idx) const;
@@ -45,10 +56,62 @@ class Trajectory {
 
   // Number of samples in trajectory
   const size_t Size() const;
+
+  // Underlying buffer
+  const TrajectoryVector3D& Data() const;
 };
 
-// Convenient type definitions
-using TrajectoryVector3D =
-    std::vector<Eigen::Matrix<double, 11, 1>,
-                Eigen::aligned_allocator<Eigen::Matrix<double, 11, 1>>>;
+// Accumulates samples into a mutable buffer and seals it into a Trajectory.
+// A builder may be reused after Build(); it starts again from a new, empty
+// buffer.
+class TrajectoryBuilder {
+ private:
+  // Allocated on first use
+  std::shared_ptr<TrajectoryVector3D> data_;
+
+  TrajectoryVector3D& Buffer();
+
+ public:
+  // Required by Eigen
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  TrajectoryBuilder();
+
+  // Build into an existing buffer. The buffer is cleared but keeps its
+  // capacity.
+  explicit TrajectoryBuilder(std::shared_ptr<TrajectoryVector3D> buffer);
+
+  void Reserve(const size_t size);
+  void PushBack(const Eigen::Matrix<double, 11, 1>& instant);
+  size_t Size() const;
+
+  // Seal the buffer into a Trajectory. The builder no longer references it.
+  Trajectory Build();
+};
+
+// Recycles trajectory buffers. A buffer is handed out again once every
+// Trajectory built from it has been destroyed, so a producer that replaces
+// its trajectory at a steady rate stops allocating after a few cycles.
+//
+// A pool is meant to be owned by a single producer, e.g. one per quad, and
+// is not thread-safe. The trajectories it produces may be shared freely.
+class TrajectoryPool {
+ public:
+  struct Options {
+    // Maximum number of buffers retained by the pool. When every retained
+    // buffer is still in use, a fresh buffer that is not retained is used.
+    size_t max_buffers = 8;
+
+    Options() {}
+  };
+
+  TrajectoryPool(const Options& options = Options()) : options_(options) {}
+
+  // Returns a builder backed by a free buffer
+  TrajectoryBuilder Builder();
+
+ private:
+  Options options_;
+  std::vector<std::shared_ptr<TrajectoryVector3D>> buffers_;
+};
 }  // namespace game_engine
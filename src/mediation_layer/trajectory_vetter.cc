@@ -1,168 +1,491 @@
 #include "trajectory_vetter.h"
 
 #include <Eigen/Core>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
 #include <iostream>
+#include <thread>
 
 namespace game_engine {
+namespace {
+// Constraints in the order in which their violations are reported
+enum Constraint {
+  kPosition = 0,
+  kVelocity,
+  kMeanValueVelocity,
+  kAcceleration,
+  kMeanValueAcceleration,
+  kTime,
+  kNumConstraints
+};
+
+// Cheap test of whether a magnitude may exceed a limit, given the squared
+// magnitude. Returns false only if the magnitude is certainly within the
+// limit. The slack covers rounding in the squares, so that an exact check of
+// the candidates gives the same result as comparing every magnitude.
+bool MayExceed(const double squared_magnitude, const double limit) {
+  return squared_magnitude > (1.0 - 1e-9) * limit * limit;
+}
+
+// Checks one constraint on the sample at idx, or on the pair of samples that
+// it starts. Samples at and after end are ignored, as is the segment that
+// ends at the sample at begin. Returns Success if the constraint holds.
+TrajectoryCode Check(const Constraint constraint,
+                     const TrajectoryVetter::Options& options,
+                     const Map3D& inflated_map,
+                     const TrajectoryVector3D& samples, const size_t idx,
+                     const size_t begin, const size_t end) {
+  TrajectoryCode trajectory_code;
+  trajectory_code.index = idx;
+
+  const Eigen::Matrix<double, 11, 1>& sample = samples[idx];
+  const bool has_next = (idx + 1 < end);
+  const double max_velocity = options.max_velocity_magnitude;
+  const double max_acceleration = options.max_acceleration_magnitude;
+
+  switch (constraint) {
+    case kTime: {
+      if (false == has_next) {
+        break;
+      }
+      const double delta_time = samples[idx + 1](10) - sample(10);
+      if (true == (delta_time < 0.0)) {
+        trajectory_code.code = MediationLayerCode::TimestampsNotIncreasing;
+      } else if (options.max_delta_t < delta_time) {
+        trajectory_code.code =
+            MediationLayerCode::TimeBetweenPointsExceedsMaxTime;
+        trajectory_code.value = delta_time;
+      }
+      break;
+    }
+
+    // Mean value theorem for acceleration
+    case kMeanValueAcceleration: {
+      if (false == has_next) {
+        break;
+      }
+      const double delta_time = samples[idx + 1](10) - sample(10);
+      const Eigen::Vector3d delta_velocity =
+          samples[idx + 1].segment<3>(3) - sample.segment<3>(3);
+      if (true == MayExceed(delta_velocity.squaredNorm(),
+                            max_acceleration * delta_time)) {
+        const double mean_value_acceleration =
+            (delta_velocity / delta_time).norm();
+        if (max_acceleration < mean_value_acceleration) {
+          trajectory_code.code =
+              MediationLayerCode::MeanValueExceedsMaxAcceleration;
+          trajectory_code.value = mean_value_acceleration;
+        }
+      }
+      break;
+    }
+
+    case kAcceleration: {
+      const double squared_norm = sample.segment<3>(6).squaredNorm();
+      if (true == MayExceed(squared_norm, max_acceleration) &&
+          max_acceleration < std::sqrt(squared_norm)) {
+        trajectory_code.code = MediationLayerCode::ExceedsMaxAcceleration;
+        trajectory_code.value = std::sqrt(squared_norm);
+      }
+      break;
+    }
+
+    // Mean value theorem for velocity
+    case kMeanValueVelocity: {
+      if (false == has_next) {
+        break;
+      }
+      const double delta_time = samples[idx + 1](10) - sample(10);
+      const Eigen::Vector3d delta_position =
+          samples[idx + 1].head<3>() - sample.head<3>();
+      if (true == MayExceed(delta_position.squaredNorm(),
+                            max_velocity * delta_time)) {
+        const double mean_value_velocity = (delta_position / delta_time).norm();
+        if (max_velocity < mean_value_velocity) {
+          trajectory_code.code = MediationLayerCode::MeanValueExceedsMaxVelocity;
+          trajectory_code.value = mean_value_velocity;
+        }
+      }
+      break;
+    }
+
+    case kVelocity: {
+      const double squared_norm = sample.segment<3>(3).squaredNorm();
+      if (true == MayExceed(squared_norm, max_velocity) &&
+          max_velocity < std::sqrt(squared_norm)) {
+        trajectory_code.code = MediationLayerCode::ExceedsMaxVelocity;
+        trajectory_code.value = std::sqrt(squared_norm);
+      }
+      break;
+    }
+
+    // Map bounds and obstacles
+    case kPosition: {
+      const Eigen::Vector3d point = sample.head<3>();
+      if (!inflated_map.Contains(point)) {
+        trajectory_code.code = MediationLayerCode::PointExceedsMapBounds;
+      } else if (!inflated_map.IsFreeSpace(point)) {
+        trajectory_code.code = MediationLayerCode::PointWithinObstacle;
+      } else if (true == options.check_segments && begin < idx &&
+                 !inflated_map.IsFreeSegment(samples[idx - 1].head<3>(),
+                                             point)) {
+        // Both samples are free, but the quad passes through an obstacle
+        // between them
+        trajectory_code.code = MediationLayerCode::SegmentIntersectsObstacle;
+        trajectory_code.index = idx - 1;
+      }
+      break;
+    }
+
+    default:
+      break;
+  }
+  return trajectory_code;
+}
+
+// Codes in the order in which Vet() gives them priority
+const MediationLayerCode kReportOrder[] = {
+    MediationLayerCode::NotEnoughTrajectoryPoints,
+    MediationLayerCode::StartPointFarFromCurrentPosition,
+    MediationLayerCode::PointExceedsMapBounds,
+    MediationLayerCode::PointWithinObstacle,
+    MediationLayerCode::SegmentIntersectsObstacle,
+    MediationLayerCode::ExceedsMaxVelocity,
+    MediationLayerCode::MeanValueExceedsMaxVelocity,
+    MediationLayerCode::ExceedsMaxAcceleration,
+    MediationLayerCode::MeanValueExceedsMaxAcceleration,
+    MediationLayerCode::TimestampsNotIncreasing,
+    MediationLayerCode::TimeBetweenPointsExceedsMaxTime,
+};
+constexpr size_t kNumReportCodes =
+    sizeof(kReportOrder) / sizeof(kReportOrder[0]);
+
+// Number of leading samples that a violation leaves valid
+size_t ValidSamples(const TrajectoryCode& trajectory_code) {
+  switch (trajectory_code.code) {
+    case MediationLayerCode::NotEnoughTrajectoryPoints:
+    case MediationLayerCode::StartPointFarFromCurrentPosition:
+      return 0;
+    // Violations between the sample at index and the next
+    case MediationLayerCode::SegmentIntersectsObstacle:
+    case MediationLayerCode::MeanValueExceedsMaxVelocity:
+    case MediationLayerCode::MeanValueExceedsMaxAcceleration:
+    case MediationLayerCode::TimestampsNotIncreasing:
+    case MediationLayerCode::TimeBetweenPointsExceedsMaxTime:
+      return trajectory_code.index + 1;
+    default:
+      return trajectory_code.index;
+  }
+}
+}  // namespace
 
 TrajectoryCode TrajectoryVetter::Vet(
     const Trajectory& trajectory, const Map3D& map,
     const std::shared_ptr<QuadStateWarden> quad_state_warden,
     const std::string& quad_name) const {
+  return this->VetFrom(trajectory, 0, map, quad_state_warden, quad_name);
+}
+
+TrajectoryCode TrajectoryVetter::VetIncremental(
+    const Trajectory& trajectory, const Trajectory& accepted,
+    const Map3D& map,
+    const std::shared_ptr<QuadStateWarden> quad_state_warden,
+    const std::string& quad_name) const {
+  // The last shared sample is checked again, since the pairs of samples it
+  // starts are new
+  const size_t prefix = this->CommonPrefix(trajectory, accepted);
+  const size_t begin = (0 < prefix) ? prefix - 1 : 0;
+  return this->VetFrom(trajectory, begin, map, quad_state_warden, quad_name);
+}
+
+size_t TrajectoryVetter::SafePrefix(
+    const Trajectory& trajectory, const Map3D& map,
+    const std::shared_ptr<QuadStateWarden> quad_state_warden,
+    const std::string& quad_name) const {
+  QuadState current_quad_state;
+  quad_state_warden->Read(quad_name, current_quad_state);
+  const Eigen::Vector3d current_position = current_quad_state.Position();
+
+  const std::shared_ptr<const Map3D> inflated_map =
+      map.Inflated(this->options_.min_distance);
+
+  // The reported violation is not necessarily the earliest one, since
+  // violations are reported by priority. Vetting the valid part again
+  // finds any earlier violation of a lower priority constraint. The prefix
+  // shrinks with every pass, and each pass reports a lower priority
+  // constraint, so there are at most kNumConstraints passes.
+  size_t prefix = trajectory.Size();
+  while (2 <= prefix) {
+    const TrajectoryCode trajectory_code = this->Evaluate(
+        trajectory, *inflated_map, current_position, 0, prefix);
+    if (MediationLayerCode::Success == trajectory_code.code) {
+      return prefix;
+    }
+    prefix = ValidSamples(trajectory_code);
+  }
+  return 0;
+}
+
+size_t TrajectoryVetter::CommonPrefix(const Trajectory& lhs,
+                                      const Trajectory& rhs) const {
+  const TrajectoryVector3D& lhs_samples = lhs.Data();
+  const TrajectoryVector3D& rhs_samples = rhs.Data();
+  const size_t size = std::min(lhs_samples.size(), rhs_samples.size());
+
+  size_t idx = 0;
+  while (idx < size &&
+         (lhs_samples[idx] - rhs_samples[idx]).cwiseAbs().maxCoeff() <=
+             this->options_.prefix_tolerance) {
+    ++idx;
+  }
+  return idx;
+}
+
+TrajectoryCode TrajectoryVetter::VetFrom(
+    const Trajectory& trajectory, const size_t begin, const Map3D& map,
+    const std::shared_ptr<QuadStateWarden> quad_state_warden,
+    const std::string& quad_name) const {
+  QuadState current_quad_state;
+  quad_state_warden->Read(quad_name, current_quad_state);
+  const Eigen::Vector3d current_position = current_quad_state.Position();
+
+  const std::shared_ptr<const Map3D> inflated_map =
+      map.Inflated(this->options_.min_distance);
+
+  const TrajectoryCode trajectory_code =
+      this->Evaluate(trajectory, *inflated_map, current_position, begin);
+  if (MediationLayerCode::Success != trajectory_code.code) {
+    this->Report(trajectory, trajectory_code, quad_name, current_position);
+  }
+  return trajectory_code;
+}
+
+VettingReport TrajectoryVetter::VetAll(
+    const Trajectory& trajectory, const Map3D& map,
+    const std::shared_ptr<QuadStateWarden> quad_state_warden,
+    const std::string& quad_name) const {
+  QuadState current_quad_state;
+  quad_state_warden->Read(quad_name, current_quad_state);
+  const Eigen::Vector3d current_position = current_quad_state.Position();
+
+  const std::shared_ptr<const Map3D> inflated_map_ptr =
+      map.Inflated(this->options_.min_distance);
+  const Map3D& inflated_map = *inflated_map_ptr;
+
+  VettingReport report;
+  report.code = this->Evaluate(trajectory, inflated_map, current_position);
+  if (MediationLayerCode::Success == report.code.code) {
+    return report;
+  }
+
+  VettingReport::Violation found[kNumReportCodes];
+  const auto record = [&](const MediationLayerCode code, const size_t index,
+                          const double value) {
+    const size_t slot =
+        std::find(kReportOrder, kReportOrder + kNumReportCodes, code) -
+        kReportOrder;
+    VettingReport::Violation& violation = found[slot];
+    if (0 == violation.count) {
+      violation.code = code;
+      violation.index = index;
+      violation.worst_value = value;
+    }
+    violation.worst_value = std::max(violation.worst_value, value);
+    violation.count++;
+  };
+
+  const size_t trajectory_size = trajectory.Size();
+  if (trajectory_size < 2) {
+    record(MediationLayerCode::NotEnoughTrajectoryPoints, 0, 0.0);
+  } else {
+    const double start_distance =
+        (trajectory.Position(0) - current_position).norm();
+    if (this->options_.max_distance_from_current_position < start_distance) {
+      record(MediationLayerCode::StartPointFarFromCurrentPosition, 0,
+             start_distance);
+    }
+  }
+
+  // The same checks as Evaluate(), without stopping at a violation
+  const TrajectoryVector3D& samples = trajectory.Data();
+  for (size_t idx = 0; idx < samples.size(); ++idx) {
+    for (int constraint = 0; constraint < kNumConstraints; ++constraint) {
+      const TrajectoryCode trajectory_code =
+          Check(static_cast<Constraint>(constraint), this->options_,
+                inflated_map, samples, idx, 0, samples.size());
+      if (MediationLayerCode::Success != trajectory_code.code) {
+        record(trajectory_code.code, trajectory_code.index,
+               trajectory_code.value);
+      }
+    }
+  }
+
+  for (const VettingReport::Violation& violation : found) {
+    if (0 < violation.count) {
+      report.violations.push_back(violation);
+    }
+  }
+  return report;
+}
+
+std::vector<TrajectoryCode> TrajectoryVetter::VetBatch(
+    const std::vector<Trajectory>& trajectories, const Map3D& map,
+    const std::shared_ptr<QuadStateWarden> quad_state_warden,
+    const std::string& quad_name) const {
+  // Every candidate is vetted against the same quad state and inflated map
+  QuadState current_quad_state;
+  quad_state_warden->Read(quad_name, current_quad_state);
+  const Eigen::Vector3d current_position = current_quad_state.Position();
+
+  const std::shared_ptr<const Map3D> inflated_map =
+      map.Inflated(this->options_.min_distance);
+
+  std::vector<TrajectoryCode> trajectory_codes(trajectories.size());
+  std::atomic<size_t> next{0};
+  const auto work = [&]() {
+    for (size_t idx = next++; idx < trajectories.size(); idx = next++) {
+      trajectory_codes[idx] =
+          this->Evaluate(trajectories[idx], *inflated_map, current_position);
+    }
+  };
+
+  // Candidates are handed out one at a time, since their lengths may differ
+  // widely. The calling thread is one of the workers.
+  const size_t num_threads = std::min(
+      std::max<size_t>(this->options_.batch_threads, 1), trajectories.size());
+  std::vector<std::thread> workers;
+  for (size_t idx = 1; idx < num_threads; ++idx) {
+    workers.emplace_back(work);
+  }
+  work();
+  for (std::thread& worker : workers) {
+    worker.join();
+  }
+
+  return trajectory_codes;
+}
+
+TrajectoryCode TrajectoryVetter::Evaluate(
+    const Trajectory& trajectory, const Map3D& inflated_map,
+    const Eigen::Vector3d& current_position, const size_t begin,
+    const size_t end) const {
   // Define return variable
   TrajectoryCode trajectory_code_;
 
-  const size_t trajectory_size = trajectory.Size();
+  const size_t trajectory_size = std::min(trajectory.Size(), end);
   if (trajectory_size < 2) {
-    std::cerr << "Specified trajectory for " << quad_name << " has a size of "
-              << trajectory_size
-              << ". Trajectories must have a size of 2 or greater. Rejecting."
-              << std::endl;
     trajectory_code_.code = MediationLayerCode::NotEnoughTrajectoryPoints;
     return trajectory_code_;
   }
 
   // Initial position constraints
-  QuadState current_quad_state;
-  quad_state_warden->Read(quad_name, current_quad_state);
-
   const Eigen::Vector3d initial_position = trajectory.Position(0);
-  const Eigen::Vector3d current_position = current_quad_state.Position();
   if (this->options_.max_distance_from_current_position <
       (initial_position - current_position).norm()) {
-    std::cerr << "Specified trajectory start point ["
-              << initial_position.transpose()
-              << "] deviates from the current quad position ["
-              << current_position.transpose()
-              << "] by more than the maximum distance of "
-              << this->options_.max_distance_from_current_position << " meters"
-              << std::endl;
     trajectory_code_.code =
         MediationLayerCode::StartPointFarFromCurrentPosition;
     trajectory_code_.value = (initial_position - current_position).norm();
     return trajectory_code_;
   }
 
-  // Position constraints
-  const Map3D inflated_map = map.Inflate(this->options_.min_distance);
-  for (size_t idx = 0; idx < trajectory_size; ++idx) {
-    const Eigen::Vector3d point = trajectory.Position(idx);
-    if (!inflated_map.Contains(point)) {
-      std::cerr << "Specified trajectory point [" << point.transpose()
-                << "] exceeded map bounds" << std::endl;
+  // All constraints are evaluated in one pass over the samples. A constraint
+  // is only evaluated until it or a constraint reported before it has been
+  // violated, and the pass ends once nothing is left to evaluate.
+  const TrajectoryVector3D& samples = trajectory.Data();
 
-      trajectory_code_.code = MediationLayerCode::PointExceedsMapBounds;
-      trajectory_code_.index = idx;
-      return trajectory_code_;
+  TrajectoryCode violations[kNumConstraints];
+  int active = kNumConstraints;
+  for (size_t idx = begin; idx < trajectory_size && 0 < active; ++idx) {
+    for (int constraint = active - 1; 0 <= constraint; --constraint) {
+      const TrajectoryCode trajectory_code =
+          Check(static_cast<Constraint>(constraint), this->options_,
+                inflated_map, samples, idx, begin, trajectory_size);
+      if (MediationLayerCode::Success != trajectory_code.code) {
+        violations[constraint] = trajectory_code;
+        active = constraint;
+      }
     }
-    if (!inflated_map.IsFreeSpace(point)) {
-      std::cerr << "Specified trajectory point [" << point.transpose()
-                << "] is contained within an obstacle" << std::endl;
+  }
 
-      trajectory_code_.code = MediationLayerCode::PointWithinObstacle;
-      trajectory_code_.index = idx;
-      return trajectory_code_;
-    }
+  if (kNumConstraints != active) {
+    return violations[active];
   }
 
-  // Velocity constraints
-  for (size_t idx = 0; idx < trajectory_size; ++idx) {
-    const Eigen::Vector3d vel = trajectory.Velocity(idx);
-    if (this->options_.max_velocity_magnitude < vel.norm()) {
+  trajectory_code_.code = MediationLayerCode::Success;
+  return trajectory_code_;
+}
+
+void TrajectoryVetter::Report(
+    const Trajectory& trajectory, const TrajectoryCode& trajectory_code,
+    const std::string& quad_name,
+    const Eigen::Vector3d& current_position) const {
+  const size_t idx = trajectory_code.index;
+  switch (trajectory_code.code) {
+    case MediationLayerCode::NotEnoughTrajectoryPoints:
+      std::cerr << "Specified trajectory for " << quad_name
+                << " has a size of " << trajectory.Size()
+                << ". Trajectories must have a size of 2 or greater. Rejecting."
+                << std::endl;
+      break;
+    case MediationLayerCode::StartPointFarFromCurrentPosition:
+      std::cerr << "Specified trajectory start point ["
+                << trajectory.Position(0).transpose()
+                << "] deviates from the current quad position ["
+                << current_position.transpose()
+                << "] by more than the maximum distance of "
+                << this->options_.max_distance_from_current_position
+                << " meters" << std::endl;
+      break;
+    case MediationLayerCode::PointExceedsMapBounds:
+      std::cerr << "Specified trajectory point ["
+                << trajectory.Position(idx).transpose()
+                << "] exceeded map bounds" << std::endl;
+      break;
+    case MediationLayerCode::PointWithinObstacle:
+      std::cerr << "Specified trajectory point ["
+                << trajectory.Position(idx).transpose()
+                << "] is contained within an obstacle" << std::endl;
+      break;
+    case MediationLayerCode::SegmentIntersectsObstacle:
+      std::cerr << "Specified trajectory segment ["
+                << trajectory.Position(idx).transpose() << "] to ["
+                << trajectory.Position(idx + 1).transpose()
+                << "] passes through an obstacle" << std::endl;
+      break;
+    case MediationLayerCode::ExceedsMaxVelocity:
       std::cerr << "Specified trajectory velocity"
                 << " exceeds maximum velocity constraint of "
                 << this->options_.max_velocity_magnitude << " m/s" << std::endl;
-      trajectory_code_.code = MediationLayerCode::ExceedsMaxVelocity;
-      trajectory_code_.value = vel.norm();
-      trajectory_code_.index = idx;
-      return trajectory_code_;
-    }
-  }
-
-  // Mean value theorem for velocity constraints
-  for (size_t idx = 0; idx < trajectory_size - 1; ++idx) {
-    const Eigen::Vector3d current_pos = trajectory.Position(idx);
-    const Eigen::Vector3d next_pos = trajectory.Position(idx + 1);
-    const double current_time = trajectory.Time(idx);
-    const double next_time = trajectory.Time(idx + 1);
-    const double mean_value_velocity =
-        ((next_pos - current_pos) / (next_time - current_time)).norm();
-    if (this->options_.max_velocity_magnitude < mean_value_velocity) {
+      break;
+    case MediationLayerCode::MeanValueExceedsMaxVelocity:
       std::cerr << "Specified mean-value trajectory velocity "
                 << " exceeds maximum velocity constraint of "
                 << this->options_.max_velocity_magnitude << " m/s" << std::endl;
-
-      trajectory_code_.code = MediationLayerCode::MeanValueExceedsMaxVelocity;
-      trajectory_code_.value = mean_value_velocity;
-      trajectory_code_.index = idx;
-      return trajectory_code_;
-    }
-  }
-
-  // Acceleration constraints
-  for (size_t idx = 0; idx < trajectory_size; ++idx) {
-    const Eigen::Vector3d acc = trajectory.Acceleration(idx);
-    if (this->options_.max_acceleration_magnitude < acc.norm()) {
+      break;
+    case MediationLayerCode::ExceedsMaxAcceleration:
       std::cerr << "Specified trajectory acceleration "
                 << " exceeds maximum acceleration constraint of "
                 << this->options_.max_acceleration_magnitude << " m/s^2"
                 << std::endl;
-      trajectory_code_.code = MediationLayerCode::ExceedsMaxAcceleration;
-      trajectory_code_.value = acc.norm();
-      trajectory_code_.index = idx;
-      return trajectory_code_;
-    }
-  }
-
-  // Mean value theorem for acceleration constraints
-  for (size_t idx = 0; idx < trajectory_size - 1; ++idx) {
-    const Eigen::Vector3d current_vel = trajectory.Velocity(idx);
-    const Eigen::Vector3d next_vel = trajectory.Velocity(idx + 1);
-    const double current_time = trajectory.Time(idx);
-    const double next_time = trajectory.Time(idx + 1);
-    const double mean_value_acceleration =
-        ((next_vel - current_vel) / (next_time - current_time)).norm();
-    if (this->options_.max_acceleration_magnitude < mean_value_acceleration) {
+      break;
+    case MediationLayerCode::MeanValueExceedsMaxAcceleration:
       std::cerr << "Specified mean-value trajectory acceleration"
                 << " exceeds maximum acceleration constraint of "
                 << this->options_.max_acceleration_magnitude << " m/s"
                 << std::endl;
-      trajectory_code_.code =
-          MediationLayerCode::MeanValueExceedsMaxAcceleration;
-      trajectory_code_.value = mean_value_acceleration;
-      trajectory_code_.index = idx;
-      return trajectory_code_;
-    }
-  }
-
-  // Time constraints
-  for (size_t idx = 0; idx < trajectory_size - 1; ++idx) {
-    const double current_time = trajectory.Time(idx);
-    const double next_time = trajectory.Time(idx + 1);
-    const double delta_time = next_time - current_time;
-
-    if (true == (delta_time < 0.0)) {
+      break;
+    case MediationLayerCode::TimestampsNotIncreasing:
       std::cerr << "Trajectory timestamps must be monotonically increasing"
                 << std::endl;
-
-      trajectory_code_.code = MediationLayerCode::TimestampsNotIncreasing;
-      trajectory_code_.index = idx;
-      return trajectory_code_;
-    }
-
-    if (this->options_.max_delta_t < delta_time) {
+      break;
+    case MediationLayerCode::TimeBetweenPointsExceedsMaxTime:
       std::cerr << "Time between adjacent trajectory samples"
                 << " exceeds maximum time of " << this->options_.max_delta_t
                 << " seconds." << std::endl;
-      trajectory_code_.code =
-          MediationLayerCode::TimeBetweenPointsExceedsMaxTime;
-      trajectory_code_.value = delta_time;
-      trajectory_code_.index = idx;
-      return trajectory_code_;
-    }
+      break;
+    default:
+      break;
   }
-
-  trajectory_code_.code = MediationLayerCode::Success;
-  return trajectory_code_;
 }
 }  // namespace game_engine
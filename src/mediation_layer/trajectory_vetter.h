@@ -1,7 +1,10 @@
 #pragma once
 
+#include <Eigen/Core>
+#include <limits>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "map3d.h"
 #include "trajectory.h"
@@ -9,12 +12,37 @@
 #include "warden.h"
 
 namespace game_engine {
+// A VettingReport lists every requirement that a trajectory violates, rather
+// than only the one that Vet() reports.
+struct VettingReport {
+  struct Violation {
+    MediationLayerCode code = MediationLayerCode::Success;
+
+    // Index of the first violating sample
+    int index = 0;
+
+    // Largest value over all violations, for codes that carry a value
+    double worst_value = 0.0;
+
+    // Number of violating samples
+    size_t count = 0;
+  };
+
+  // The code that Vet() returns for the trajectory
+  TrajectoryCode code;
+
+  // One entry per violated code, in the order in which Vet() gives codes
+  // priority
+  std::vector<Violation> violations;
+};
+
 // The TrajectoryVetter determines if a Trajectory complies with a set of
 // specified requirements. The requirements are:
 //   1) A quad following the trajectory will not exceed the boundaries of the
 //      map
 //   2) A quad following the trajectory will not pass through or touch any
-//      obstacles
+//      obstacles, either at the samples or on the straight segments between
+//      them
 //   3) A quad following the trajectory will not exceed the maximum specified
 //      velocity.
 //   4) A quad following the trajectory will not exceed the maximum
@@ -24,6 +52,10 @@ namespace game_engine {
 //   6) The time between trajectory samples is no more than a specified
 //      maximum delta-time
 //
+// If a trajectory violates several requirements, the first violation found
+// when checking, in order, the start point, the map bounds and obstacles,
+// velocity, acceleration and timestamps is reported.
+//
 class TrajectoryVetter {
  public:
   struct Options {
@@ -43,6 +75,18 @@ class TrajectoryVetter {
     // Minimum l-infinity distance from all obstacles that a quad may fly
     double min_distance;
 
+    // Whether the straight segments between consecutive samples are checked
+    // against obstacles, in addition to the samples themselves
+    bool check_segments = true;
+
+    // Number of threads that VetBatch() vets candidates on, including the
+    // calling thread
+    size_t batch_threads = 4;
+
+    // Largest difference in any component, including the timestamp, for
+    // which a sample is considered unchanged by VetIncremental()
+    double prefix_tolerance = 1e-9;
+
     Options() {}
   };
 
@@ -75,5 +119,65 @@ class TrajectoryVetter {
   TrajectoryCode Vet(const Trajectory& trajectory, const Map3D& map,
                      const std::shared_ptr<QuadStateWarden> quad_state_warden,
                      const std::string& quad_name) const;
+
+  // Vets a trajectory that replaces one that previously passed Vet() or
+  // VetIncremental() against the same map. Samples shared with the accepted
+  // trajectory are not checked again, so replanning that only changes the
+  // end of a trajectory costs time proportional to the change. The start
+  // point is always checked against the current quad state. Returns the same
+  // code as Vet() whenever accepted did pass vetting.
+  TrajectoryCode VetIncremental(
+      const Trajectory& trajectory, const Trajectory& accepted,
+      const Map3D& map,
+      const std::shared_ptr<QuadStateWarden> quad_state_warden,
+      const std::string& quad_name) const;
+
+  // Length of the longest prefix of a trajectory that passes vetting. Zero
+  // if no prefix of two or more samples does.
+  size_t SafePrefix(const Trajectory& trajectory, const Map3D& map,
+                    const std::shared_ptr<QuadStateWarden> quad_state_warden,
+                    const std::string& quad_name) const;
+
+  // Number of leading samples that two trajectories share, to within
+  // Options::prefix_tolerance
+  size_t CommonPrefix(const Trajectory& lhs, const Trajectory& rhs) const;
+
+  // Checks a trajectory against every requirement without stopping at the
+  // first violation, so that all problems can be fixed at once. Nothing is
+  // printed. This is slower than Vet(), since every sample is checked.
+  VettingReport VetAll(const Trajectory& trajectory, const Map3D& map,
+                       const std::shared_ptr<QuadStateWarden> quad_state_warden,
+                       const std::string& quad_name) const;
+
+  // Vets several candidate trajectories for one quad in parallel. All
+  // candidates are checked against the same quad state and the same
+  // inflated map. Returns one code per candidate, in order, each identical to
+  // what Vet() would return. Violations are not printed, since rejected
+  // candidates are expected.
+  std::vector<TrajectoryCode> VetBatch(
+      const std::vector<Trajectory>& trajectories, const Map3D& map,
+      const std::shared_ptr<QuadStateWarden> quad_state_warden,
+      const std::string& quad_name) const;
+
+ private:
+  // Vets a trajectory whose samples before begin are known to be valid
+  TrajectoryCode VetFrom(
+      const Trajectory& trajectory, const size_t begin, const Map3D& map,
+      const std::shared_ptr<QuadStateWarden> quad_state_warden,
+      const std::string& quad_name) const;
+
+  // Checks the samples of a trajectory before end against an already
+  // inflated map without printing. Constraints on the samples before begin,
+  // and on the pairs of samples that end before begin, are assumed to hold.
+  TrajectoryCode Evaluate(
+      const Trajectory& trajectory, const Map3D& inflated_map,
+      const Eigen::Vector3d& current_position, const size_t begin = 0,
+      const size_t end = std::numeric_limits<size_t>::max()) const;
+
+  // Print a description of a violation found by Vet()
+  void Report(const Trajectory& trajectory,
+              const TrajectoryCode& trajectory_code,
+              const std::string& quad_name,
+              const Eigen::Vector3d& current_position) const;
 };
 }  // namespace game_engine
@@ -1,10 +1,45 @@
 #include "trajectory_watchdog.h"
 
 #include <Eigen/Core>
+#include <algorithm>
+#include <chrono>
 #include <iostream>
 
 namespace game_engine {
 
+void TrajectoryWatchdog::Schedule(
+    PeriodicScheduler &scheduler, const std::vector<std::string> &quad_names,
+    const std::shared_ptr<QuadStateWarden> quad_state_warden,
+    const std::shared_ptr<TrajectoryWardenServer> trajectory_warden_srv,
+    const std::shared_ptr<TrajectoryWardenPublisher> trajectory_warden_pub,
+    const std::shared_ptr<TrajectoryWatchdogStatus>
+        trajectory_watchdog_status) {
+  std::shared_ptr<Context> context = std::make_shared<Context>();
+  context->trajectory_warden_pub = trajectory_warden_pub;
+  context->trajectory_watchdog_status = trajectory_watchdog_status;
+
+  // Resolve the QuadIds of every quad once. Quads that are missing from
+  // either table are not watched.
+  for (const std::string &quad_name : quad_names) {
+    QuadId pub_id, status_id;
+    if (MediationLayerCode::Success !=
+            trajectory_warden_pub->Id(quad_name, pub_id) ||
+        false == trajectory_watchdog_status->Id(quad_name, status_id)) {
+      continue;
+    }
+    context->pub_ids.push_back(pub_id);
+    context->status_ids.push_back(status_id);
+  }
+
+  context->versions.assign(context->pub_ids.size(), 0);
+  context->predictor.reset(new TrajectoryCollisionPredictor(
+      this->options_.simulation_forward_time,
+      this->options_.collision_distance, context->pub_ids.size()));
+
+  scheduler.AddTask("trajectory_watchdog", this->options_.period,
+                    [this, context]() { this->Check(*context); });
+}
+
 void TrajectoryWatchdog::Run(
     const std::vector<std::string> &quad_names,
     const std::shared_ptr<QuadStateWarden> quad_state_warden,
@@ -12,64 +47,207 @@ void TrajectoryWatchdog::Run(
     const std::shared_ptr<TrajectoryWardenPublisher> trajectory_warden_pub,
     const std::shared_ptr<TrajectoryWatchdogStatus>
         trajectory_watchdog_status) {
-  while (this->ok_) {
-    for (const std::string &quad_name : quad_names) {
-      // CHECK TRAJECTORIES OF THE QUADS TO SEE IF THEY INTERSECT
-      // Grab trajectory of first quad
-      Trajectory main_trajectory;
-      trajectory_warden_pub->Read(quad_name, main_trajectory);
-      size_t lookahead_index_main;
-      for (size_t idx = 0; idx < main_trajectory.Size(); ++idx) {
-        double time = main_trajectory.Time(idx);
-        if (time <= this->options_.simulation_forward_time) {
-          lookahead_index_main++;
-        } else {
-          break;
-        }
+  PeriodicScheduler::Options scheduler_options;
+  scheduler_options.worker_threads = 1;
+  PeriodicScheduler scheduler(scheduler_options);
+  this->Schedule(scheduler, quad_names, quad_state_warden,
+                 trajectory_warden_srv, trajectory_warden_pub,
+                 trajectory_watchdog_status);
+  scheduler.Run(this->stop_source_.Token());
+
+  this->stop_source_.Reset();
+}
+
+void TrajectoryWatchdog::Check(Context &context) {
+  const std::vector<QuadId> &pub_ids = context.pub_ids;
+
+  // Trajectory times are seconds since the unix epoch
+  const double now = std::chrono::duration_cast<std::chrono::duration<double>>(
+                         std::chrono::system_clock::now().time_since_epoch())
+                         .count();
+
+  for (size_t quad_idx = 0; quad_idx < pub_ids.size(); ++quad_idx) {
+    std::shared_ptr<const Trajectory> trajectory;
+    if (MediationLayerCode::Success ==
+        context.trajectory_warden_pub->SnapshotIfNewer(
+            pub_ids[quad_idx], context.versions[quad_idx], trajectory)) {
+      context.predictor->SetTrajectory(quad_idx, trajectory);
+    }
+  }
+
+  context.predictor->Predict(now, context.collisions);
+  for (size_t quad_idx = 0; quad_idx < pub_ids.size(); ++quad_idx) {
+    // Write() only notifies listeners when the code changes
+    context.trajectory_watchdog_status->Write(context.status_ids[quad_idx],
+                                              context.collisions[quad_idx]);
+  }
+}
+
+void TrajectoryWatchdog::Stop() { this->stop_source_.RequestStop(); }
+
+//===================================
+//     TrajectoryCollisionPredictor
+//===================================
+void TrajectoryCollisionPredictor::SetTrajectory(
+    const size_t quad_idx,
+    const std::shared_ptr<const Trajectory> &trajectory) {
+  this->trajectories_[quad_idx] = trajectory;
+  this->windows_[quad_idx] = Window();
+}
+
+void TrajectoryCollisionPredictor::Predict(
+    const double now, std::vector<TrajectoryCode> &collisions) {
+  const std::vector<std::shared_ptr<const Trajectory>> &trajectories =
+      this->trajectories_;
+  std::vector<Window> &windows = this->windows_;
+
+  for (size_t quad_idx = 0; quad_idx < trajectories.size(); ++quad_idx) {
+    if (nullptr != trajectories[quad_idx]) {
+      this->UpdateWindow(*trajectories[quad_idx], now, windows[quad_idx]);
+    }
+  }
+
+  // CHECK TRAJECTORIES OF THE QUADS TO SEE IF THEY INTERSECT
+  collisions.assign(trajectories.size(), TrajectoryCode());
+  for (size_t quad_idx = 0; quad_idx < trajectories.size(); ++quad_idx) {
+    const Window &main_window = windows[quad_idx];
+    if (nullptr == trajectories[quad_idx] ||
+        main_window.begin == main_window.end) {
+      continue;
+    }
+
+    // Report the earliest collision with any other quad
+    TrajectoryCode &future_collision = collisions[quad_idx];
+    for (size_t other_idx = 0; other_idx < trajectories.size(); ++other_idx) {
+      const Window &secondary_window = windows[other_idx];
+      if (quad_idx == other_idx || nullptr == trajectories[other_idx] ||
+          secondary_window.begin == secondary_window.end) {
+        continue;
+      }
+
+      // Broad phase. Interpolated positions lie within the bounding boxes,
+      // and two points are at least as far apart as along any one axis, so
+      // a gap of the collision distance along an axis rules out a collision.
+      const double separation =
+          (secondary_window.min - main_window.max)
+              .cwiseMax(main_window.min - secondary_window.max)
+              .maxCoeff();
+      if (separation >= this->collision_distance_) {
+        continue;
       }
 
-      // Check if current quad too close to another quad
-      if (quad_names.size() > 1) {
-        for (const std::string &other_quad_name : quad_names) {
-          if (quad_name != other_quad_name) {
-            // Grab trajectory of other quad
-            Trajectory secondary_trajectory;
-            trajectory_warden_pub->Read(other_quad_name, secondary_trajectory);
-            size_t lookahead_index_second;
-            for (size_t idx = 0; idx < secondary_trajectory.Size(); ++idx) {
-              double time = secondary_trajectory.Time(idx);
-              if (time <= this->options_.simulation_forward_time) {
-                lookahead_index_second++;
-              } else {
-                break;
-              }
-            }
-
-            TrajectoryCode future_collision;
-            for (size_t idx = 0; idx < lookahead_index_main; ++idx) {
-              const Eigen::Vector3d main_position =
-                  main_trajectory.Position(idx);
-              for (size_t idx2 = 0; idx2 < lookahead_index_second; ++idx2) {
-                const Eigen::Vector3d secondary_position =
-                    secondary_trajectory.Position(idx2);
-                if ((main_position - secondary_position).norm() <
-                    this->options_.collision_distance) {
-                  future_collision.code =
-                      MediationLayerCode::QuadTrajectoryCollidesWithAnotherQuad;
-                  future_collision.value =
-                      (main_position - secondary_position).norm();
-                  future_collision.index = idx;
-                  trajectory_watchdog_status->Write(quad_name,
-                                                    future_collision);
-                }
-              }
-            }
-          }
-        }
+      TrajectoryCode collision;
+      if (true == this->FindCollision(*trajectories[quad_idx], main_window,
+                                      *trajectories[other_idx],
+                                      secondary_window, collision) &&
+          (MediationLayerCode::Success == future_collision.code ||
+           collision.index < future_collision.index)) {
+        future_collision = collision;
       }
     }
   }
 }
 
-void TrajectoryWatchdog::Stop() { this->ok_ = false; }
-}  // namespace game_engine
\ No newline at end of file
+void TrajectoryCollisionPredictor::UpdateWindow(const Trajectory &trajectory,
+                                                const double now,
+                                                Window &window) const {
+  const size_t size = trajectory.Size();
+  if (0 == size) {
+    window.begin = 0;
+    window.end = 0;
+    return;
+  }
+
+  // The window starts at the sample the quad is currently flying from and
+  // ends with the first sample past the lookahead time, so that every time
+  // in between can be interpolated. A trajectory that has ended holds its
+  // final position.
+  size_t begin = std::min(window.begin, size - 1);
+  while (begin + 1 < size && trajectory.Time(begin + 1) <= now) {
+    ++begin;
+  }
+
+  const double horizon = now + this->simulation_forward_time_;
+  size_t end = begin + 1;
+  while (end < size && trajectory.Time(end - 1) <= horizon) {
+    ++end;
+  }
+
+  window.begin = begin;
+  window.end = end;
+  window.min = trajectory.Position(begin);
+  window.max = window.min;
+  for (size_t idx = begin + 1; idx < end; ++idx) {
+    const Eigen::Vector3d position = trajectory.Position(idx);
+    window.min = window.min.cwiseMin(position);
+    window.max = window.max.cwiseMax(position);
+  }
+}
+
+bool TrajectoryCollisionPredictor::FindCollision(
+    const Trajectory &main_trajectory, const Window &main_window,
+    const Trajectory &secondary_trajectory, const Window &secondary_window,
+    TrajectoryCode &collision) const {
+  size_t secondary_idx = secondary_window.begin;
+  for (size_t idx = main_window.begin; idx < main_window.end; ++idx) {
+    const double time = main_trajectory.Time(idx);
+
+    // The other quad has not started this trajectory yet
+    if (time < secondary_trajectory.Time(secondary_window.begin)) {
+      continue;
+    }
+
+    // Advance to the segment of the other trajectory containing this time.
+    // Past its final sample the other quad holds its final position.
+    while (secondary_idx + 1 < secondary_window.end &&
+           secondary_trajectory.Time(secondary_idx + 1) <= time) {
+      ++secondary_idx;
+    }
+
+    Eigen::Vector3d secondary_position =
+        secondary_trajectory.Position(secondary_idx);
+    if (secondary_idx + 1 < secondary_window.end) {
+      const double t0 = secondary_trajectory.Time(secondary_idx);
+      const double tf = secondary_trajectory.Time(secondary_idx + 1);
+      if (tf > t0) {
+        const double alpha = (time - t0) / (tf - t0);
+        secondary_position +=
+            alpha * (secondary_trajectory.Position(secondary_idx + 1) -
+                     secondary_position);
+      }
+    }
+
+    const double distance =
+        (main_trajectory.Position(idx) - secondary_position).norm();
+    if (distance < this->collision_distance_) {
+      collision.code = MediationLayerCode::QuadTrajectoryCollidesWithAnotherQuad;
+      collision.value = distance;
+      collision.index = static_cast<int>(idx);
+      return true;
+    }
+  }
+
+  // Past its final sample the main quad holds its final position
+  const size_t last = main_window.end - 1;
+  if (main_trajectory.Size() != main_window.end) {
+    return false;
+  }
+  const double final_time = main_trajectory.Time(last);
+  for (size_t idx = secondary_window.begin; idx < secondary_window.end; ++idx) {
+    if (secondary_trajectory.Time(idx) <= final_time) {
+      continue;
+    }
+
+    const double distance =
+        (main_trajectory.Position(last) - secondary_trajectory.Position(idx))
+            .norm();
+    if (distance < this->collision_distance_) {
+      collision.code = MediationLayerCode::QuadTrajectoryCollidesWithAnotherQuad;
+      collision.value = distance;
+      collision.index = static_cast<int>(last);
+      return true;
+    }
+  }
+  return false;
+}
+}  // namespace game_engine
@@ -1,30 +1,110 @@
 #pragma once
 
+#include <Eigen/Core>
+#include <chrono>
 #include <memory>
 #include <string>
+#include <vector>
 
+#include "periodic_scheduler.h"
+#include "quad_id.h"
 #include "trajectory.h"
 #include "trajectory_code.h"
 #include "trajectory_publisher_node.h"
+#include "stop_token.h"
 #include "trajectory_watchdog_status.h"
 #include "warden.h"
 
 namespace game_engine {
+// Predicts collisions between the trajectories of several quads. Each quad's
+// trajectory is compared against every other trajectory within a lookahead
+// time, sample against the other trajectory's position interpolated at the
+// same time. A trajectory that has ended holds its final position. Pairs
+// whose bounding boxes over the lookahead window are at least the collision
+// distance apart along some axis are rejected without comparing samples.
+class TrajectoryCollisionPredictor {
+ public:
+  TrajectoryCollisionPredictor(const double simulation_forward_time,
+                               const double collision_distance,
+                               const size_t num_quads)
+      : simulation_forward_time_(simulation_forward_time),
+        collision_distance_(collision_distance),
+        trajectories_(num_quads),
+        windows_(num_quads) {}
+
+  // Replace the trajectory of a quad. Its lookahead window is searched for
+  // from the first sample again.
+  void SetTrajectory(const size_t quad_idx,
+                     const std::shared_ptr<const Trajectory>& trajectory);
+
+  // Predict the collisions of every quad at time now, in seconds since the
+  // unix epoch. Element idx of collisions is the earliest collision of quad
+  // idx with any other quad, or MediationLayerCode::Success if there is
+  // none. Time only moves forward between calls.
+  void Predict(const double now, std::vector<TrajectoryCode>& collisions);
+
+ private:
+  // The samples [begin, end) of a trajectory that span the lookahead window
+  // and the bounding box of their positions
+  struct Window {
+    size_t begin = 0;
+    size_t end = 0;
+    Eigen::Vector3d min;
+    Eigen::Vector3d max;
+  };
+
+  double simulation_forward_time_;
+  double collision_distance_;
+
+  // Latest trajectory and lookahead window of every quad
+  std::vector<std::shared_ptr<const Trajectory>> trajectories_;
+  std::vector<Window> windows_;
+
+  // Find the lookahead window of a trajectory. Time only moves forward, so
+  // the search starts from the window's previous begin.
+  void UpdateWindow(const Trajectory& trajectory, const double now,
+                    Window& window) const;
+
+  // Compare two windows at matching times. Returns true and fills in the
+  // collision if the first trajectory comes within the collision distance of
+  // the second.
+  bool FindCollision(const Trajectory& main_trajectory,
+                     const Window& main_window,
+                     const Trajectory& secondary_trajectory,
+                     const Window& secondary_window,
+                     TrajectoryCode& collision) const;
+};
+
 // The trajectory watchdog watches the trajectories of the quadcopters and
 // determines if any of them are intersecting within a certain lookahead time.
-// If they will intersect, a violation is reported.
+// If they will intersect, a violation is reported. Collisions are predicted
+// by a TrajectoryCollisionPredictor.
 class TrajectoryWatchdog {
  public:
   struct Options {
     // Lookahead time for simulation
     double simulation_forward_time = 5;  // seconds
     double collision_distance = 0.4;     // meters
+
+    // Period at which the trajectories are checked
+    std::chrono::milliseconds period = std::chrono::milliseconds(20);
+
     Options() {}
   };
 
   TrajectoryWatchdog(const Options& options = Options()) : options_(options) {}
 
-  // Main thread function
+  // Register the watchdog with a scheduler. The scheduler owns the thread;
+  // stopping the scheduler stops the watchdog.
+  void Schedule(
+      PeriodicScheduler& scheduler, const std::vector<std::string>& quad_names,
+      const std::shared_ptr<QuadStateWarden> quad_state_warden,
+      const std::shared_ptr<TrajectoryWardenServer> trajectory_warden_srv,
+      const std::shared_ptr<TrajectoryWardenPublisher> trajectory_warden_pub,
+      const std::shared_ptr<TrajectoryWatchdogStatus>
+          trajectory_watchdog_status);
+
+  // Main thread function. Runs the watchdog on its own scheduler.
   void Run(
       const std::vector<std::string>& quad_names,
       const std::shared_ptr<QuadStateWarden> quad_state_warden,
@@ -33,11 +113,30 @@ class TrajectoryWatchdog {
       const std::shared_ptr<TrajectoryWatchdogStatus>
           trajectory_watchdog_status);
 
-  // Stop this thread
+  // Stop this thread. Wakes it immediately if it is sleeping. Once Run()
+  // has returned, it may be called again.
   void Stop();
 
  private:
-  volatile std::atomic_bool ok_{true};
+  // State carried between checks
+  struct Context {
+    std::shared_ptr<TrajectoryWardenPublisher> trajectory_warden_pub;
+    std::shared_ptr<TrajectoryWatchdogStatus> trajectory_watchdog_status;
+
+    // The QuadIds of every watched quad in each table
+    std::vector<QuadId> pub_ids;
+    std::vector<QuadId> status_ids;
+
+    // Version of the latest trajectory of every quad
+    std::vector<uint64_t> versions;
+
+    std::unique_ptr<TrajectoryCollisionPredictor> predictor;
+    std::vector<TrajectoryCode> collisions;
+  };
+
+  void Check(Context& context);
+
+  StopSource stop_source_;
   Options options_;
 };
 }  // namespace game_engine
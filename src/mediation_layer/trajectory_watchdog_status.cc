@@ -1,35 +1,84 @@
 #include "trajectory_watchdog_status.h"
 
 namespace game_engine {
-TrajectoryCode trajectory_code;
 void TrajectoryWatchdogStatus::Register(const std::string& quad_name) {
-  std::lock_guard<std::mutex> lock(mtx_);
+  TrajectoryCode trajectory_code;
   trajectory_code.code = MediationLayerCode::RegisterQuadWithWatchdog;
-  this->infraction_map_[quad_name] = trajectory_code;
+  const auto it = this->ids_.find(quad_name);
+  if (this->ids_.end() != it) {
+    this->slots_[it->second].infraction.Store(trajectory_code);
+    return;
+  }
+
+  this->ids_[quad_name] = this->slots_.size();
+  this->slots_.emplace_back();
+  this->slots_.back().infraction.Store(trajectory_code);
+}
+
+bool TrajectoryWatchdogStatus::Id(const std::string& quad_name,
+                                  QuadId& id) const {
+  const auto it = this->ids_.find(quad_name);
+  if (this->ids_.end() == it) {
+    std::cerr << "Quad with name " << quad_name
+              << " is not registered with the TrajectoryWatchdog." << std::endl;
+    return false;
+  }
+  id = it->second;
+  return true;
 }
 
 TrajectoryCode TrajectoryWatchdogStatus::Read(
     const std::string& quad_name) const {
-  std::lock_guard<std::mutex> lock(mtx_);
-  try {
-    return this->infraction_map_.at(quad_name);
-  } catch (std::out_of_range e) {
-    std::cerr << "Quad with name " << quad_name
+  QuadId id;
+  if (false == this->Id(quad_name, id)) {
+    TrajectoryCode trajectory_code;
+    trajectory_code.code = MediationLayerCode::QuadNotRegistered;
+    return trajectory_code;
+  }
+  return this->Read(id);
+}
+
+TrajectoryCode TrajectoryWatchdogStatus::Read(const QuadId id) const {
+  if (id >= this->slots_.size()) {
+    std::cerr << "Quad with id " << id
               << " is not registered with the TrajectoryWatchdog." << std::endl;
+    TrajectoryCode trajectory_code;
     trajectory_code.code = MediationLayerCode::QuadNotRegistered;
     return trajectory_code;
   }
+  return this->slots_[id].infraction.Load();
 }
 
 void TrajectoryWatchdogStatus::Write(const std::string& quad_name,
                                      const TrajectoryCode infraction_occurs) {
-  std::lock_guard<std::mutex> lock(mtx_);
-  try {
-    this->infraction_map_.at(quad_name) = infraction_occurs;
-  } catch (std::out_of_range e) {
-    std::cerr << "Quad with name " << quad_name
+  QuadId id;
+  if (true == this->Id(quad_name, id)) {
+    this->Write(id, infraction_occurs);
+  }
+}
+
+void TrajectoryWatchdogStatus::Write(const QuadId id,
+                                     const TrajectoryCode infraction_occurs) {
+  if (id >= this->slots_.size()) {
+    std::cerr << "Quad with id " << id
               << " is not registered with the TrajectoryWatchdog." << std::endl;
     return;
   }
+
+  const TrajectoryCode previous =
+      this->slots_[id].infraction.Exchange(infraction_occurs);
+  if (previous.code != infraction_occurs.code) {
+    this->listeners_.Notify(id);
+  }
+}
+
+ListenerList::Handle TrajectoryWatchdogStatus::AddListener(
+    const ListenerList::Listener& listener) {
+  return this->listeners_.Add(listener);
+}
+
+void TrajectoryWatchdogStatus::RemoveListener(
+    const ListenerList::Handle handle) {
+  this->listeners_.Remove(handle);
 }
 }  // namespace game_engine
@@ -1,31 +1,62 @@
 #pragma once
 
 #include <atomic>
+#include <deque>
+#include <functional>
 #include <iostream>
-#include <mutex>
 #include <stdexcept>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
+#include "listener_list.h"
+#include "quad_id.h"
+#include "seqlock.h"
 #include "trajectory_code.h"
 
 namespace game_engine {
 // Struct that contains information about the status of the TrajectoryWatchdog.
 // If the TrajectoryWatchdog determines that a quadcopter has flown too close to
 // an obstacle, an instance of this status is updated to reflect that.
+//
+// Quads are assigned dense QuadIds in registration order. The QuadId overloads
+// index per-quad slots; the name overloads resolve the id first.
+//
+// Reads and writes never lock. Registration is not synchronized with them, so
+// every quad must be registered before other threads use the table.
 class TrajectoryWatchdogStatus {
  private:
-  // Mutex to manage multi-threaded access
-  mutable std::mutex mtx_;
+  // Whether or not an infraction has occurred for one quad, padded so that
+  // neighbouring quads do not share a cache line
+  struct Slot {
+    SeqLock<TrajectoryCode> infraction;
+    char padding[64];
+  };
 
-  // Map from quad name to whether or not an infraction has occurred
-  std::unordered_map<std::string, TrajectoryCode> infraction_map_;
+  // Map from quad name to QuadId
+  std::unordered_map<std::string, QuadId> ids_;
+
+  // Indexed by QuadId. A deque never moves its elements as it grows.
+  std::deque<Slot> slots_;
+
+  ListenerList listeners_;
 
  public:
   TrajectoryWatchdogStatus() {}
   void Register(const std::string& quad_name);
+  // Look up the QuadId assigned to a quad. Returns false if not registered.
+  bool Id(const std::string& quad_name, QuadId& id) const;
+
   TrajectoryCode Read(const std::string& quad_name) const;
+  TrajectoryCode Read(const QuadId id) const;
   void Write(const std::string& quad_name,
              const TrajectoryCode infraction_occurs);
+  void Write(const QuadId id, const TrajectoryCode infraction_occurs);
+
+  // Register a callback that is invoked with the QuadId whenever its
+  // infraction code changes. Listeners may be added and removed while other
+  // threads write; see ListenerList.
+  ListenerList::Handle AddListener(const ListenerList::Listener& listener);
+  void RemoveListener(const ListenerList::Handle handle);
 };
 }  // namespace game_engine
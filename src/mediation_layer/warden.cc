@@ -2,23 +2,56 @@
 
 namespace game_engine {
 //============================
-//     TrajectoryWardenIn
+//     TrajectoryWardenServer
 //============================
+MediationLayerCode TrajectoryWardenServer::Register(const std::string& key) {
+  const MediationLayerCode code = Warden<Trajectory>::Register(key);
+  if (MediationLayerCode::Success == code) {
+    this->handoffs_.push_back(std::make_shared<StatusHandoff>());
+  }
+  return code;
+};
+
 TrajectoryCode TrajectoryWardenServer::GetLastTrajectoryStatus(
-    const std::string& key) {
-  // Checks to see if the status hasn't been updated yet.
-  // Wait until the statusUpdated_ marker returns true and return the status.
-  while (this->statusUpdated_[key] == false) {
-    continue;
+    StatusHandoff& handoff, std::unique_lock<std::mutex>& lock,
+    const uint64_t version) {
+  // Sleep until the mediation layer has issued a verdict for this version,
+  // the warden is stopped, or the timeout elapses. Entries of the map are
+  // not invalidated by other insertions.
+  Verdict& verdict = handoff.pending_[version];
+  const bool answered =
+      handoff.cv_.wait_for(lock, this->options_.status_timeout, [&] {
+        return (true == verdict.issued_) || (false == this->ok_);
+      });
+
+  TrajectoryCode tc;
+  if (false == this->ok_) {
+    tc.code = MediationLayerCode::ThreadStopped;
+  } else if (false == answered) {
+    tc.code = MediationLayerCode::TrajectoryStatusTimeout;
+  } else {
+    tc = verdict.status_;
   }
-  this->statusUpdated_[key] = false;
-  return trajectoryStatus_[key];
+
+  // A verdict that arrives after this is dropped
+  handoff.pending_.erase(version);
+  return tc;
 };
 
 TrajectoryCode TrajectoryWardenServer::Write(const std::string& key,
                                              const Trajectory& trajectory) {
+  return this->WriteContainer(this->Find(key), trajectory);
+};
+
+TrajectoryCode TrajectoryWardenServer::Write(const QuadId id,
+                                             const Trajectory& trajectory) {
+  return this->WriteContainer(this->Find(id), trajectory);
+};
+
+TrajectoryCode TrajectoryWardenServer::WriteContainer(
+    Container* container, const Trajectory& trajectory) {
   // If key does not exist, return false
-  if (this->map_.end() == this->map_.find(key)) {
+  if (nullptr == container) {
     std::cerr << "TrajectoryWardenServer::Write -- Key does not exist."
               << std::endl;
     TrajectoryCode tc;
@@ -26,66 +59,65 @@ TrajectoryCode TrajectoryWardenServer::Write(const std::string& key,
     return tc;
   }
 
-  std::shared_ptr<Warden<Trajectory>::Container>& container = this->map_[key];
+  // Publish while holding the handoff mutex, so that the submission is
+  // pending under its version before the verdict can be issued
+  StatusHandoff& handoff = *this->handoffs_[container->id_];
+  std::unique_lock<std::mutex> lock(handoff.mtx_);
+  const uint64_t version = this->Publish(*container, trajectory);
 
-  {  // Lock mutex for modification
-    std::lock_guard<std::mutex> lock(container->modified_mtx_);
-    container->type_ = trajectory;
-    container->modified_ = true;
-    container->modified_cv_.notify_all();
-  }
-  // The GetLastTrajectoryStatus grabs the most recent status updated by the ML.
-  TrajectoryCode status = GetLastTrajectoryStatus(key);
-  return status;
+  // The GetLastTrajectoryStatus awaits the status issued by the ML for this
+  // version
+  return GetLastTrajectoryStatus(handoff, lock, version);
 };
 
 void TrajectoryWardenServer::SetTrajectoryStatus(
-    const std::string& key, TrajectoryCode trajectory_status) {
-  // Set the two variables to true if the status was updated and the value of
-  // the status
-  this->trajectoryStatus_[key] = trajectory_status;
-  this->statusUpdated_[key] = true;
+    const std::string& key, const uint64_t version,
+    TrajectoryCode trajectory_status) {
+  this->SetContainerStatus(this->Find(key), version, trajectory_status);
 };
 
-//==============================
-//     TrajectoryWardenClient
-//==============================
+void TrajectoryWardenServer::SetTrajectoryStatus(
+    const QuadId id, const uint64_t version,
+    TrajectoryCode trajectory_status) {
+  this->SetContainerStatus(this->Find(id), version, trajectory_status);
+};
 
-TrajectoryCode TrajectoryWardenClient::Write(
-    const std::string& key, const Trajectory& trajectory,
-    std::unordered_map<std::string, std::shared_ptr<TrajectoryClientNode>>
-        client) {
-  // If key does not exist, return false
-  if (this->map_.end() == this->map_.find(key)) {
-    std::cerr << "TrajectoryWardenClient::Write -- Key does not exist."
+void TrajectoryWardenServer::SetContainerStatus(
+    Container* container, const uint64_t version,
+    TrajectoryCode trajectory_status) {
+  if (nullptr == container) {
+    std::cerr << "TrajectoryWardenServer::SetTrajectoryStatus -- Key does not "
+                 "exist."
               << std::endl;
-    TrajectoryCode tc;
-    tc.code = MediationLayerCode::KeyDoesNotExist;
-    return tc;
+    return;
   }
 
-  std::shared_ptr<Warden<Trajectory>::Container>& container = this->map_[key];
-
-  {  // Lock mutex for modification
-    std::lock_guard<std::mutex> lock(container->modified_mtx_);
-    container->type_ = trajectory;
-    container->modified_ = true;
-    container->modified_cv_.notify_all();
+  // Answer the submission of this version, and every older one still
+  // waiting as superseded. Newer submissions are left waiting.
+  StatusHandoff& handoff = *this->handoffs_[container->id_];
+  std::lock_guard<std::mutex> lock(handoff.mtx_);
+  for (auto it = handoff.pending_.begin();
+       handoff.pending_.end() != it && it->first <= version; ++it) {
+    if (true == it->second.issued_) {
+      continue;
+    }
+    it->second.issued_ = true;
+    if (version == it->first) {
+      it->second.status_ = trajectory_status;
+    } else {
+      it->second.status_.code = MediationLayerCode::TrajectorySuperseded;
+    }
   }
-
-  // The TrajectoryWardenOut gets sends out a call from the client to the server
-  // and gets the status back
-  TrajectoryCode status = client[key]->Request(trajectory);
-  // Update the status so the In warden is released from it's block.
-  SetTrajectoryStatus(key, status);
-
-  return status;
+  handoff.cv_.notify_all();
 };
 
-void TrajectoryWardenClient::SetTrajectoryStatus(
-    const std::string& key, TrajectoryCode trajectory_status) {
-  this->trajectoryStatus_[key] = trajectory_status;
-  this->statusUpdated_[key] = true;
+void TrajectoryWardenServer::Stop() {
+  Warden<Trajectory>::Stop();
+
+  for (const auto& handoff : this->handoffs_) {
+    std::lock_guard<std::mutex> lock(handoff->mtx_);
+    handoff->cv_.notify_all();
+  }
 };
 
 //====================================
@@ -93,50 +125,24 @@ void TrajectoryWardenClient::SetTrajectoryStatus(
 //====================================
 MediationLayerCode TrajectoryWardenSubscriber::Write(
     const std::string& key, const Trajectory& trajectory) {
-  // If key does not exist, return false
-  if (this->map_.end() == this->map_.find(key)) {
-    std::cerr << "TrajectoryWardenSubscriber::Write -- Key does not exist."
-              << std::endl;
-    return MediationLayerCode::KeyDoesNotExist;
-  }
-
-  std::shared_ptr<Warden<Trajectory>::Container>& container = this->map_[key];
-
-  {  // Lock mutex for modification
-    std::lock_guard<std::mutex> lock(container->modified_mtx_);
-    container->type_ = trajectory;
-    container->modified_ = true;
-    container->modified_cv_.notify_all();
-  }
-
-  return MediationLayerCode::Success;
+  return this->WriteContainer(this->Find(key), trajectory);
 };
 
-//=====================================
-//     TrajectoryWardenPublisher
-//=====================================
+MediationLayerCode TrajectoryWardenSubscriber::Write(
+    const QuadId id, const Trajectory& trajectory) {
+  return this->WriteContainer(this->Find(id), trajectory);
+};
 
-MediationLayerCode TrajectoryWardenPublisher::Write(
-    const std::string& key, const Trajectory& trajectory,
-    std::shared_ptr<TrajectoryPublisherNode> publisher) {
+MediationLayerCode TrajectoryWardenSubscriber::WriteContainer(
+    Container* container, const Trajectory& trajectory) {
   // If key does not exist, return false
-  if (this->map_.end() == this->map_.find(key)) {
-    std::cerr << "TrajectoryWardenPublisher::Write -- Key does not exist."
+  if (nullptr == container) {
+    std::cerr << "TrajectoryWardenSubscriber::Write -- Key does not exist."
               << std::endl;
     return MediationLayerCode::KeyDoesNotExist;
   }
 
-  std::shared_ptr<Warden<Trajectory>::Container>& container = this->map_[key];
-
-  {  // Lock mutex for modification
-    std::lock_guard<std::mutex> lock(container->modified_mtx_);
-    container->type_ = trajectory;
-    container->modified_ = true;
-    container->modified_cv_.notify_all();
-  }
-
-  // publish trajectory
-  publisher->Publish(trajectory);
+  this->Publish(*container, trajectory);
 
   return MediationLayerCode::Success;
 };
@@ -147,19 +153,22 @@ MediationLayerCode TrajectoryWardenPublisher::Write(
 
 MediationLayerCode QuadStateWarden::Write(const std::string& key,
                                           const QuadState& state) {
+  return this->WriteContainer(this->Find(key), state);
+};
+
+MediationLayerCode QuadStateWarden::Write(const QuadId id,
+                                          const QuadState& state) {
+  return this->WriteContainer(this->Find(id), state);
+};
+
+MediationLayerCode QuadStateWarden::WriteContainer(Container* container,
+                                                   const QuadState& state) {
   // If key does not exist, return false
-  if (this->map_.end() == this->map_.find(key)) {
+  if (nullptr == container) {
     std::cerr << "QuadStateWarden::Write -- Key does not exist." << std::endl;
     return MediationLayerCode::KeyDoesNotExist;
   }
-  std::shared_ptr<Warden<QuadState>::Container>& container = this->map_[key];
-
-  {  // Lock mutex for modification
-    std::lock_guard<std::mutex> lock(container->modified_mtx_);
-    container->type_ = state;
-    container->modified_ = true;
-    container->modified_cv_.notify_all();
-  }
+  this->Publish(*container, state);
 
   return MediationLayerCode::Success;
 };
@@ -1,84 +1,164 @@
 #pragma once
 
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <cstdint>
+#include <functional>
 #include <iostream>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <set>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
+#include "listener_list.h"
+#include "quad_id.h"
 #include "quad_state.h"
 #include "trajectory.h"
-#include "trajectory_client.h"
 #include "trajectory_code.h"
-#include "trajectory_publisher_node.h"
 
 namespace game_engine {
+// The ROS nodes are only passed through by pointer, so this header and
+// warden.cc do not depend on ROS. The wardens that use them are defined in
+// warden_ros.cc.
+class TrajectoryClientNode;
+class TrajectoryPublisherNode;
+
 // Warden encapsulates state data and provides thread-safe read, write,
 // and await-modification access.
+//
+// Every registered key is assigned a dense integer QuadId in registration
+// order. Hot paths should resolve the id once with Id() and use the QuadId
+// overloads, which index a flat vector instead of hashing the key.
 template <class T>
 class Warden {
  protected:
   // Wraps a type T with local mutexes and condition variables that
-  // ensure thread-safe access
+  // ensure thread-safe access. The latest value is held as an immutable
+  // snapshot that writers replace with std::atomic_store, so readers never
+  // take the mutex --- it only guards the modified flag for Await.
+  //
+  // Every write increments version_. The initial value is version 1, so a
+  // reader that starts from version 0 always receives it.
   struct Container {
+    const QuadId id_;
     std::mutex modified_mtx_;
-    bool modified_{false};
+    std::atomic<bool> modified_{false};
+    std::atomic<uint64_t> version_{1};
     std::condition_variable modified_cv_;
-    T type_;
+    std::shared_ptr<const T> type_;
 
-    Container(const T& type) : type_(type) {}
+    Container(const QuadId id, const T& type)
+        : id_(id), type_(std::make_shared<const T>(type)) {}
   };
 
-  std::unordered_map<std::string, std::shared_ptr<Warden::Container>> map_;
+  std::vector<std::shared_ptr<Warden::Container>> containers_;
+  std::unordered_map<std::string, QuadId> ids_;
   std::set<std::string> keys_;
+  ListenerList listeners_;
   volatile std::atomic<bool> ok_{true};
 
- public:
-  // Constructor
-  Warden(){};
+  // Returns the container associated with a key or id, or nullptr if it
+  // has not been registered. Keys are only added during setup, so the
+  // lookup itself does not need to be guarded.
+  Container* Find(const std::string& key) const {
+    const auto it = this->ids_.find(key);
+    return (this->ids_.end() == it) ? nullptr
+                                    : this->containers_[it->second].get();
+  }
 
-  // Add a key-value pair to the map
-  MediationLayerCode Register(const std::string& key) {
-    // If this key already exists, return false
-    if (this->map_.end() != this->map_.find(key)) {
-      std::cerr << "Warden::Register -- Key already exists." << std::endl;
-      return MediationLayerCode::KeyAlreadyExists;
+  Container* Find(const QuadId id) const {
+    return (id < this->containers_.size()) ? this->containers_[id].get()
+                                           : nullptr;
+  }
+
+  // Replaces the snapshot held by a container and wakes any threads
+  // awaiting a modification. The copy into the new snapshot is made before
+  // the mutex is taken. Returns the version of the new snapshot.
+  uint64_t Publish(Container& container, const T& type) {
+    std::shared_ptr<const T> snapshot = std::make_shared<const T>(type);
+
+    uint64_t version;
+    {
+      std::lock_guard<std::mutex> lock(container.modified_mtx_);
+      std::atomic_store(&container.type_, snapshot);
+      version = ++container.version_;
+      container.modified_ = true;
+      container.modified_cv_.notify_all();
     }
 
-    this->map_[key] = std::make_shared<Warden::Container>(T());
-    keys_.insert(key);
-    return MediationLayerCode::Success;
-  };
+    this->listeners_.Notify(container.id_);
+    return version;
+  }
 
-  // Copy the latest type T associated with a key
-  MediationLayerCode Read(const std::string& key, T& type) {
+  MediationLayerCode ReadContainer(Container* container, T& type) {
     // If key does not exist, return false
-    if (this->map_.end() == this->map_.find(key)) {
+    if (nullptr == container) {
       std::cerr << "Warden::Read -- Key does not exist." << std::endl;
       return MediationLayerCode::KeyDoesNotExist;
     }
-    std::shared_ptr<Container>& container = this->map_[key];
 
-    {  // Lock mutex for copy
-      std::lock_guard<std::mutex> lock(container->modified_mtx_);
-      type = container->type_;
+    type = *std::atomic_load(&container->type_);
+    return MediationLayerCode::Success;
+  }
+
+  MediationLayerCode SnapshotContainer(Container* container,
+                                       std::shared_ptr<const T>& snapshot) {
+    // If key does not exist, return false
+    if (nullptr == container) {
+      std::cerr << "Warden::Snapshot -- Key does not exist." << std::endl;
+      return MediationLayerCode::KeyDoesNotExist;
     }
 
+    snapshot = std::atomic_load(&container->type_);
     return MediationLayerCode::Success;
-  };
+  }
 
-  // Await a change to the state associated with the key
-  MediationLayerCode Await(const std::string& key, T& type) {
-    if (this->map_.end() == this->map_.find(key)) {
+  // The version is loaded before the snapshot, so the snapshot returned is
+  // never older than the version reported with it. A write that lands in
+  // between is simply seen again on the next call.
+  MediationLayerCode SnapshotContainerIfNewer(
+      Container* container, uint64_t& version,
+      std::shared_ptr<const T>& snapshot) {
+    if (nullptr == container) {
+      std::cerr << "Warden::SnapshotIfNewer -- Key does not exist."
+                << std::endl;
+      return MediationLayerCode::KeyDoesNotExist;
+    }
+
+    const uint64_t current = container->version_;
+    if (current == version) {
+      return MediationLayerCode::NotModified;
+    }
+
+    snapshot = std::atomic_load(&container->type_);
+    version = current;
+    return MediationLayerCode::Success;
+  }
+
+  MediationLayerCode ReadContainerIfNewer(Container* container,
+                                          uint64_t& version, T& type) {
+    std::shared_ptr<const T> snapshot;
+    const MediationLayerCode code =
+        this->SnapshotContainerIfNewer(container, version, snapshot);
+    if (MediationLayerCode::Success == code) {
+      type = *snapshot;
+    }
+    return code;
+  }
+
+  MediationLayerCode AwaitContainer(Container* container, T& type,
+                                    uint64_t& version) {
+    if (nullptr == container) {
       std::cerr << "Warden::Await -- Key does not exist." << std::endl;
       return MediationLayerCode::KeyDoesNotExist;
     }
-    std::shared_ptr<Container>& container = this->map_[key];
 
-    {  // Lock mutex, wait cv, copy, set cv, release mutex
+    std::shared_ptr<const T> snapshot;
+    {  // Lock mutex, wait cv, grab snapshot, set cv, release mutex
       std::unique_lock<std::mutex> lock(container->modified_mtx_);
 
       container->modified_cv_.wait(lock, [&] {
@@ -90,12 +170,123 @@ class Warden {
         return MediationLayerCode::ThreadStopped;
       }
 
-      type = container->type_;
+      // Writers replace the snapshot and its version under the mutex, so the
+      // two are consistent
+      snapshot = std::atomic_load(&container->type_);
+      version = container->version_;
       container->modified_ = false;
-      lock.unlock();
     }
 
+    type = *snapshot;
     return MediationLayerCode::Success;
+  }
+
+ public:
+  // Constructor
+  Warden(){};
+
+  // Add a key-value pair to the map. The key is assigned the next QuadId.
+  MediationLayerCode Register(const std::string& key) {
+    // If this key already exists, return false
+    if (this->ids_.end() != this->ids_.find(key)) {
+      std::cerr << "Warden::Register -- Key already exists." << std::endl;
+      return MediationLayerCode::KeyAlreadyExists;
+    }
+
+    const QuadId id = this->containers_.size();
+    this->containers_.push_back(std::make_shared<Warden::Container>(id, T()));
+    this->ids_[key] = id;
+    keys_.insert(key);
+    return MediationLayerCode::Success;
+  };
+
+  // Look up the QuadId assigned to a key
+  MediationLayerCode Id(const std::string& key, QuadId& id) const {
+    const auto it = this->ids_.find(key);
+    if (this->ids_.end() == it) {
+      std::cerr << "Warden::Id -- Key does not exist." << std::endl;
+      return MediationLayerCode::KeyDoesNotExist;
+    }
+
+    id = it->second;
+    return MediationLayerCode::Success;
+  };
+
+  // Copy the latest type T associated with a key
+  MediationLayerCode Read(const std::string& key, T& type) {
+    return this->ReadContainer(this->Find(key), type);
+  };
+
+  MediationLayerCode Read(const QuadId id, T& type) {
+    return this->ReadContainer(this->Find(id), type);
+  };
+
+  // Share the latest type T associated with a key without copying it. The
+  // snapshot is immutable and remains valid after subsequent writes.
+  MediationLayerCode Snapshot(const std::string& key,
+                              std::shared_ptr<const T>& snapshot) {
+    return this->SnapshotContainer(this->Find(key), snapshot);
+  };
+
+  MediationLayerCode Snapshot(const QuadId id,
+                              std::shared_ptr<const T>& snapshot) {
+    return this->SnapshotContainer(this->Find(id), snapshot);
+  };
+
+  // Copy the latest type T only if it has been written since version. On
+  // success, version is updated to the version that was read. Returns
+  // MediationLayerCode::NotModified without copying if nothing has changed.
+  // Start from version 0 to always read.
+  MediationLayerCode ReadIfNewer(const std::string& key, uint64_t& version,
+                                 T& type) {
+    return this->ReadContainerIfNewer(this->Find(key), version, type);
+  };
+
+  MediationLayerCode ReadIfNewer(const QuadId id, uint64_t& version, T& type) {
+    return this->ReadContainerIfNewer(this->Find(id), version, type);
+  };
+
+  // Share the latest snapshot only if it has been written since version
+  MediationLayerCode SnapshotIfNewer(const std::string& key, uint64_t& version,
+                                     std::shared_ptr<const T>& snapshot) {
+    return this->SnapshotContainerIfNewer(this->Find(key), version, snapshot);
+  };
+
+  MediationLayerCode SnapshotIfNewer(const QuadId id, uint64_t& version,
+                                     std::shared_ptr<const T>& snapshot) {
+    return this->SnapshotContainerIfNewer(this->Find(id), version, snapshot);
+  };
+
+  // Await a change to the state associated with the key
+  MediationLayerCode Await(const std::string& key, T& type) {
+    uint64_t version;
+    return this->AwaitContainer(this->Find(key), type, version);
+  };
+
+  MediationLayerCode Await(const QuadId id, T& type) {
+    uint64_t version;
+    return this->AwaitContainer(this->Find(id), type, version);
+  };
+
+  // Await a change, also reporting the version of the state that was read
+  MediationLayerCode Await(const std::string& key, T& type,
+                           uint64_t& version) {
+    return this->AwaitContainer(this->Find(key), type, version);
+  };
+
+  MediationLayerCode Await(const QuadId id, T& type, uint64_t& version) {
+    return this->AwaitContainer(this->Find(id), type, version);
+  };
+
+  // Register a callback that is invoked with the QuadId after every write.
+  // Listeners may be added and removed while other threads write; see
+  // ListenerList.
+  ListenerList::Handle AddListener(const ListenerList::Listener& listener) {
+    return this->listeners_.Add(listener);
+  };
+
+  void RemoveListener(const ListenerList::Handle handle) {
+    this->listeners_.Remove(handle);
   };
 
   // Getter
@@ -103,8 +294,13 @@ class Warden {
 
   // Check if the container is modified
   bool ModifiedStatus(const std::string& key) {
-    std::shared_ptr<Container>& container = this->map_[key];
-    return container->modified_;
+    Container* container = this->Find(key);
+    return (nullptr != container) && container->modified_;
+  };
+
+  bool ModifiedStatus(const QuadId id) {
+    Container* container = this->Find(id);
+    return (nullptr != container) && container->modified_;
   };
 
   // Break all condition variable wait statements
@@ -112,9 +308,9 @@ class Warden {
     this->ok_ = false;
 
     // Notify all CV to check conditions
-    for (const auto& kv : this->map_) {
-      std::lock_guard<std::mutex> lock(kv.second->modified_mtx_);
-      kv.second->modified_cv_.notify_all();
+    for (const auto& container : this->containers_) {
+      std::lock_guard<std::mutex> lock(container->modified_mtx_);
+      container->modified_cv_.notify_all();
     }
   };
 };
@@ -123,21 +319,64 @@ class Warden {
 //     INHERITED CLASSES
 //============================
 class TrajectoryWardenServer : public Warden<Trajectory> {
+ public:
+  struct Options {
+    // Maximum time a submission waits for the mediation layer to vet it
+    // before giving up with MediationLayerCode::TrajectoryStatusTimeout
+    std::chrono::milliseconds status_timeout = std::chrono::milliseconds(5000);
+
+    Options() {}
+  };
+
  private:
-  std::unordered_map<std::string, volatile std::atomic<bool>> statusUpdated_;
-  std::unordered_map<std::string, TrajectoryCode> trajectoryStatus_;
-  TrajectoryCode GetLastTrajectoryStatus(const std::string& key);
+  // Verdict for one submission
+  struct Verdict {
+    bool issued_ = false;
+    TrajectoryCode status_;
+  };
 
- public:
-  TrajectoryWardenServer() {
-    //          const std::set<std::string> state_keys = Keys();
-    for (const std::string& key : Keys()) {
-      statusUpdated_[key] = false;
-    }
+  // Hands the mediation layer's verdict back to the thread that submitted
+  // the trajectory. A submission is identified by the version its
+  // trajectory was published as, which is the version the mediation layer
+  // reads with Await(), so each writer only wakes for a verdict on its own
+  // trajectory.
+  struct StatusHandoff {
+    std::mutex mtx_;
+    std::condition_variable cv_;
+    // Submissions still awaiting a verdict, keyed by version
+    std::map<uint64_t, Verdict> pending_;
   };
+
+  Options options_;
+  // Indexed by QuadId
+  std::vector<std::shared_ptr<StatusHandoff>> handoffs_;
+  TrajectoryCode GetLastTrajectoryStatus(StatusHandoff& handoff,
+                                         std::unique_lock<std::mutex>& lock,
+                                         const uint64_t version);
+  TrajectoryCode WriteContainer(Container* container,
+                                const Trajectory& trajectory);
+  void SetContainerStatus(Container* container, const uint64_t version,
+                          TrajectoryCode status);
+
+ public:
+  TrajectoryWardenServer(const Options& options = Options())
+      : options_(options){};
+  MediationLayerCode Register(const std::string& key);
   TrajectoryCode Write(const std::string& key, const Trajectory& trajectory);
+  TrajectoryCode Write(const QuadId id, const Trajectory& trajectory);
 
-  void SetTrajectoryStatus(const std::string& key, TrajectoryCode status);
+  // Answers the submission whose trajectory was read as version by Await().
+  // Older submissions still waiting were never vetted, since a newer
+  // trajectory replaced theirs before it was read, and are answered with
+  // MediationLayerCode::TrajectorySuperseded.
+  void SetTrajectoryStatus(const std::string& key, const uint64_t version,
+                           TrajectoryCode status);
+  void SetTrajectoryStatus(const QuadId id, const uint64_t version,
+                           TrajectoryCode status);
+
+  // Break all condition variable wait statements, including writers
+  // awaiting a verdict
+  void Stop();
 };
 
 class TrajectoryWardenClient : public Warden<Trajectory> {
@@ -160,22 +399,39 @@ class TrajectoryWardenClient : public Warden<Trajectory> {
 };
 
 class TrajectoryWardenSubscriber : public Warden<Trajectory> {
+ private:
+  MediationLayerCode WriteContainer(Container* container,
+                                    const Trajectory& trajectory);
+
  public:
   TrajectoryWardenSubscriber(){};
   MediationLayerCode Write(const std::string& key,
                            const Trajectory& trajectory);
+  MediationLayerCode Write(const QuadId id, const Trajectory& trajectory);
 };
 
 class TrajectoryWardenPublisher : public Warden<Trajectory> {
+ private:
+  MediationLayerCode WriteContainer(
+      Container* container, const Trajectory& trajectory,
+      std::shared_ptr<TrajectoryPublisherNode> publisher);
+
  public:
   TrajectoryWardenPublisher(){};
   MediationLayerCode Write(const std::string& key, const Trajectory& trajectory,
                            std::shared_ptr<TrajectoryPublisherNode> publisher);
+  MediationLayerCode Write(const QuadId id, const Trajectory& trajectory,
+                           std::shared_ptr<TrajectoryPublisherNode> publisher);
 };
 
 class QuadStateWarden : public Warden<QuadState> {
+ private:
+  MediationLayerCode WriteContainer(Container* container,
+                                    const QuadState& state);
+
  public:
   QuadStateWarden(){};
   MediationLayerCode Write(const std::string& key, const QuadState& state);
+  MediationLayerCode Write(const QuadId id, const QuadState& state);
 };
 }  // namespace game_engine
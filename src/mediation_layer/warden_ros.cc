@@ -0,0 +1,75 @@
+#include "warden.h"
+
+#include "trajectory_client.h"
+#include "trajectory_publisher_node.h"
+
+namespace game_engine {
+//==============================
+//     TrajectoryWardenClient
+//==============================
+
+TrajectoryCode TrajectoryWardenClient::Write(
+    const std::string& key, const Trajectory& trajectory,
+    std::unordered_map<std::string, std::shared_ptr<TrajectoryClientNode>>
+        client) {
+  // If key does not exist, return false
+  Container* container = this->Find(key);
+  if (nullptr == container) {
+    std::cerr << "TrajectoryWardenClient::Write -- Key does not exist."
+              << std::endl;
+    TrajectoryCode tc;
+    tc.code = MediationLayerCode::KeyDoesNotExist;
+    return tc;
+  }
+
+  this->Publish(*container, trajectory);
+
+  // The TrajectoryWardenOut gets sends out a call from the client to the server
+  // and gets the status back
+  TrajectoryCode status = client[key]->Request(trajectory);
+  // Update the status so the In warden is released from it's block.
+  SetTrajectoryStatus(key, status);
+
+  return status;
+};
+
+void TrajectoryWardenClient::SetTrajectoryStatus(
+    const std::string& key, TrajectoryCode trajectory_status) {
+  this->trajectoryStatus_[key] = trajectory_status;
+  this->statusUpdated_[key] = true;
+};
+
+//=====================================
+//     TrajectoryWardenPublisher
+//=====================================
+
+MediationLayerCode TrajectoryWardenPublisher::Write(
+    const std::string& key, const Trajectory& trajectory,
+    std::shared_ptr<TrajectoryPublisherNode> publisher) {
+  return this->WriteContainer(this->Find(key), trajectory, publisher);
+};
+
+MediationLayerCode TrajectoryWardenPublisher::Write(
+    const QuadId id, const Trajectory& trajectory,
+    std::shared_ptr<TrajectoryPublisherNode> publisher) {
+  return this->WriteContainer(this->Find(id), trajectory, publisher);
+};
+
+MediationLayerCode TrajectoryWardenPublisher::WriteContainer(
+    Container* container, const Trajectory& trajectory,
+    std::shared_ptr<TrajectoryPublisherNode> publisher) {
+  // If key does not exist, return false
+  if (nullptr == container) {
+    std::cerr << "TrajectoryWardenPublisher::Write -- Key does not exist."
+              << std::endl;
+    return MediationLayerCode::KeyDoesNotExist;
+  }
+
+  this->Publish(*container, trajectory);
+
+  // publish trajectory
+  publisher->Publish(trajectory);
+
+  return MediationLayerCode::Success;
+};
+}  // namespace game_engine
@@ -15,9 +15,9 @@ bool TrajectoryServerNode::ServiceCallback(mg_msgs::PVAYT::Request& req,
                                            mg_msgs::PVAYT::Response& res) {
   // Required data structure. Formatted as follows:
   //   [ pos(3), vel(3), acc(3), yaw(1), time(1)]
-  std::vector<Eigen::Matrix<double, 11, 1>,
-              Eigen::aligned_allocator<Eigen::Matrix<double, 11, 1>>>
-      data;
+  // The buffer is recycled from a previous trajectory when possible
+  TrajectoryBuilder builder = this->pool_.Builder();
+  builder.Reserve(req.trajectory.size());
 
   for (const mg_msgs::PVAYStamped& instant : req.trajectory) {
     Eigen::Matrix<double, 11, 1> local_instant;
@@ -33,11 +33,11 @@ bool TrajectoryServerNode::ServiceCallback(mg_msgs::PVAYT::Request& req,
     local_instant(9) = instant.yaw;
     local_instant(10) =
         instant.header.stamp.sec + (double)instant.header.stamp.nsec / 1e9;
-    data.push_back(local_instant);
+    builder.PushBack(local_instant);
   }
 
   TrajectoryCode trajectory_status =
-      warden_->Write(this->key_, Trajectory(data));
+      warden_->Write(this->key_, builder.Build());
   res.code = static_cast<unsigned int>(trajectory_status.code);
   res.value = trajectory_status.value;
   res.index = trajectory_status.index;
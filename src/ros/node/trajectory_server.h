@@ -26,6 +26,9 @@ class TrajectoryServerNode {
   // Key to be passed on to the trajectory warden
   std::string key_;
 
+  // Recycles the buffers of trajectories that are no longer in use
+  TrajectoryPool pool_;
+
   // Service callback. Extracts ROS data and converts it into a
   // Trajectory instance to be passed on to the trajectory warden
   bool ServiceCallback(mg_msgs::PVAYT::Request& req,
@@ -17,9 +17,9 @@ void TrajectorySubscriberNode::SubscriberCallback(
     const mg_msgs::PVAYStampedTrajectory& msg) {
   // Required data structure. Formatted as follows:
   //   [ pos(3), vel(3), acc(3), yaw(1), time(1)]
-  std::vector<Eigen::Matrix<double, 11, 1>,
-              Eigen::aligned_allocator<Eigen::Matrix<double, 11, 1>>>
-      data;
+  // The buffer is recycled from a previous trajectory when possible
+  TrajectoryBuilder builder = this->pool_.Builder();
+  builder.Reserve(msg.trajectory.size());
   for (const mg_msgs::PVAYStamped& instant : msg.trajectory) {
     Eigen::Matrix<double, 11, 1> local_instant;
     local_instant(0) = instant.pos.x;
@@ -34,9 +34,9 @@ void TrajectorySubscriberNode::SubscriberCallback(
     local_instant(9) = instant.yaw;
     local_instant(10) =
         instant.header.stamp.sec + (double)instant.header.stamp.nsec / 1e9;
-    data.push_back(local_instant);
+    builder.PushBack(local_instant);
   }
 
-  this->warden_->Write(this->key_, Trajectory(data));
+  this->warden_->Write(this->key_, builder.Build());
 }
 }  // namespace game_engine
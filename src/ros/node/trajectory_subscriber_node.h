@@ -30,6 +30,9 @@ class TrajectorySubscriberNode {
   // Key to be passed on to the trajectory warden
   std::string key_;
 
+  // Recycles the buffers of trajectories that are no longer in use
+  TrajectoryPool pool_;
+
   // Subscriber callback. Extracts ROS data and converts it into a
   // Trajectory instance to be passed on to the trajectory warden
   void SubscriberCallback(const mg_msgs::PVAYStampedTrajectory& msg);
@@ -21,7 +21,7 @@ std::vector<visualization_msgs::Marker> PolyhedronView::Markers() const {
   // Iterate through all of the faces on the polyhedron and draw triangles
   // between the vertices and some point on the interior of the face. The
   // interior point is arbitrarily selected as the first vertex.
-  for (const Plane3D& face : this->polyhedron_.Faces()) {
+  for (const Polyhedron::Face& face : this->polyhedron_.Faces()) {
     const Point3D interior_point = face.Edges()[0].Start();
     for (const Line3D& edge : face.Edges()) {
       geometry_msgs::Point p1;
@@ -6,31 +6,23 @@ void ViewManager::Run(const QuadViewOptions quad_view_options,
                       const GoalViewOptions goal_view_options,
                       const EnvironmentViewOptions environment_view_options,
                       const TrajectoryViewOptions trajectory_view_options) {
-  std::thread quad_publisher_thread(
-      [&]() { RunQuadPublisher(quad_view_options); });
-
-  std::thread balloon_publisher_thread(
-      [&]() { RunBalloonPublisher(balloon_view_options); });
-
-  std::thread goal_publisher_thread(
-      [&]() { RunGoalPublisher(goal_view_options); });
-
-  std::thread environment_publisher_thread(
-      [&]() { RunEnvironmentPublisher(environment_view_options); });
-
-  std::thread trajectory_publisher_thread(
-      [&]() { RunTrajectoryPublisher(trajectory_view_options); });
-
-  quad_publisher_thread.join();
-  balloon_publisher_thread.join();
-  goal_publisher_thread.join();
-  environment_publisher_thread.join();
-  trajectory_publisher_thread.join();
+  // The publishers share a small pool of threads rather than owning one
+  // each
+  PeriodicScheduler scheduler;
+  this->ScheduleQuadPublisher(scheduler, quad_view_options);
+  this->ScheduleBalloonPublisher(scheduler, balloon_view_options);
+  this->ScheduleGoalPublisher(scheduler, goal_view_options);
+  this->ScheduleEnvironmentPublisher(scheduler, environment_view_options);
+  this->ScheduleTrajectoryPublisher(scheduler, trajectory_view_options);
+  scheduler.Run(this->stop_source_.Token());
+
+  this->stop_source_.Reset();
 }
 
-void ViewManager::RunQuadPublisher(const QuadViewOptions quad_view_options) {
+void ViewManager::ScheduleQuadPublisher(
+    PeriodicScheduler& scheduler, const QuadViewOptions& quad_view_options) {
   // Setup
-  std::vector<QuadView> quad_views;
+  auto quad_views = std::make_shared<std::vector<QuadView>>();
 
   for (const auto p : quad_view_options.quads) {
     if (p.first.first == "red") {
@@ -40,7 +32,7 @@ void ViewManager::RunQuadPublisher(const QuadViewOptions quad_view_options) {
       view_options.r = 0.75f;
       view_options.g = 0.34;
       view_options.b = 0.0f;
-      quad_views.emplace_back(p.first.second, p.second, view_options);
+      quad_views->emplace_back(p.first.second, p.second, view_options);
     } else if (p.first.first == "blue") {
       QuadView::Options view_options;
       view_options.mesh_resource = quad_view_options.quad_mesh_file_path;
@@ -48,28 +40,29 @@ void ViewManager::RunQuadPublisher(const QuadViewOptions quad_view_options) {
       view_options.r = 0.2f;
       view_options.g = 0.247f;
       view_options.b = 0.28f;
-      quad_views.emplace_back(p.first.second, p.second, view_options);
+      quad_views->emplace_back(p.first.second, p.second, view_options);
     }
   }
 
   auto quads_publisher = std::make_shared<MarkerPublisherNode>("quads");
 
-  // Main loop
   // 50 Hz. The quads move quickly and update often
-  while (this->ok_) {
-    for (const auto& view : quad_views) {
-      for (const visualization_msgs::Marker& marker : view.Markers()) {
-        quads_publisher->Publish(marker);
-      }
-    }
-    std::this_thread::sleep_for(std::chrono::milliseconds(20));
-  }
+  scheduler.AddTask(
+      "quad_publisher", std::chrono::milliseconds(20),
+      [quad_views, quads_publisher]() {
+        for (const auto& view : *quad_views) {
+          for (const visualization_msgs::Marker& marker : view.Markers()) {
+            quads_publisher->Publish(marker);
+          }
+        }
+      });
 }
 
-void ViewManager::RunBalloonPublisher(
-    const BalloonViewOptions balloon_view_options) {
+void ViewManager::ScheduleBalloonPublisher(
+    PeriodicScheduler& scheduler,
+    const BalloonViewOptions& balloon_view_options) {
   // Setup
-  std::vector<BalloonView> balloon_views;
+  auto balloon_views = std::make_shared<std::vector<BalloonView>>();
 
   for (auto p : balloon_view_options.balloons) {
     if (p.first == "red") {
@@ -78,14 +71,14 @@ void ViewManager::RunBalloonPublisher(
       view_options.r = 1.0f;
       view_options.g = 0.0f;
       view_options.b = 0.0f;
-      balloon_views.emplace_back(p.second, view_options);
+      balloon_views->emplace_back(p.second, view_options);
     } else if (p.first == "blue") {
       BalloonView::Options view_options;
       view_options.mesh_resource = balloon_view_options.balloon_mesh_file_path;
       view_options.r = 0.0f;
       view_options.g = 0.0f;
       view_options.b = 1.0f;
-      balloon_views.emplace_back(p.second, view_options);
+      balloon_views->emplace_back(p.second, view_options);
     }
   }
 
@@ -135,58 +128,62 @@ void ViewManager::RunBalloonPublisher(
       std::make_shared<BalloonPositionSubscriberNode>(
           balloon_position_topics["blue"], blue_balloon_position);
 
-  // Main loop
   // 50 Hz.
-  while (this->ok_) {
-    for (auto& view : balloon_views) {
-      // check for balloon motion
-      // if balloon view position is not approx equal to balloon status
-      // position, set balloon view position to balloon status position
-      if (view.options_.r == 1.0f) {  // red balloon
-        if (!view.balloon_position_.isApprox(
-                *(red_balloon_position_subscriber_node->balloon_position_))) {
-          view.balloon_position_ =
-              *(red_balloon_position_subscriber_node->balloon_position_);
-        }
-      } else if (view.options_.b == 1.0f) {  // blue balloon{
-        if (!view.balloon_position_.isApprox(
-                *(blue_balloon_position_subscriber_node->balloon_position_))) {
-          view.balloon_position_ =
-              *(blue_balloon_position_subscriber_node->balloon_position_);
-        }
-      }
-
-      for (visualization_msgs::Marker& marker : view.Markers()) {
-        if (marker.color.r == 1.0f) {
-          if (red_balloon_status_subscriber_node->balloon_status_->popped) {
-            // "pop" red balloon
-            marker.action = visualization_msgs::Marker::DELETE;
-            balloons_publisher->Publish(marker);
-          } else {
-            marker.action = visualization_msgs::Marker::ADD;
-            balloons_publisher->Publish(marker);
+  scheduler.AddTask(
+      "balloon_publisher", std::chrono::milliseconds(20),
+      [balloon_views, balloons_publisher, red_balloon_status_subscriber_node,
+       blue_balloon_status_subscriber_node,
+       red_balloon_position_subscriber_node,
+       blue_balloon_position_subscriber_node]() {
+        for (auto& view : *balloon_views) {
+          // check for balloon motion
+          // if balloon view position is not approx equal to balloon status
+          // position, set balloon view position to balloon status position
+          if (view.options_.r == 1.0f) {  // red balloon
+            if (!view.balloon_position_.isApprox(
+                    *(red_balloon_position_subscriber_node->balloon_position_))) {
+              view.balloon_position_ =
+                  *(red_balloon_position_subscriber_node->balloon_position_);
+            }
+          } else if (view.options_.b == 1.0f) {  // blue balloon{
+            if (!view.balloon_position_.isApprox(
+                    *(blue_balloon_position_subscriber_node->balloon_position_))) {
+              view.balloon_position_ =
+                  *(blue_balloon_position_subscriber_node->balloon_position_);
+            }
           }
-        } else if (marker.color.b == 1.0f) {
-          if (blue_balloon_status_subscriber_node->balloon_status_->popped) {
-            // "pop" blue balloon
-            marker.action = visualization_msgs::Marker::DELETE;
-            balloons_publisher->Publish(marker);
-          } else {
-            marker.action = visualization_msgs::Marker::ADD;
-            balloons_publisher->Publish(marker);
+
+          for (visualization_msgs::Marker& marker : view.Markers()) {
+            if (marker.color.r == 1.0f) {
+              if (red_balloon_status_subscriber_node->balloon_status_->popped) {
+                // "pop" red balloon
+                marker.action = visualization_msgs::Marker::DELETE;
+                balloons_publisher->Publish(marker);
+              } else {
+                marker.action = visualization_msgs::Marker::ADD;
+                balloons_publisher->Publish(marker);
+              }
+            } else if (marker.color.b == 1.0f) {
+              if (blue_balloon_status_subscriber_node->balloon_status_->popped) {
+                // "pop" blue balloon
+                marker.action = visualization_msgs::Marker::DELETE;
+                balloons_publisher->Publish(marker);
+              } else {
+                marker.action = visualization_msgs::Marker::ADD;
+                balloons_publisher->Publish(marker);
+              }
+            } else {
+              balloons_publisher->Publish(marker);
+            }
           }
-        } else {
-          balloons_publisher->Publish(marker);
         }
-      }
-    }
-    std::this_thread::sleep_for(std::chrono::milliseconds(20));
-  }
+      });
 }
 
-void ViewManager::RunGoalPublisher(const GoalViewOptions goal_view_options) {
+void ViewManager::ScheduleGoalPublisher(
+    PeriodicScheduler& scheduler, const GoalViewOptions& goal_view_options) {
   // Setup
-  std::vector<GoalView> goal_views;
+  auto goal_views = std::make_shared<std::vector<GoalView>>();
 
   for (auto p : goal_view_options.goals) {
     if (p.first == "home") {
@@ -195,7 +192,7 @@ void ViewManager::RunGoalPublisher(const GoalViewOptions goal_view_options) {
       view_options.r = 1.0f;
       view_options.g = 0.0f;
       view_options.b = 1.0f;
-      goal_views.emplace_back(p.second, view_options);
+      goal_views->emplace_back(p.second, view_options);
     }
   }
 
@@ -214,79 +211,83 @@ void ViewManager::RunGoalPublisher(const GoalViewOptions goal_view_options) {
   auto goal_status_subscriber_node = std::make_shared<GoalStatusSubscriberNode>(
       goal_status_topics["home"], goal_status);
 
-  // Main loop
   // 50 Hz.
-  while (this->ok_) {
-    for (auto& view : goal_views) {
-      for (visualization_msgs::Marker& marker : view.Markers()) {
-        bool active = goal_status_subscriber_node->goal_status_->active;
-        bool reached = goal_status_subscriber_node->goal_status_->reached;
-        if (active) {
-          marker.color.a = 1.0;
-          marker.action = visualization_msgs::Marker::ADD;
-          goal_publisher->Publish(marker);
-        } else if (reached && !active) {
-          marker.color.a = 0.3;
-          // marker.action = visualization_msgs::Marker::ADD;
-          marker.action = visualization_msgs::Marker::DELETE;
-          goal_publisher->Publish(marker);
-        } else {
-          marker.action = visualization_msgs::Marker::DELETE;
-          goal_publisher->Publish(marker);
+  scheduler.AddTask(
+      "goal_publisher", std::chrono::milliseconds(20),
+      [goal_views, goal_publisher, goal_status_subscriber_node]() {
+        for (auto& view : *goal_views) {
+          for (visualization_msgs::Marker& marker : view.Markers()) {
+            bool active = goal_status_subscriber_node->goal_status_->active;
+            bool reached = goal_status_subscriber_node->goal_status_->reached;
+            if (active) {
+              marker.color.a = 1.0;
+              marker.action = visualization_msgs::Marker::ADD;
+              goal_publisher->Publish(marker);
+            } else if (reached && !active) {
+              marker.color.a = 0.3;
+              // marker.action = visualization_msgs::Marker::ADD;
+              marker.action = visualization_msgs::Marker::DELETE;
+              goal_publisher->Publish(marker);
+            } else {
+              marker.action = visualization_msgs::Marker::DELETE;
+              goal_publisher->Publish(marker);
+            }
+          }
         }
-      }
-    }
-    std::this_thread::sleep_for(std::chrono::milliseconds(20));
-  }
+      });
 }
 
-void ViewManager::RunEnvironmentPublisher(
-    const EnvironmentViewOptions environment_view_options) {
+void ViewManager::ScheduleEnvironmentPublisher(
+    PeriodicScheduler& scheduler,
+    const EnvironmentViewOptions& environment_view_options) {
   // Setup
-  std::vector<Plane3DView> plane_views;
+  auto plane_views = std::make_shared<std::vector<Plane3DView>>();
   for (const Plane3D& wall : environment_view_options.map.Walls()) {
-    plane_views.emplace_back(wall, environment_view_options.wall_view_options);
+    plane_views->emplace_back(wall, environment_view_options.wall_view_options);
   }
-  plane_views.emplace_back(environment_view_options.map.Ground(),
+  plane_views->emplace_back(environment_view_options.map.Ground(),
                            environment_view_options.ground_view_options);
 
-  std::vector<PolyhedronView> obstacle_views;
+  auto obstacle_views = std::make_shared<std::vector<PolyhedronView>>();
   for (const Polyhedron& obstacle : environment_view_options.map.Obstacles()) {
-    obstacle_views.emplace_back(obstacle,
+    obstacle_views->emplace_back(obstacle,
                                 environment_view_options.obstacle_view_options);
   }
 
   auto environment_publisher =
       std::make_shared<MarkerPublisherNode>("environment");
 
-  // Main loop
   // 2 Hz. Environment does not change often
-  while (this->ok_) {
-    for (const Plane3DView& view : plane_views) {
-      for (const visualization_msgs::Marker& marker : view.Markers()) {
-        environment_publisher->Publish(marker);
-      }
-    }
+  scheduler.AddTask(
+      "environment_publisher", std::chrono::milliseconds(500),
+      [plane_views, obstacle_views, environment_publisher]() {
+        for (const Plane3DView& view : *plane_views) {
+          for (const visualization_msgs::Marker& marker : view.Markers()) {
+            environment_publisher->Publish(marker);
+          }
+        }
 
-    for (const PolyhedronView& obstacle_view : obstacle_views) {
-      for (const visualization_msgs::Marker& marker : obstacle_view.Markers()) {
-        environment_publisher->Publish(marker);
-      }
-    }
-    std::this_thread::sleep_for(std::chrono::milliseconds(500));
-  }
+        for (const PolyhedronView& obstacle_view : *obstacle_views) {
+          for (const visualization_msgs::Marker& marker :
+               obstacle_view.Markers()) {
+            environment_publisher->Publish(marker);
+          }
+        }
+      });
 }
 
-void ViewManager::RunTrajectoryPublisher(
-    const TrajectoryViewOptions trajectory_view_options) {
-  // Main loop @ 5 Hz to keep up with quickly-updating trajectories
-  while (this->ok_) {
-    for (const auto& tr : trajectory_view_options.trajectories) {
-      tr.second->Publish();
-    }
-    std::this_thread::sleep_for(std::chrono::milliseconds(200));
-  }
+void ViewManager::ScheduleTrajectoryPublisher(
+    PeriodicScheduler& scheduler,
+    const TrajectoryViewOptions& trajectory_view_options) {
+  // 5 Hz to keep up with quickly-updating trajectories
+  scheduler.AddTask("trajectory_publisher", std::chrono::milliseconds(200),
+                    [trajectory_view_options]() {
+                      for (const auto& tr :
+                           trajectory_view_options.trajectories) {
+                        tr.second->Publish();
+                      }
+                    });
 }
 
-void ViewManager::Stop() { this->ok_ = false; }
+void ViewManager::Stop() { this->stop_source_.RequestStop(); }
 }  // namespace game_engine
@@ -4,7 +4,6 @@
 
 #include <atomic>
 #include <memory>
-#include <thread>
 #include <vector>
 
 #include "balloon_position_subscriber_node.h"
@@ -16,9 +15,11 @@
 #include "goal_view.h"
 #include "map3d.h"
 #include "marker_publisher_node.h"
+#include "periodic_scheduler.h"
 #include "plane3d_view.h"
 #include "polyhedron_view.h"
 #include "quad_view.h"
+#include "stop_token.h"
 #include "trajectory_visualizer_node.h"
 #include "warden.h"
 
@@ -81,14 +82,20 @@ class ViewManager {
   void Stop();
 
  private:
-  void RunQuadPublisher(const QuadViewOptions quad_view_options);
-  void RunBalloonPublisher(const BalloonViewOptions balloon_view_options);
-  void RunGoalPublisher(const GoalViewOptions goal_view_options);
-  void RunEnvironmentPublisher(
-      const EnvironmentViewOptions environment_view_options);
-  void RunTrajectoryPublisher(
-      const TrajectoryViewOptions trajectory_view_options);
-
-  volatile std::atomic<bool> ok_{true};
+  void ScheduleQuadPublisher(PeriodicScheduler& scheduler,
+                             const QuadViewOptions& quad_view_options);
+  void ScheduleBalloonPublisher(
+      PeriodicScheduler& scheduler,
+      const BalloonViewOptions& balloon_view_options);
+  void ScheduleGoalPublisher(PeriodicScheduler& scheduler,
+                             const GoalViewOptions& goal_view_options);
+  void ScheduleEnvironmentPublisher(
+      PeriodicScheduler& scheduler,
+      const EnvironmentViewOptions& environment_view_options);
+  void ScheduleTrajectoryPublisher(
+      PeriodicScheduler& scheduler,
+      const TrajectoryViewOptions& trajectory_view_options);
+
+  StopSource stop_source_;
 };
 }  // namespace game_engine
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <set>
+
+namespace game_engine {
+// KeyedEventQueue lets a small pool of worker threads wait on events for
+// many keys at once. Producers mark a key as ready, either immediately with
+// Notify() or at a deadline with NotifyAt(). Workers Acquire() ready keys and
+// Release() them when done.
+//
+// A key is never handed to two workers at the same time. Notifications for a
+// key that is being processed are coalesced and the key is re-queued when it
+// is released, so no event is lost and each key is processed serially.
+template <class Key>
+class KeyedEventQueue {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  KeyedEventQueue() {}
+
+  // Mark a key as ready to be processed
+  void Notify(const Key& key) {
+    std::lock_guard<std::mutex> lock(this->mtx_);
+    this->MarkReady(key);
+  }
+
+  // Mark a key as ready to be processed once the deadline has passed
+  void NotifyAt(const Key& key, const Clock::time_point deadline) {
+    std::lock_guard<std::mutex> lock(this->mtx_);
+    const bool earliest =
+        this->timers_.empty() || deadline < this->timers_.begin()->first;
+    this->timers_.emplace(deadline, key);
+
+    // Waiting workers must recompute how long to sleep
+    if (earliest) {
+      this->cv_.notify_all();
+    }
+  }
+
+  // Block until a key is ready and hand it to the caller. Returns false once
+  // the queue has been stopped.
+  bool Acquire(Key& key) {
+    std::unique_lock<std::mutex> lock(this->mtx_);
+    while (true == this->ok_) {
+      this->ExpireTimers(Clock::now());
+
+      if (false == this->ready_.empty()) {
+        key = this->ready_.front();
+        this->ready_.pop_front();
+        this->queued_.erase(key);
+        this->busy_.insert(key);
+        return true;
+      }
+
+      if (true == this->timers_.empty()) {
+        this->cv_.wait(lock);
+      } else {
+        this->cv_.wait_until(lock, this->timers_.begin()->first);
+      }
+    }
+    return false;
+  }
+
+  // Return a key acquired with Acquire(). If the key was notified while it
+  // was being processed, it is immediately queued again.
+  void Release(const Key& key) {
+    std::lock_guard<std::mutex> lock(this->mtx_);
+    this->busy_.erase(key);
+    if (0 < this->dirty_.erase(key)) {
+      this->MarkReady(key);
+    }
+  }
+
+  // Wake all workers and make Acquire() return false
+  void Stop() {
+    std::lock_guard<std::mutex> lock(this->mtx_);
+    this->ok_ = false;
+    this->cv_.notify_all();
+  }
+
+  // Discard all pending events and accept new workers again. Must only be
+  // called once every worker has returned from Acquire().
+  void Reset() {
+    std::lock_guard<std::mutex> lock(this->mtx_);
+    this->ok_ = true;
+    this->ready_.clear();
+    this->queued_.clear();
+    this->busy_.clear();
+    this->dirty_.clear();
+    this->timers_.clear();
+  }
+
+ private:
+  std::mutex mtx_;
+  std::condition_variable cv_;
+  bool ok_{true};
+
+  // Keys waiting for a worker, in notification order
+  std::deque<Key> ready_;
+  std::set<Key> queued_;
+
+  // Keys held by a worker, and the subset notified since being acquired
+  std::set<Key> busy_;
+  std::set<Key> dirty_;
+
+  // Pending deadlines
+  std::multimap<Clock::time_point, Key> timers_;
+
+  // Requires mtx_ to be held
+  void MarkReady(const Key& key) {
+    if (0 < this->busy_.count(key)) {
+      this->dirty_.insert(key);
+    } else if (true == this->queued_.insert(key).second) {
+      this->ready_.push_back(key);
+      this->cv_.notify_one();
+    }
+  }
+
+  // Requires mtx_ to be held
+  void ExpireTimers(const Clock::time_point now) {
+    while (false == this->timers_.empty() &&
+           this->timers_.begin()->first <= now) {
+      this->MarkReady(this->timers_.begin()->second);
+      this->timers_.erase(this->timers_.begin());
+    }
+  }
+};
+}  // namespace game_engine
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "quad_id.h"
+
+namespace game_engine {
+// ListenerList holds the callbacks that a table invokes with the QuadId of
+// every quad it writes. The list is an immutable snapshot: Add() and Remove()
+// copy it and replace it with std::atomic_store, so writers notify without
+// taking a lock, and listeners may come and go while other threads write.
+//
+// A write that loaded the list before Remove() returned may still invoke the
+// removed listener once, so a listener must stay safe to call after it is
+// removed.
+class ListenerList {
+ public:
+  using Listener = std::function<void(const QuadId)>;
+
+  // Identifies a listener for Remove()
+  using Handle = size_t;
+
+  ListenerList()
+      : listeners_(std::make_shared<const std::vector<Entry>>()) {}
+
+  ListenerList(const ListenerList&) = delete;
+  ListenerList& operator=(const ListenerList&) = delete;
+
+  Handle Add(const Listener& listener) {
+    std::lock_guard<std::mutex> lock(this->mtx_);
+    auto listeners = std::make_shared<std::vector<Entry>>(
+        *std::atomic_load(&this->listeners_));
+    const Handle handle = this->next_handle_++;
+    listeners->emplace_back(handle, listener);
+    std::atomic_store(&this->listeners_,
+                      std::shared_ptr<const std::vector<Entry>>(listeners));
+    return handle;
+  }
+
+  void Remove(const Handle handle) {
+    std::lock_guard<std::mutex> lock(this->mtx_);
+    auto listeners = std::make_shared<std::vector<Entry>>();
+    for (const Entry& entry : *std::atomic_load(&this->listeners_)) {
+      if (handle != entry.first) {
+        listeners->push_back(entry);
+      }
+    }
+    std::atomic_store(&this->listeners_,
+                      std::shared_ptr<const std::vector<Entry>>(listeners));
+  }
+
+  // Invokes every listener with id
+  void Notify(const QuadId id) const {
+    const std::shared_ptr<const std::vector<Entry>> listeners =
+        std::atomic_load(&this->listeners_);
+    for (const Entry& entry : *listeners) {
+      entry.second(id);
+    }
+  }
+
+ private:
+  using Entry = std::pair<Handle, Listener>;
+
+  // Serializes Add() and Remove()
+  std::mutex mtx_;
+  Handle next_handle_ = 0;
+  std::shared_ptr<const std::vector<Entry>> listeners_;
+};
+}  // namespace game_engine
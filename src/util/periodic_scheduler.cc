@@ -0,0 +1,103 @@
+#include "periodic_scheduler.h"
+
+#include <algorithm>
+#include <thread>
+
+namespace game_engine {
+size_t PeriodicScheduler::AddTask(const std::string& name,
+                                  const Clock::duration period,
+                                  const std::function<void()>& task) {
+  std::lock_guard<std::mutex> lock(this->mtx_);
+  const size_t idx = this->tasks_.size();
+
+  Task entry;
+  entry.function = task;
+  entry.stats.name = name;
+  entry.stats.period = std::max(period, Clock::duration(1));
+  this->tasks_.push_back(entry);
+
+  this->deadlines_.emplace(Clock::now(), idx);
+  this->cv_.notify_one();
+  return idx;
+}
+
+void PeriodicScheduler::Run(const StopToken& stop_token) {
+  // Wake the workers if a stop is requested through the token
+  StopCallback stop_callback(stop_token, [this]() { this->Stop(); });
+
+  std::vector<std::thread> workers;
+  for (size_t idx = 1; idx < this->options_.worker_threads; ++idx) {
+    workers.emplace_back([this]() { this->Work(); });
+  }
+  this->Work();
+
+  for (std::thread& worker : workers) {
+    worker.join();
+  }
+
+  // Every task is re-queued as its worker exits, so the deadlines are intact
+  // for the next call to Run()
+  std::lock_guard<std::mutex> lock(this->mtx_);
+  this->ok_ = true;
+}
+
+void PeriodicScheduler::Stop() {
+  std::lock_guard<std::mutex> lock(this->mtx_);
+  this->ok_ = false;
+  this->cv_.notify_all();
+}
+
+std::vector<PeriodicScheduler::TaskStats> PeriodicScheduler::Stats() const {
+  std::lock_guard<std::mutex> lock(this->mtx_);
+  std::vector<TaskStats> stats;
+  for (const Task& task : this->tasks_) {
+    stats.push_back(task.stats);
+  }
+  return stats;
+}
+
+void PeriodicScheduler::Work() {
+  std::unique_lock<std::mutex> lock(this->mtx_);
+  while (true == this->ok_) {
+    if (true == this->deadlines_.empty()) {
+      this->cv_.wait(lock);
+      continue;
+    }
+
+    const Deadline next = this->deadlines_.top();
+    if (Clock::now() < next.first) {
+      this->cv_.wait_until(lock, next.first);
+      continue;
+    }
+    this->deadlines_.pop();
+
+    // Run the task without holding the lock. The vector may grow while the
+    // task runs, so the function is copied out rather than referenced.
+    const std::function<void()> function = this->tasks_[next.second].function;
+    lock.unlock();
+    const Clock::time_point start = Clock::now();
+    function();
+    const Clock::time_point end = Clock::now();
+    lock.lock();
+
+    TaskStats& stats = this->tasks_[next.second].stats;
+    const Clock::duration execution_time = end - start;
+    stats.runs++;
+    stats.total_execution_time += execution_time;
+    stats.max_execution_time =
+        std::max(stats.max_execution_time, execution_time);
+
+    // Advance from the previous deadline so that the rate does not drift.
+    // Deadlines that have already passed are skipped and counted as misses.
+    Clock::time_point deadline = next.first + stats.period;
+    if (deadline <= end) {
+      const uint64_t missed = (end - deadline) / stats.period + 1;
+      stats.deadline_misses += missed;
+      deadline += missed * stats.period;
+    }
+
+    this->deadlines_.emplace(deadline, next.second);
+    this->cv_.notify_one();
+  }
+}
+}  // namespace game_engine
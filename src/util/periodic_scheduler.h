@@ -0,0 +1,94 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "stop_token.h"
+
+namespace game_engine {
+// PeriodicScheduler runs registered periodic tasks on a fixed pool of worker
+// threads. Components that previously owned a thread and slept between
+// iterations register their loop body instead, so the number of threads does
+// not grow with the number of components.
+//
+// Deadlines are computed from the previous deadline rather than from the end
+// of the previous run, so a task's rate does not drift with its workload. A
+// task never runs concurrently with itself. If a task overruns one or more of
+// its deadlines, the missed periods are skipped and counted rather than run
+// back to back.
+class PeriodicScheduler {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  struct Options {
+    // Number of threads that execute tasks, including the thread that calls
+    // Run()
+    size_t worker_threads = 2;
+
+    Options() {}
+  };
+
+  struct TaskStats {
+    std::string name;
+    Clock::duration period = Clock::duration::zero();
+
+    // Number of completed runs
+    uint64_t runs = 0;
+
+    // Number of periods that were skipped because the task could not run
+    // before the following deadline
+    uint64_t deadline_misses = 0;
+
+    // Wall time spent executing the task
+    Clock::duration total_execution_time = Clock::duration::zero();
+    Clock::duration max_execution_time = Clock::duration::zero();
+  };
+
+  PeriodicScheduler(const Options& options = Options()) : options_(options) {}
+
+  // Register a task that runs every period. Tasks may be added before or
+  // while the scheduler is running. The first run is due immediately.
+  // Returns an index into Stats().
+  size_t AddTask(const std::string& name, const Clock::duration period,
+                 const std::function<void()>& task);
+
+  // Run tasks until Stop() is called or a stop is requested on stop_token.
+  // Blocks the calling thread, which acts as one of the workers. Once Run()
+  // has returned, it may be called again.
+  void Run(const StopToken& stop_token = StopToken());
+
+  // Make Run() return once the tasks that are currently executing finish
+  void Stop();
+
+  // Execution statistics of every task, in registration order
+  std::vector<TaskStats> Stats() const;
+
+ private:
+  struct Task {
+    std::function<void()> function;
+    TaskStats stats;
+  };
+
+  // Deadline and task index, ordered so that the earliest deadline is on top
+  using Deadline = std::pair<Clock::time_point, size_t>;
+  using DeadlineQueue = std::priority_queue<Deadline, std::vector<Deadline>,
+                                            std::greater<Deadline>>;
+
+  Options options_;
+
+  mutable std::mutex mtx_;
+  std::condition_variable cv_;
+  bool ok_ = true;
+  std::vector<Task> tasks_;
+  DeadlineQueue deadlines_;
+
+  void Work();
+};
+}  // namespace game_engine
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <cstddef>
+
+namespace game_engine {
+// Dense integer handle for a quad. Wardens and status tables assign ids in
+// registration order so that hot paths can index flat vectors instead of
+// hashing quad names. Names remain the source of truth for configuration
+// and ROS topic wiring.
+using QuadId = size_t;
+}  // namespace game_engine
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+
+namespace game_engine {
+// SeqLock holds a small, trivially copyable value that is read far more often
+// than it is written. Readers never block a writer and never take a lock:
+// they copy the value and retry if a write overlapped the copy. Writers are
+// serialized among themselves by claiming an odd sequence number.
+//
+// The value is stored as relaxed atomic words so that a read overlapping a
+// write is not a data race, only a torn copy that is discarded.
+template <class T>
+class SeqLock {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "SeqLock requires a trivially copyable type");
+
+ public:
+  SeqLock(const T& value = T()) {
+    uint64_t words[kWords] = {};
+    std::memcpy(words, &value, sizeof(T));
+    for (size_t idx = 0; idx < kWords; ++idx) {
+      this->words_[idx].store(words[idx], std::memory_order_relaxed);
+    }
+  }
+
+  SeqLock(const SeqLock&) = delete;
+  SeqLock& operator=(const SeqLock&) = delete;
+
+  T Load() const {
+    uint64_t words[kWords];
+    while (true) {
+      const uint64_t sequence = this->sequence_.load(std::memory_order_acquire);
+      if (0 != (sequence & 1)) {
+        std::this_thread::yield();
+        continue;
+      }
+
+      for (size_t idx = 0; idx < kWords; ++idx) {
+        words[idx] = this->words_[idx].load(std::memory_order_relaxed);
+      }
+
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (sequence == this->sequence_.load(std::memory_order_relaxed)) {
+        break;
+      }
+    }
+
+    T value;
+    std::memcpy(&value, words, sizeof(T));
+    return value;
+  }
+
+  void Store(const T& value) { this->Exchange(value); }
+
+  // Store a value and return the one it replaced. The pair is atomic with
+  // respect to other writers.
+  T Exchange(const T& value) {
+    uint64_t words[kWords] = {};
+    std::memcpy(words, &value, sizeof(T));
+
+    const uint64_t sequence = this->BeginWrite();
+    uint64_t previous_words[kWords];
+    for (size_t idx = 0; idx < kWords; ++idx) {
+      previous_words[idx] = this->words_[idx].load(std::memory_order_relaxed);
+      this->words_[idx].store(words[idx], std::memory_order_relaxed);
+    }
+    this->sequence_.store(sequence + 2, std::memory_order_release);
+
+    T previous;
+    std::memcpy(&previous, previous_words, sizeof(T));
+    return previous;
+  }
+
+ private:
+  static constexpr size_t kWords = (sizeof(T) + 7) / 8;
+
+  std::atomic<uint64_t> sequence_{0};
+  std::atomic<uint64_t> words_[kWords];
+
+  // Claim the lock by moving the sequence from even to odd. Returns the even
+  // sequence number that was claimed.
+  uint64_t BeginWrite() {
+    uint64_t sequence = this->sequence_.load(std::memory_order_relaxed);
+    while (true) {
+      if (0 != (sequence & 1)) {
+        std::this_thread::yield();
+        sequence = this->sequence_.load(std::memory_order_relaxed);
+        continue;
+      }
+      if (true == this->sequence_.compare_exchange_weak(
+                      sequence, sequence + 1, std::memory_order_acquire,
+                      std::memory_order_relaxed)) {
+        break;
+      }
+    }
+
+    // Order the odd sequence before the writes to the value
+    std::atomic_thread_fence(std::memory_order_release);
+    return sequence;
+  }
+};
+}  // namespace game_engine
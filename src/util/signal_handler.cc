@@ -0,0 +1,32 @@
+#include "signal_handler.h"
+
+#include <semaphore.h>
+
+#include <cerrno>
+#include <csignal>
+
+namespace game_engine {
+namespace {
+sem_t sigint_semaphore;
+
+// sem_post is async-signal-safe
+void SigIntHandler(int) { sem_post(&sigint_semaphore); }
+}  // namespace
+
+void InstallSigIntHandler() {
+  sem_init(&sigint_semaphore, 0, 0);
+  std::signal(SIGINT, SigIntHandler);
+}
+
+void AwaitSigInt() {
+  while (0 != sem_wait(&sigint_semaphore)) {
+    // Retry if interrupted by another signal
+    if (EINTR != errno) {
+      return;
+    }
+  }
+
+  // Pass the wake-up on to the next waiting thread
+  sem_post(&sigint_semaphore);
+}
+}  // namespace game_engine
@@ -0,0 +1,14 @@
+#pragma once
+
+namespace game_engine {
+// Executables shut down when they receive SIGINT. A signal handler may only
+// call async-signal-safe functions, so the handler posts to a semaphore and
+// the shutdown itself happens on a regular thread blocked in AwaitSigInt().
+
+// Install the SIGINT handler. Must be called before ros::init so that it
+// replaces the default handler, and before any call to AwaitSigInt().
+void InstallSigIntHandler();
+
+// Block until SIGINT has been received. Any number of threads may wait.
+void AwaitSigInt();
+}  // namespace game_engine
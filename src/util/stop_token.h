@@ -0,0 +1,160 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace game_engine {
+// StopSource and StopToken implement cooperative cancellation. A component
+// owns a StopSource and hands StopTokens to the loops it runs. Loops sleep
+// with the token's Wait functions instead of std::this_thread::sleep_for, so
+// that RequestStop() wakes them immediately rather than after the current
+// sleep expires.
+//
+// A StopSource may be Reset() once the loops it stopped have returned. This
+// allows a component to be run again in the same process.
+//
+// Code that sleeps on its own condition variable can register a StopCallback
+// to be woken when a stop is requested.
+class StopToken {
+ public:
+  // A default-constructed token is never stopped. Its waits simply sleep.
+  StopToken() {}
+
+  bool StopRequested() const {
+    return (nullptr != this->state_) && (true == this->state_->stopped_);
+  }
+
+  // Sleep until the deadline has passed or a stop is requested. Returns true
+  // if a stop has been requested.
+  template <class Clock, class Duration>
+  bool WaitUntil(const std::chrono::time_point<Clock, Duration>& deadline) const {
+    if (nullptr == this->state_) {
+      std::this_thread::sleep_until(deadline);
+      return false;
+    }
+
+    std::unique_lock<std::mutex> lock(this->state_->mtx_);
+    return this->state_->cv_.wait_until(
+        lock, deadline, [&] { return true == this->state_->stopped_; });
+  }
+
+  // Sleep for a duration or until a stop is requested. Returns true if a stop
+  // has been requested.
+  template <class Rep, class Period>
+  bool WaitFor(const std::chrono::duration<Rep, Period>& duration) const {
+    return this->WaitUntil(std::chrono::steady_clock::now() + duration);
+  }
+
+  // Block until a stop is requested
+  void Wait() const {
+    if (nullptr == this->state_) {
+      return;
+    }
+
+    std::unique_lock<std::mutex> lock(this->state_->mtx_);
+    this->state_->cv_.wait(lock, [&] { return true == this->state_->stopped_; });
+  }
+
+ private:
+  friend class StopSource;
+  friend class StopCallback;
+
+  struct State {
+    std::mutex mtx_;
+    std::condition_variable cv_;
+    std::atomic<bool> stopped_{false};
+
+    // Callbacks registered by live StopCallbacks, keyed by registration
+    uint64_t next_callback_ = 0;
+    std::map<uint64_t, std::function<void()>> callbacks_;
+  };
+
+  explicit StopToken(std::shared_ptr<State> state) : state_(state) {}
+
+  std::shared_ptr<State> state_;
+};
+
+class StopSource {
+ public:
+  StopSource() : state_(std::make_shared<StopToken::State>()) {}
+
+  // Returns a token that observes the current stop state
+  StopToken Token() const { return StopToken(std::atomic_load(&this->state_)); }
+
+  bool StopRequested() const {
+    return true == std::atomic_load(&this->state_)->stopped_;
+  }
+
+  // Mark the current state as stopped, wake every waiting token and invoke
+  // every registered StopCallback
+  void RequestStop() {
+    std::shared_ptr<StopToken::State> state = std::atomic_load(&this->state_);
+    std::lock_guard<std::mutex> lock(state->mtx_);
+    if (true == state->stopped_) {
+      return;
+    }
+
+    state->stopped_ = true;
+    state->cv_.notify_all();
+    for (const auto& callback : state->callbacks_) {
+      callback.second();
+    }
+  }
+
+  // Begin a new, un-stopped state. Tokens handed out before the reset keep
+  // observing the old state.
+  void Reset() {
+    std::atomic_store(&this->state_, std::make_shared<StopToken::State>());
+  }
+
+ private:
+  std::shared_ptr<StopToken::State> state_;
+};
+
+// Invokes a callback when a stop is requested on a token, or immediately if a
+// stop has already been requested. The callback is deregistered when the
+// StopCallback is destroyed and is guaranteed not to be running after the
+// destructor returns. Callbacks run while the token's state is locked and
+// must not wait on the same token.
+class StopCallback {
+ public:
+  StopCallback(const StopToken& token, const std::function<void()>& callback)
+      : state_(token.state_) {
+    if (nullptr == this->state_) {
+      return;
+    }
+
+    std::lock_guard<std::mutex> lock(this->state_->mtx_);
+    if (true == this->state_->stopped_) {
+      callback();
+      return;
+    }
+
+    this->id_ = this->state_->next_callback_++;
+    this->state_->callbacks_[this->id_] = callback;
+    this->registered_ = true;
+  }
+
+  ~StopCallback() {
+    if (true == this->registered_) {
+      std::lock_guard<std::mutex> lock(this->state_->mtx_);
+      this->state_->callbacks_.erase(this->id_);
+    }
+  }
+
+  StopCallback(const StopCallback&) = delete;
+  StopCallback& operator=(const StopCallback&) = delete;
+
+ private:
+  std::shared_ptr<StopToken::State> state_;
+  uint64_t id_ = 0;
+  bool registered_ = false;
+};
+}  // namespace game_engine
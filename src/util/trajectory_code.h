@@ -33,6 +33,19 @@ enum class MediationLayerCode {
   // Watchdog Codes
   QuadNotRegistered = 18,
   RegisterQuadWithWatchdog = 19,
+
+  // Trajectory Warden Codes
+  TrajectoryStatusTimeout = 20,
+  NotModified = 21,
+
+  // Vetter Codes
+  SegmentIntersectsObstacle = 22,
+
+  // Mediation Layer Codes
+  TrajectoryTruncated = 23,
+
+  // Trajectory Warden Codes
+  TrajectorySuperseded = 24,
 };
 
 // TrajectoryCode is used for returning the code, value, and index for
@@ -1,10 +1,16 @@
 #undef NDEBUG
 #include <cassert>
 
+#include <cmath>
 #include <iostream>
+#include <thread>
+#include <vector>
 
+#include "map3d.h"
+#include "occupancy_bitmap.h"
 #include "occupancy_grid2d.h"
 #include "node_eigen.h"
+#include "test_shapes.h"
 #include "yaml-cpp/yaml.h"
 
 using namespace game_engine;
@@ -159,9 +165,128 @@ void test_OccupancyGrid2D() {
   }
 }
 
+void test_OccupancyBitmap() {
+  using State = OccupancyBitmap::State;
+  OccupancyBitmap bitmap(Eigen::AlignedBox3d(Point3D(-1,0,0), Point3D(1,1,0.5)),
+                         0.25, State::kFree);
+  assert((Eigen::Array3i(8, 4, 2) == bitmap.Size()).all());
+
+  bitmap.Set(4, 2, 1, State::kOccupied);
+  bitmap.Set(7, 3, 1, State::kUnknown);
+  assert(State::kOccupied == bitmap.Get(4, 2, 1));
+  assert(State::kUnknown == bitmap.Get(7, 3, 1));
+  assert(State::kFree == bitmap.Get(5, 2, 1));
+  assert(State::kFree == bitmap.Get(3, 2, 1));
+
+  assert(State::kOccupied == bitmap.At(Point3D(0.1, 0.6, 0.3)));
+  assert(State::kFree == bitmap.At(Point3D(-0.9, 0.1, 0.1)));
+  assert(State::kUnknown == bitmap.At(Point3D(0.9, 0.9, 0.4)));
+  assert(State::kUnknown == bitmap.At(Point3D(0.1, 0.6, 0.6)));
+  assert(State::kUnknown == bitmap.At(Point3D(-1.1, 0.6, 0.3)));
+  assert(State::kUnknown == bitmap.At(Point3D(NAN, 0.6, 0.3)));
+
+  const Eigen::AlignedBox3d cell = bitmap.CellBox(4, 2, 1);
+  assert(cell.min().isApprox(Point3D(0, 0.5, 0.25)));
+  assert(cell.max().isApprox(Point3D(0.25, 0.75, 0.5)));
+
+  Eigen::Array3i begin, end;
+  bitmap.CellRange(Eigen::AlignedBox3d(Point3D(-0.1,0.3,-5), Point3D(0.3,0.3,0.1)),
+                   begin, end);
+  assert((Eigen::Array3i(3, 1, 0) == begin).all());
+  assert((Eigen::Array3i(6, 2, 1) == end).all());
+}
+
+void test_Map3D() {
+  // A forest of small obstacles
+  std::vector<Polyhedron> obstacles;
+  for (size_t idx = 0; idx < 100; ++idx) {
+    const Point3D lo(idx % 10, idx / 10, 0);
+    obstacles.push_back(Box(lo, lo + Point3D(0.5, 0.5, 5)));
+  }
+  const Map3D map(Box(Point3D(0,0,0), Point3D(10,10,10)), obstacles);
+
+  { // Point queries match testing every obstacle
+    std::vector<Point3D> points;
+    for (size_t idx = 0; idx < 1000; ++idx) {
+      points.push_back(Point3D(6,6,6) + 6 * Point3D::Random());
+    }
+
+    const std::vector<bool> contained = map.Contains(points);
+    const std::vector<bool> free = map.IsFreeSpace(points);
+    for (size_t idx = 0; idx < points.size(); ++idx) {
+      bool expected_free = true;
+      for (const Polyhedron& obstacle : obstacles) {
+        expected_free = expected_free && !obstacle.Contains(points[idx]);
+      }
+      assert(expected_free == map.IsFreeSpace(points[idx]));
+      assert(expected_free == free[idx]);
+      assert(map.Boundary().Contains(points[idx]) == contained[idx]);
+    }
+
+    assert(false == map.IsFreeSpace(Point3D(3.25, 4.25, 1)));
+    assert(true == map.IsFreeSpace(Point3D(3.75, 4.75, 1)));
+  }
+
+  { // The index survives copies and inflation
+    const Map3D copy = map;
+    assert(false == copy.IsFreeSpace(Point3D(3.25, 4.25, 1)));
+    const Map3D inflated = map.Inflate(0.2);
+    assert(false == inflated.IsFreeSpace(Point3D(3.6, 4.25, 1)));
+  }
+
+  { // Rasterized inflated maps answer exactly like unrasterized ones
+    const std::shared_ptr<const Map3D> inflated = map.Inflated(0.2);
+    const Map3D exact = map.Inflate(0.2);
+
+    std::vector<Point3D> points;
+    for (size_t idx = 0; idx < 20000; ++idx) {
+      points.push_back(Point3D(5,5,5) + 5.5 * Point3D::Random());
+    }
+    // Points on the inflated surfaces and on cell boundaries
+    for (size_t idx = 0; idx < 20000; ++idx) {
+      const Eigen::Array3d random =
+          (Eigen::Array3d::Random() + 1.0) * 0.5 * Eigen::Array3d(200, 200, 120);
+      points.push_back(random.floor().matrix() * 0.05);
+    }
+
+    for (const Point3D& point : points) {
+      assert(exact.Contains(point) == inflated->Contains(point));
+      assert(exact.IsFreeSpace(point) == inflated->IsFreeSpace(point));
+    }
+  }
+
+  { // Concurrent callers share one map per distance
+    const Map3D copy = map;
+    std::shared_ptr<const Map3D> inflated[8];
+    std::vector<std::thread> threads;
+    for (size_t idx = 0; idx < 8; ++idx) {
+      threads.emplace_back([&, idx]() {
+        inflated[idx] = copy.Inflated(0.1 * (1 + idx % 2));
+      });
+    }
+    for (std::thread& thread : threads) {
+      thread.join();
+    }
+    for (size_t idx = 0; idx < 8; ++idx) {
+      assert(nullptr != inflated[idx]);
+      assert(inflated[idx % 2] == inflated[idx]);
+    }
+    assert(inflated[0] != inflated[1]);
+    assert(map.Inflated(0.1) == inflated[0]);
+    assert(false == inflated[1]->IsFreeSpace(Point3D(3.6, 4.25, 1)));
+  }
+
+  { // Maps without obstacles
+    const Map3D empty(Box(Point3D(0,0,0), Point3D(1,1,1)));
+    assert(true == empty.IsFreeSpace(Point3D(0.5, 0.5, 0.5)));
+  }
+}
+
 int main(int argc, char** argv) {
   test_Map2D();
   test_OccupancyGrid2D();
+  test_OccupancyBitmap();
+  test_Map3D();
 
   std::cout << "All tests passed!" << std::endl;
   return EXIT_SUCCESS;
@@ -3,10 +3,13 @@
 // Prevent assert from being optimized out
 #undef NDEBUG
 
+#include <algorithm>
 #include <cassert>
 #include <iostream>
+#include <random>
 #include <Eigen/Core>
 
+#include "aabb_tree.h"
 #include "line2d.h"
 #include "line3d.h"
 #include "polygon.h"
@@ -68,6 +71,106 @@ void test_Polyhedron() {
     assert(false == poly.Contains(exterior_point));
   }
 
+  { // Faces share their vertices
+    const Polyhedron poly = poly_;
+    assert(8 == poly.Vertices().size());
+    assert(6 == poly.Faces().size());
+
+    // Faces and edges read back as they were given
+    for (size_t face_idx = 0; face_idx < faces.size(); ++face_idx) {
+      const EdgeRange edges = poly.Faces()[face_idx].Edges();
+      assert(faces[face_idx].Edges().size() == edges.size());
+      for (size_t idx = 0; idx < edges.size(); ++idx) {
+        assert(faces[face_idx].Edges()[idx].Start() == edges[idx].Start());
+        assert(faces[face_idx].Edges()[idx].End() == edges[idx].End());
+      }
+    }
+
+    // As do faces built from indices
+    const Polyhedron indexed(poly.Vertices(), {{0, 1, 2}, {0, 2, 3}});
+    assert(2 == indexed.Faces().size());
+    assert(poly.Vertices()[3] == indexed.Faces()[1].Edges()[2].Start());
+    assert(poly.Vertices()[0] == indexed.Faces()[1].Edges()[2].End());
+  }
+
+  { // Batches of points agree with the faces
+    const Polyhedron poly = poly_;
+    std::vector<Point3D> points;
+    for (double x = -0.25; x < 1.3; x += 0.1) {
+      for (double y = -0.25; y < 1.3; y += 0.1) {
+        for (double z = -0.25; z < 1.3; z += 0.1) {
+          points.push_back(Point3D(x, y, z));
+        }
+      }
+    }
+
+    const std::vector<bool> contained = poly.ContainsBatch(points);
+    assert(points.size() == contained.size());
+    for (size_t idx = 0; idx < points.size(); ++idx) {
+      bool on_left_side = true;
+      for (const Polyhedron::Face& face : poly.Faces()) {
+        on_left_side = on_left_side && face.ToPlane3D().OnLeftSide(points[idx]);
+      }
+      assert(on_left_side == poly.Contains(points[idx]));
+      assert(on_left_side == contained[idx]);
+    }
+
+    assert(true == poly.ContainsBatch({}).empty());
+    assert(Eigen::AlignedBox3d(Point3D(0,0,0), Point3D(1,1,1))
+               .isApprox(poly.BoundingBox()));
+
+    // The half-spaces are rebuilt when decoded
+    YAML::Node node;
+    for (const Polyhedron::Face& face : poly.Faces()) {
+      YAML::Node face_node;
+      for (const Line3D& edge : face.Edges()) {
+        face_node.push_back(edge);
+      }
+      node.push_back(face_node);
+    }
+    const Polyhedron decoded = node.as<Polyhedron>();
+    assert(decoded.ContainsBatch(points) == contained);
+    assert(poly.BoundingBox().isApprox(decoded.BoundingBox()));
+  }
+
+  { // Segments
+    const Polyhedron poly = poly_;
+
+    // Passing through, without either end inside
+    assert(true  == poly.IntersectsSegment(Point3D(-1,0.5,0.5), Point3D(2,0.5,0.5)));
+    // One end inside
+    assert(true  == poly.IntersectsSegment(Point3D(0.5,0.5,0.5), Point3D(2,2,2)));
+    // Entirely inside
+    assert(true  == poly.IntersectsSegment(Point3D(0.4,0.5,0.5), Point3D(0.6,0.5,0.5)));
+    // Passing by
+    assert(false == poly.IntersectsSegment(Point3D(-1,1.5,0.5), Point3D(2,1.5,0.5)));
+    // Crossing every plane's line, but not the polyhedron
+    assert(false == poly.IntersectsSegment(Point3D(-1,0.5,2), Point3D(0.5,-1,2)));
+    // Touching a face only, as Contains() excludes the surface
+    assert(false == poly.IntersectsSegment(Point3D(-1,0.5,1), Point3D(2,0.5,1)));
+    // Degenerate segments
+    assert(true  == poly.IntersectsSegment(Point3D(0.5,0.5,0.5), Point3D(0.5,0.5,0.5)));
+    assert(false == poly.IntersectsSegment(Point3D(1.5,0.5,0.5), Point3D(1.5,0.5,0.5)));
+  }
+
+  { // Classify boxes
+    using Overlap = Polyhedron::Overlap;
+    const Polyhedron poly = poly_;
+    const auto box = [](const Point3D& lo, const Point3D& hi) {
+      return Eigen::AlignedBox3d(lo, hi);
+    };
+
+    assert(Overlap::kInside == poly.Classify(box(Point3D(0.25,0.25,0.25), Point3D(0.75,0.75,0.75))));
+    assert(Overlap::kOutside == poly.Classify(box(Point3D(1.5,0,0), Point3D(2,1,1))));
+    assert(Overlap::kPartial == poly.Classify(box(Point3D(0.5,0.5,0.5), Point3D(1.5,1.5,1.5))));
+    assert(Overlap::kPartial == poly.Classify(box(Point3D(-1,-1,-1), Point3D(2,2,2))));
+
+    // Boxes touching a face are neither inside nor outside, since rounding
+    // could place points of the face on either side
+    assert(Overlap::kPartial == poly.Classify(box(Point3D(1,0,0), Point3D(2,1,1))));
+    assert(Overlap::kPartial == poly.Classify(box(Point3D(0,0,0), Point3D(0.5,0.5,0.5))));
+  }
+
   { // Expand
     const Polyhedron original_poly = poly_;
     const Polyhedron expanded_poly = original_poly.Expand(1.0);
@@ -88,6 +191,163 @@ void test_Polyhedron() {
     assert(false == expanded_poly.Contains(new_exterior_point));
   }
 
+  { // Expand and shrink offset every face along its normal
+    // Unit cube with the corner at (1,1,1) cut off
+    const Polyhedron cut_cube(
+        {Point3D(0,0,0), Point3D(1,0,0), Point3D(1,1,0), Point3D(0,1,0),
+         Point3D(0,0,1), Point3D(1,0,1), Point3D(0,1,1), Point3D(0.9,1,1),
+         Point3D(1,0.9,1), Point3D(1,1,0.9)},
+        {{0,1,2,3}, {6,7,8,5,4}, {0,3,6,4}, {5,8,9,2,1}, {4,5,1,0},
+         {3,2,9,7,6}, {9,8,7}});
+    const auto signed_distance = [](const Plane3D& face, const Point3D& point) {
+      return face.NormalVector().dot(point - face.Vertices()[0]);
+    };
+
+    // Every vertex moves onto the offset planes of its faces
+    const Polyhedron expanded = cut_cube.Expand(0.3);
+    for (size_t face_idx = 0; face_idx < cut_cube.Faces().size(); ++face_idx) {
+      const Plane3D face = cut_cube.Faces()[face_idx].ToPlane3D();
+      for (const Line3D& edge : expanded.Faces()[face_idx].Edges()) {
+        assert(std::abs(signed_distance(face, edge.Start()) + 0.3) < 1e-9);
+      }
+    }
+    assert(Eigen::AlignedBox3d(Point3D(-0.3,-0.3,-0.3), Point3D(1.3,1.3,1.3))
+               .isApprox(expanded.BoundingBox()));
+
+    // Including the cut face, which is not axis-aligned
+    const Point3D cut_center = Point3D(0.9,1,1) / 3 + Point3D(1,0.9,1) / 3 +
+                               Point3D(1,1,0.9) / 3;
+    const Vec3D outwards = Vec3D(1,1,1).normalized();
+    assert(true  == expanded.Contains(cut_center + (0.3 - 1e-6) * outwards));
+    assert(false == expanded.Contains(cut_center + (0.3 + 1e-6) * outwards));
+
+    // Shrinking far enough removes the cut face. The mesh is rebuilt from
+    // the remaining planes, so the result is the cube [0.2, 0.8]^3.
+    const Polyhedron shrunk = cut_cube.Shrink(0.2);
+    assert(Eigen::AlignedBox3d(Point3D(0.2,0.2,0.2), Point3D(0.8,0.8,0.8))
+               .isApprox(shrunk.BoundingBox()));
+    assert(6 == shrunk.Faces().size());
+    assert(8 == shrunk.Vertices().size());
+    for (const Point3D& vertex : shrunk.Vertices()) {
+      assert(((vertex.array() - 0.5).abs() - 0.3).abs().maxCoeff() < 1e-9);
+    }
+    for (const Polyhedron::Face& face : shrunk.Faces()) {
+      assert(4 == face.Edges().size());
+    }
+    assert(true == shrunk.IsConvex());
+    assert(true  == shrunk.Contains(Point3D(0.75,0.75,0.75)));
+    assert(false == shrunk.Contains(Point3D(0.85,0.5,0.5)));
+    assert(std::abs(shrunk.InteriorPoint().sum() - 1.5) < 1e-9);
+
+    // Expanding a vertex where four faces meet unevenly splits it. The apex
+    // of this pyramid becomes an edge, and a face that was a triangle
+    // becomes a quadrilateral.
+    const Polyhedron pyramid(
+        {Point3D(0,0,0), Point3D(2,0,0), Point3D(2,1,0), Point3D(0,1,0),
+         Point3D(1,0.5,1)},
+        {{0,1,2,3}, {0,4,1}, {1,4,2}, {2,4,3}, {3,4,0}});
+    assert(true == pyramid.IsConvex());
+    const Polyhedron grown = pyramid.Expand(0.1);
+    assert(true == grown.IsConvex());
+    assert(5 == grown.Faces().size());
+    assert(6 == grown.Vertices().size());
+    size_t num_edges = 0;
+    for (const Polyhedron::Face& face : grown.Faces()) {
+      num_edges += face.Edges().size();
+    }
+    assert(18 == num_edges);
+
+    // The vertices agree with Contains()
+    const Point3D grown_center = grown.InteriorPoint();
+    for (const Point3D& vertex : grown.Vertices()) {
+      assert(false == grown.Contains(vertex + 1e-6 * (vertex - grown_center)));
+      assert(true  == grown.Contains(vertex - 1e-6 * (vertex - grown_center)));
+    }
+
+    // Shrinking further leaves nothing
+    const Polyhedron empty = cut_cube.Shrink(0.6);
+    assert(true  == empty.BoundingBox().isEmpty());
+    assert(true  == empty.Vertices().empty());
+    assert(false == empty.Contains(Point3D(0.5,0.5,0.5)));
+  }
+
+  { // Convex hull
+    // Corners of the unit cube, points inside of it and points on its faces
+    std::mt19937 generator(0);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::vector<Point3D> points;
+    for (size_t idx = 0; idx < 8; ++idx) {
+      points.push_back(Point3D(idx & 1, (idx >> 1) & 1, (idx >> 2) & 1));
+    }
+    for (size_t idx = 0; idx < 500; ++idx) {
+      Point3D point(unit(generator), unit(generator), unit(generator));
+      points.push_back(point);
+      point(idx % 3) = (idx % 2);
+      points.push_back(point);
+    }
+
+    const Polyhedron hull = Polyhedron::ConvexHullFromPoints(points);
+    assert(true == hull.IsConvex());
+    assert(8 == hull.Vertices().size());
+    assert(6 == hull.Faces().size());
+    for (const Polyhedron::Face& face : hull.Faces()) {
+      assert(4 == face.Edges().size());
+    }
+    for (size_t idx = 0; idx < 1000; ++idx) {
+      const Point3D point(2 * unit(generator) - 0.5, 2 * unit(generator) - 0.5,
+                          2 * unit(generator) - 0.5);
+      assert(poly_.Contains(point) == hull.Contains(point));
+    }
+
+    // The faces of a cube made of triangles are merged
+    std::vector<std::vector<size_t>> triangles;
+    for (const Polyhedron::Face& face : poly_.Faces()) {
+      const EdgeRange edges = face.Edges();
+      const auto index = [&](const size_t idx) {
+        const std::vector<Point3D>& vertices = poly_.Vertices();
+        return static_cast<size_t>(
+            std::find(vertices.begin(), vertices.end(), edges.Vertex(idx)) -
+            vertices.begin());
+      };
+      triangles.push_back({index(0), index(1), index(2)});
+      triangles.push_back({index(0), index(2), index(3)});
+    }
+    const Polyhedron triangulated(poly_.Vertices(), triangles);
+    assert(true == triangulated.IsConvex());
+    assert(12 == triangulated.Faces().size());
+    assert(6 == triangulated.ConvexHull().Faces().size());
+
+    // Points on a sphere are all vertices of their hull, and every point
+    // inside of the sphere is inside of the hull
+    std::normal_distribution<double> normal(0.0, 1.0);
+    std::vector<Point3D> sphere;
+    for (size_t idx = 0; idx < 2000; ++idx) {
+      sphere.push_back(
+          Point3D(normal(generator), normal(generator), normal(generator))
+              .normalized());
+    }
+    const Polyhedron sphere_hull = Polyhedron::ConvexHullFromPoints(sphere);
+    assert(true == sphere_hull.IsConvex());
+    assert(sphere.size() == sphere_hull.Vertices().size());
+    assert(true == sphere_hull.Contains(Point3D(0, 0, 0)));
+    assert(true == sphere_hull.Contains(Point3D(0.5, 0.5, 0.5)));
+    assert(false == sphere_hull.Contains(Point3D(0.6, 0.6, 0.6)));
+
+    // Points that do not span a volume have no hull
+    assert(true == Polyhedron::ConvexHullFromPoints(
+                       {Point3D(0,0,0), Point3D(1,0,0), Point3D(0,1,0),
+                        Point3D(1,1,0), Point3D(0.5,0.5,0)})
+                       .Faces()
+                       .empty());
+    assert(true == Polyhedron::ConvexHullFromPoints({}).Faces().empty());
+    assert(false == Polyhedron().IsConvex());
+
+    // Reversing a face turns the other vertices to its right side
+    std::vector<std::vector<size_t>> reversed = triangles;
+    std::reverse(reversed[0].begin(), reversed[0].end());
+    assert(false == Polyhedron(poly_.Vertices(), reversed).IsConvex());
+  }
+
   { // Shrink
     const Polyhedron original_poly = poly_;
     const Polyhedron expanded_poly = original_poly.Shrink(0.2);
@@ -233,6 +493,35 @@ void test_Polygon() {
 
     assert(true  == poly.Contains(interior_point));
     assert(false == poly.Contains(exterior_point));
+
+    // Counter-clockwise from the lowest left-most point, without the points
+    // along the edges or inside
+    poly.ConvexHullFromPoints({c, Point2D(0.5,0), d, Point2D(0.5,0.5), a, b,
+                               Point2D(0,0.5), d});
+    const std::vector<Point2D> expected = {a, b, c, d};
+    assert(expected == poly.Vertices());
+    assert(true == poly.IsConvex());
+  }
+
+  { // Construct from many points
+    std::mt19937 generator(0);
+    std::normal_distribution<double> normal(0.0, 1.0);
+    std::vector<Point2D> points;
+    for (size_t idx = 0; idx < 10000; ++idx) {
+      points.push_back(Point2D(normal(generator), normal(generator)));
+    }
+
+    Polygon poly;
+    poly.ConvexHullFromPoints(points);
+    assert(true == poly.IsConvex());
+    for (const Line2D& edge : poly.Edges()) {
+      for (const Point2D& point : points) {
+        assert(true == edge.OnLeftSide(point));
+      }
+    }
+    for (const Point2D& vertex : poly.Vertices()) {
+      assert(vertex.x() >= poly.Vertices()[0].x());
+    }
   }
 
   { // Read from file
@@ -366,12 +655,56 @@ void test_Line3D() {
   }
 }
 
+void test_AabbTree() {
+  { // Empty tree
+    const AabbTree tree;
+    size_t visited = 0;
+    assert(true == tree.Query(AabbTree::Box(Eigen::Vector3d(0,0,0), Eigen::Vector3d(1,1,1)),
+                              [&](const size_t) { visited++; return true; }));
+    assert(0 == visited);
+  }
+
+  { // Queries match a brute force search
+    std::vector<AabbTree::Box> boxes;
+    for (size_t idx = 0; idx < 200; ++idx) {
+      const Eigen::Vector3d min = 10 * Eigen::Vector3d::Random();
+      boxes.emplace_back(min, min + Eigen::Vector3d::Random().cwiseAbs());
+    }
+    const AabbTree tree(boxes);
+    assert(200 == tree.Size());
+
+    for (size_t query = 0; query < 200; ++query) {
+      const Eigen::Vector3d point = 10 * Eigen::Vector3d::Random();
+      const AabbTree::Box region(point, point + Eigen::Vector3d::Constant(0.5 * (query % 3)));
+
+      std::vector<bool> found(boxes.size(), false);
+      tree.Query(region, [&](const size_t idx) {
+        assert(false == found[idx]);
+        found[idx] = true;
+        return true;
+      });
+      for (size_t idx = 0; idx < boxes.size(); ++idx) {
+        assert(found[idx] == boxes[idx].intersects(region));
+      }
+    }
+  }
+
+  { // Queries stop when the visitor returns false
+    const std::vector<AabbTree::Box> boxes(10, AabbTree::Box(Eigen::Vector3d(0,0,0), Eigen::Vector3d(1,1,1)));
+    const AabbTree tree(boxes);
+    size_t visited = 0;
+    assert(false == tree.Query(boxes[0], [&](const size_t) { visited++; return false; }));
+    assert(1 == visited);
+  }
+}
+
 int main(int argc, char** argv) {
   // test_Line2D();
   // test_Line3D();
-  // test_Polygon();
+  test_Polygon();
   test_Plane3D();
   test_Polyhedron();
+  test_AabbTree();
 
   std::cout << "All tests passed!" << std::endl;
   return EXIT_SUCCESS;
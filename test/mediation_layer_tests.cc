@@ -1,12 +1,26 @@
+#include <atomic>
+#include <chrono>
+#include <cmath>
 #include <cstdlib>
+#include <functional>
 #include <iostream>
+#include <thread>
 #include <Eigen/StdVector>
 
 #undef NDEBUG
 #include <cassert>
 
+#include "keyed_event_queue.h"
+#include "listener_list.h"
+#include "periodic_scheduler.h"
 #include "trajectory.h"
+#include "trajectory_vetter.h"
+#include "trajectory_watchdog.h"
 #include "quad_state.h"
+#include "quad_state_watchdog_status.h"
+#include "seqlock.h"
+#include "stop_token.h"
+#include "test_shapes.h"
 #include "warden.h"
 
 using namespace game_engine;
@@ -35,6 +49,369 @@ void test_TrajectoryWarden() {
     assert(trajectory_read.Size() == trajectory_write.Size());
     assert(trajectory_read.PVAYT(0).isApprox(trajectory_write.PVAYT(0)));
   }
+
+  { // Test snapshots are immutable across writes
+    TrajectoryWardenSubscriber warden;
+
+    Trajectory trajectory_write({(Eigen::Matrix<double, 11, 1>() << 1,1,1,1,1,1,1,1,1,1,1).finished()});
+    assert(MediationLayerCode::Success == warden.Register("test"));
+    assert(MediationLayerCode::Success == warden.Write("test", trajectory_write));
+
+    std::shared_ptr<const Trajectory> snapshot;
+    assert(MediationLayerCode::Success == warden.Snapshot("test", snapshot));
+    assert(MediationLayerCode::Success == warden.Write("test", Trajectory()));
+    assert(1 == snapshot->Size());
+    assert(snapshot->PVAYT(0).isApprox(trajectory_write.PVAYT(0)));
+
+    std::shared_ptr<const Trajectory> latest;
+    assert(MediationLayerCode::Success == warden.Snapshot("test", latest));
+    assert(0 == latest->Size());
+    assert(MediationLayerCode::KeyDoesNotExist == warden.Snapshot("missing", latest));
+  }
+}
+
+void test_TrajectoryWardenServer() {
+  { // Writer sleeps until the verdict is handed off
+    TrajectoryWardenServer warden;
+    assert(MediationLayerCode::Success == warden.Register("test"));
+
+    std::thread mediation_layer([&]() {
+      Trajectory trajectory;
+      uint64_t version;
+      assert(MediationLayerCode::Success ==
+             warden.Await("test", trajectory, version));
+      TrajectoryCode verdict;
+      verdict.code = MediationLayerCode::ExceedsMaxVelocity;
+      verdict.index = 3;
+      warden.SetTrajectoryStatus("test", version, verdict);
+    });
+
+    const TrajectoryCode status = warden.Write("test", Trajectory());
+    mediation_layer.join();
+    assert(MediationLayerCode::ExceedsMaxVelocity == status.code);
+    assert(3 == status.index);
+  }
+
+  { // Verdicts issued before a submission do not answer it
+    TrajectoryWardenServer::Options options;
+    options.status_timeout = std::chrono::milliseconds(10);
+    TrajectoryWardenServer warden(options);
+    assert(MediationLayerCode::Success == warden.Register("test"));
+
+    warden.SetTrajectoryStatus("test", 2, TrajectoryCode());
+    const TrajectoryCode status = warden.Write("test", Trajectory());
+    assert(MediationLayerCode::TrajectoryStatusTimeout == status.code);
+  }
+
+  { // Overlapping submissions are each answered for their own trajectory
+    TrajectoryWardenServer warden;
+    assert(MediationLayerCode::Success == warden.Register("test"));
+    const auto await_version = [&](const uint64_t expected) {
+      uint64_t version = 0;
+      std::shared_ptr<const Trajectory> latest;
+      while (expected != version) {
+        version = 0;
+        warden.SnapshotIfNewer("test", version, latest);
+        std::this_thread::yield();
+      }
+    };
+
+    TrajectoryCode older_status, newer_status;
+    std::thread older([&]() {
+      older_status = warden.Write("test", Trajectory());
+    });
+    await_version(2);
+    std::thread newer([&]() {
+      newer_status = warden.Write("test", Trajectory());
+    });
+    await_version(3);
+
+    // Only the newer trajectory is read, so the older one is superseded
+    Trajectory trajectory;
+    uint64_t version;
+    assert(MediationLayerCode::Success ==
+           warden.Await("test", trajectory, version));
+    assert(3 == version);
+    TrajectoryCode verdict;
+    verdict.code = MediationLayerCode::ExceedsMaxAcceleration;
+    warden.SetTrajectoryStatus("test", version, verdict);
+
+    older.join();
+    newer.join();
+    assert(MediationLayerCode::TrajectorySuperseded == older_status.code);
+    assert(MediationLayerCode::ExceedsMaxAcceleration == newer_status.code);
+  }
+
+  { // A late verdict does not answer the next submission
+    TrajectoryWardenServer::Options options;
+    options.status_timeout = std::chrono::milliseconds(500);
+    TrajectoryWardenServer warden(options);
+    assert(MediationLayerCode::Success == warden.Register("test"));
+
+    Trajectory trajectory;
+    uint64_t timed_out_version;
+    std::thread mediation_layer([&]() {
+      warden.Await("test", trajectory, timed_out_version);
+    });
+    assert(MediationLayerCode::TrajectoryStatusTimeout ==
+           warden.Write("test", Trajectory()).code);
+    mediation_layer.join();
+
+    TrajectoryCode status;
+    std::thread writer([&]() { status = warden.Write("test", Trajectory()); });
+    uint64_t version;
+    assert(MediationLayerCode::Success ==
+           warden.Await("test", trajectory, version));
+    assert(timed_out_version < version);
+
+    TrajectoryCode late;
+    late.code = MediationLayerCode::ExceedsMaxVelocity;
+    warden.SetTrajectoryStatus("test", timed_out_version, late);
+    warden.SetTrajectoryStatus("test", version, TrajectoryCode());
+    writer.join();
+    assert(MediationLayerCode::Success == status.code);
+  }
+
+  { // Unregistered keys
+    TrajectoryWardenServer warden;
+    assert(MediationLayerCode::KeyDoesNotExist == warden.Write("test", Trajectory()).code);
+  }
+}
+
+void test_KeyedEventQueue() {
+  { // Notifications are coalesced while a key is held
+    KeyedEventQueue<std::string> events;
+    events.Notify("a");
+    events.Notify("b");
+    events.Notify("a");
+
+    std::string key;
+    assert(true == events.Acquire(key) && "a" == key);
+    events.Notify("a");
+    assert(true == events.Acquire(key) && "b" == key);
+    events.Release("b");
+    events.Release("a");
+    assert(true == events.Acquire(key) && "a" == key);
+    events.Release("a");
+  }
+
+  { // Timers wake a waiting worker and Stop() releases it
+    KeyedEventQueue<std::string> events;
+    events.NotifyAt("timer", KeyedEventQueue<std::string>::Clock::now() +
+                                 std::chrono::milliseconds(5));
+
+    std::string key;
+    assert(true == events.Acquire(key) && "timer" == key);
+    events.Release(key);
+
+    std::thread stopper([&]() { events.Stop(); });
+    assert(false == events.Acquire(key));
+    stopper.join();
+
+    // A reset queue drops stale events and can be used again
+    events.Notify("stale");
+    events.Reset();
+    events.Notify("fresh");
+    assert(true == events.Acquire(key) && "fresh" == key);
+    events.Release(key);
+  }
+}
+
+void test_StopToken() {
+  { // Default tokens never stop
+    StopToken token;
+    assert(false == token.StopRequested());
+    assert(false == token.WaitFor(std::chrono::milliseconds(1)));
+  }
+
+  { // Stop wakes a sleeping waiter immediately
+    StopSource source;
+    const StopToken token = source.Token();
+    assert(false == token.WaitFor(std::chrono::milliseconds(1)));
+
+    const auto start = std::chrono::steady_clock::now();
+    std::thread waiter([&]() {
+      assert(true == token.WaitFor(std::chrono::seconds(10)));
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    source.RequestStop();
+    waiter.join();
+    assert(std::chrono::steady_clock::now() - start < std::chrono::seconds(5));
+    assert(true == token.StopRequested());
+    assert(true == source.StopRequested());
+
+    // A reset source hands out fresh tokens; old tokens remain stopped
+    source.Reset();
+    assert(false == source.StopRequested());
+    assert(false == source.Token().StopRequested());
+    assert(true == token.StopRequested());
+  }
+
+  { // Callbacks run on stop, or immediately if already stopped
+    StopSource source;
+    int calls = 0;
+    {
+      StopCallback callback(source.Token(), [&]() { calls++; });
+      assert(0 == calls);
+      source.RequestStop();
+      assert(1 == calls);
+      source.RequestStop();
+      assert(1 == calls);
+
+      StopCallback late(source.Token(), [&]() { calls++; });
+      assert(2 == calls);
+    }
+
+    // Destroyed callbacks are not invoked
+    source.Reset();
+    { StopCallback callback(source.Token(), [&]() { calls++; }); }
+    source.RequestStop();
+    assert(2 == calls);
+  }
+}
+
+void test_PeriodicScheduler() {
+  { // Tasks run at their own rates until stopped
+    PeriodicScheduler scheduler;
+    std::atomic<int> fast_runs{0};
+    std::atomic<int> slow_runs{0};
+    scheduler.AddTask("fast", std::chrono::milliseconds(5),
+                      [&]() { fast_runs++; });
+    scheduler.AddTask("slow", std::chrono::milliseconds(50),
+                      [&]() { slow_runs++; });
+
+    std::thread runner([&]() { scheduler.Run(); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(120));
+    scheduler.Stop();
+    runner.join();
+
+    assert(fast_runs > slow_runs);
+    assert(1 <= slow_runs);
+
+    const std::vector<PeriodicScheduler::TaskStats> stats = scheduler.Stats();
+    assert(2 == stats.size());
+    assert("fast" == stats[0].name);
+    assert(fast_runs == stats[0].runs);
+    assert(slow_runs == stats[1].runs);
+  }
+
+  { // Overruns are counted as missed deadlines rather than run back to back
+    PeriodicScheduler::Options options;
+    options.worker_threads = 1;
+    PeriodicScheduler scheduler(options);
+    scheduler.AddTask("overrun", std::chrono::milliseconds(2), []() {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    });
+
+    std::thread runner([&]() { scheduler.Run(); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    scheduler.Stop();
+    runner.join();
+
+    const PeriodicScheduler::TaskStats stats = scheduler.Stats()[0];
+    assert(1 <= stats.runs);
+    assert(stats.runs <= stats.deadline_misses);
+    assert(std::chrono::milliseconds(10) <= stats.max_execution_time);
+  }
+
+  { // A stop token wakes Run() immediately, and Run() may be called again
+    PeriodicScheduler scheduler;
+    std::atomic<int> runs{0};
+    scheduler.AddTask("hourly", std::chrono::hours(1), [&]() { runs++; });
+
+    StopSource source;
+    const auto start = std::chrono::steady_clock::now();
+    std::thread runner([&]() { scheduler.Run(source.Token()); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    source.RequestStop();
+    runner.join();
+    assert(std::chrono::steady_clock::now() - start < std::chrono::seconds(5));
+    assert(1 == runs);
+
+    // The task is not due again for an hour
+    source.Reset();
+    std::thread rerunner([&]() { scheduler.Run(source.Token()); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    source.RequestStop();
+    rerunner.join();
+    assert(1 == runs);
+  }
+}
+
+void test_SeqLock() {
+  { // Values round trip and Exchange returns the previous value
+    TrajectoryCode code;
+    code.index = 1;
+    SeqLock<TrajectoryCode> lock(code);
+    assert(1 == lock.Load().index);
+
+    code.index = 2;
+    assert(1 == lock.Exchange(code).index);
+    assert(2 == lock.Load().index);
+  }
+
+  { // Concurrent readers never observe a torn value
+    SeqLock<TrajectoryCode> lock;
+    std::atomic<bool> done{false};
+    std::vector<std::thread> writers;
+    for (int writer = 0; writer < 2; ++writer) {
+      writers.emplace_back([&]() {
+        for (int idx = 0; idx < 20000; ++idx) {
+          TrajectoryCode code;
+          code.index = idx;
+          code.value = idx;
+          lock.Store(code);
+        }
+      });
+    }
+
+    std::thread reader([&]() {
+      while (false == done) {
+        const TrajectoryCode code = lock.Load();
+        assert(code.index == static_cast<int>(code.value));
+      }
+    });
+
+    for (std::thread& writer : writers) {
+      writer.join();
+    }
+    done = true;
+    reader.join();
+  }
+}
+
+void test_ListenerList() {
+  { // Removed listeners are no longer notified
+    ListenerList listeners;
+    size_t first = 0, second = 0;
+    const ListenerList::Handle handle =
+        listeners.Add([&](const QuadId) { first++; });
+    listeners.Add([&](const QuadId) { second++; });
+    listeners.Notify(0);
+    listeners.Remove(handle);
+    listeners.Notify(0);
+    assert(1 == first);
+    assert(2 == second);
+  }
+
+  { // Listeners come and go while another thread notifies
+    ListenerList listeners;
+    std::atomic<size_t> notifications{0};
+    listeners.Add([&](const QuadId) { notifications++; });
+
+    std::atomic<bool> done{false};
+    std::thread writer([&]() {
+      for (int idx = 0; idx < 20000; ++idx) {
+        listeners.Notify(0);
+      }
+      done = true;
+    });
+    while (false == done) {
+      listeners.Remove(listeners.Add([](const QuadId) {}));
+    }
+    writer.join();
+    assert(20000 == notifications);
+  }
 }
 
 void test_Trajectory() {
@@ -56,6 +433,45 @@ void test_Trajectory() {
     assert(((Eigen::Matrix<double, 9, 1>() << 1,1,1,2,2,2,3,3,3).finished()).isApprox(trajectory.PVA(0)));
     assert(((Eigen::Matrix<double, 11, 1>() << 1,1,1,2,2,2,3,3,3,0.1,0.2).finished()).isApprox(trajectory.PVAYT(0)));
   }
+
+  { // Test copies share the buffer
+    TrajectoryBuilder builder;
+    builder.PushBack((Eigen::Matrix<double, 11, 1>() << 1,1,1,2,2,2,3,3,3,0.1,0.2).finished());
+    builder.PushBack((Eigen::Matrix<double, 11, 1>() << 4,4,4,5,5,5,6,6,6,0.3,0.4).finished());
+    assert(2 == builder.Size());
+
+    const Trajectory trajectory = builder.Build();
+    assert(0 == builder.Size());
+    assert(2 == trajectory.Size());
+
+    const Trajectory copy = trajectory;
+    assert(&copy.Data() == &trajectory.Data());
+    assert(Eigen::Vector3d(4,4,4).isApprox(copy.Position(1)));
+  }
+
+  { // Test pooled buffers are recycled once released
+    TrajectoryPool pool;
+    const TrajectoryVector3D* first_buffer;
+    {
+      TrajectoryBuilder builder = pool.Builder();
+      builder.PushBack((Eigen::Matrix<double, 11, 1>() << 1,1,1,2,2,2,3,3,3,0.1,0.2).finished());
+      const Trajectory trajectory = builder.Build();
+      first_buffer = &trajectory.Data();
+
+      // Still in use, so a different buffer is handed out
+      TrajectoryBuilder other = pool.Builder();
+      other.PushBack((Eigen::Matrix<double, 11, 1>() << 1,1,1,2,2,2,3,3,3,0.1,0.2).finished());
+      assert(&other.Build().Data() != first_buffer);
+    }
+
+    TrajectoryBuilder builder = pool.Builder();
+    assert(0 == builder.Size());
+    builder.PushBack((Eigen::Matrix<double, 11, 1>() << 7,7,7,0,0,0,0,0,0,0,1).finished());
+    const Trajectory trajectory = builder.Build();
+    assert(&trajectory.Data() == first_buffer);
+    assert(1 == trajectory.Size());
+    assert(Eigen::Vector3d(7,7,7).isApprox(trajectory.Position(0)));
+  }
 }
 
 void test_QuadState() {
@@ -94,13 +510,490 @@ void test_QuadStateWarden() {
     assert(state_read.Orientation().isApprox(state_write.Orientation()));
     assert(state_read.Twist().isApprox(state_write.Twist()));
   }
+
+  { // Test QuadId handles
+    QuadStateWarden warden;
+
+    QuadState state_write({(Eigen::Matrix<double, 13, 1>() << 1,2,3,0,0,0,1,0,0,0,0,0,0).finished()});
+    assert(MediationLayerCode::Success == warden.Register("a"));
+    assert(MediationLayerCode::Success == warden.Register("b"));
+
+    QuadId a, b;
+    assert(MediationLayerCode::Success == warden.Id("a", a));
+    assert(MediationLayerCode::Success == warden.Id("b", b));
+    assert(0 == a);
+    assert(1 == b);
+    assert(MediationLayerCode::KeyDoesNotExist == warden.Id("c", a));
+
+    // Id and name overloads refer to the same entry
+    assert(MediationLayerCode::Success == warden.Write(b, state_write));
+    QuadState state_read;
+    assert(MediationLayerCode::Success == warden.Read("b", state_read));
+    assert(state_read.Position().isApprox(state_write.Position()));
+    assert(MediationLayerCode::KeyDoesNotExist == warden.Read(2, state_read));
+  }
+
+  { // Test versioned reads
+    QuadStateWarden warden;
+    assert(MediationLayerCode::Success == warden.Register("test"));
+
+    // Version 0 always reads the initial value
+    uint64_t version = 0;
+    QuadState state_read;
+    assert(MediationLayerCode::Success == warden.ReadIfNewer("test", version, state_read));
+    assert(0 != version);
+    assert(MediationLayerCode::NotModified == warden.ReadIfNewer("test", version, state_read));
+
+    QuadState state_write({(Eigen::Matrix<double, 13, 1>() << 4,5,6,0,0,0,1,0,0,0,0,0,0).finished()});
+    assert(MediationLayerCode::Success == warden.Write("test", state_write));
+
+    const uint64_t last_version = version;
+    std::shared_ptr<const QuadState> snapshot;
+    assert(MediationLayerCode::Success == warden.SnapshotIfNewer("test", version, snapshot));
+    assert(last_version < version);
+    assert(snapshot->Position().isApprox(state_write.Position()));
+    assert(MediationLayerCode::NotModified == warden.SnapshotIfNewer("test", version, snapshot));
+
+    uint64_t unused = 0;
+    assert(MediationLayerCode::KeyDoesNotExist == warden.ReadIfNewer("missing", unused, state_read));
+  }
+}
+
+void test_QuadStateWatchdogStatus() {
+  QuadStateWatchdogStatus status;
+  status.Register("a");
+  status.Register("b");
+
+  QuadId b;
+  assert(true == status.Id("b", b));
+  assert(false == status.Id("c", b));
+  assert(1 == b);
+
+  size_t notifications = 0;
+  status.AddListener([&](const QuadId id) {
+    assert(1 == id);
+    notifications++;
+  });
+
+  status.Write(b, MediationLayerCode::QuadTooCloseToAnotherQuad);
+  status.Write("b", MediationLayerCode::QuadTooCloseToAnotherQuad);
+  assert(1 == notifications);
+  assert(MediationLayerCode::QuadTooCloseToAnotherQuad == status.Read("b").code);
+
+  status.SetExecution(b, true);
+  assert(true == status.ReadExecution("b"));
+  assert(false == status.ReadExecution("a"));
+}
+
+// Straight flight from start to end between times t0 and tf, sampled every
+// 0.1 seconds
+std::shared_ptr<const Trajectory> Flight(const Eigen::Vector3d& start,
+                                         const Eigen::Vector3d& end,
+                                         const double t0, const double tf) {
+  const size_t num_samples = static_cast<size_t>(std::round((tf - t0) / 0.1)) + 1;
+  TrajectoryVector3D data;
+  for (size_t idx = 0; idx < num_samples; ++idx) {
+    const double alpha = static_cast<double>(idx) / (num_samples - 1);
+    Eigen::Matrix<double, 11, 1> sample;
+    sample << start + alpha * (end - start), Eigen::Vector3d::Zero(),
+        Eigen::Vector3d::Zero(), 0, t0 + alpha * (tf - t0);
+    data.push_back(sample);
+  }
+  return std::make_shared<const Trajectory>(std::move(data));
+}
+
+void test_TrajectoryCollisionPredictor() {
+  const double lookahead = 5.0;
+  const double collision_distance = 0.4;
+  std::vector<TrajectoryCode> collisions;
+
+  { // Crossing paths collide where they cross
+    TrajectoryCollisionPredictor predictor(lookahead, collision_distance, 2);
+    const auto a = Flight(Eigen::Vector3d(-2,0,1), Eigen::Vector3d(2,0,1), 100, 104);
+    const auto b = Flight(Eigen::Vector3d(0,-2,1), Eigen::Vector3d(0,2,1), 100, 104);
+    predictor.SetTrajectory(0, a);
+    predictor.SetTrajectory(1, b);
+    predictor.Predict(100, collisions);
+    assert(MediationLayerCode::QuadTrajectoryCollidesWithAnotherQuad == collisions[0].code);
+    assert(MediationLayerCode::QuadTrajectoryCollidesWithAnotherQuad == collisions[1].code);
+    assert(collisions[0].value < collision_distance);
+    assert(101.7 < a->Time(collisions[0].index) + 1e-9);
+    assert(a->Time(collisions[0].index) <= 102);
+  }
+
+  { // Paths that cross at different times do not collide
+    TrajectoryCollisionPredictor predictor(lookahead, collision_distance, 2);
+    predictor.SetTrajectory(0, Flight(Eigen::Vector3d(-2,0,1), Eigen::Vector3d(2,0,1), 100, 104));
+    predictor.SetTrajectory(1, Flight(Eigen::Vector3d(0,-2,1), Eigen::Vector3d(0,2,1), 102, 106));
+    predictor.Predict(100, collisions);
+    assert(MediationLayerCode::Success == collisions[0].code);
+    assert(MediationLayerCode::Success == collisions[1].code);
+  }
+
+  { // The broad phase rejects pairs separated along one axis
+    TrajectoryCollisionPredictor predictor(lookahead, collision_distance, 2);
+    predictor.SetTrajectory(0, Flight(Eigen::Vector3d(-2,0,1), Eigen::Vector3d(2,0,1), 100, 104));
+    predictor.SetTrajectory(1, Flight(Eigen::Vector3d(-2,0,1.5), Eigen::Vector3d(2,0,1.5), 100, 104));
+    predictor.Predict(100, collisions);
+    assert(MediationLayerCode::Success == collisions[0].code);
+    assert(MediationLayerCode::Success == collisions[1].code);
+
+    // But not pairs that are closer along every axis
+    predictor.SetTrajectory(1, Flight(Eigen::Vector3d(-2,0,1.39), Eigen::Vector3d(2,0,1.39), 100, 104));
+    predictor.Predict(100, collisions);
+    assert(MediationLayerCode::QuadTrajectoryCollidesWithAnotherQuad == collisions[0].code);
+    assert(0 == collisions[0].index);
+
+    // Pairs that pass the broad phase are still compared by distance
+    predictor.SetTrajectory(1, Flight(Eigen::Vector3d(-2,0.3,1.3), Eigen::Vector3d(2,0.3,1.3), 100, 104));
+    predictor.Predict(100, collisions);
+    assert(MediationLayerCode::Success == collisions[0].code);
+  }
+
+  { // A trajectory that has ended holds its final position
+    TrajectoryCollisionPredictor predictor(lookahead, collision_distance, 2);
+    predictor.SetTrajectory(0, Flight(Eigen::Vector3d(0,0,0), Eigen::Vector3d(0,0,1), 90, 91));
+    predictor.SetTrajectory(1, Flight(Eigen::Vector3d(0,-2,1), Eigen::Vector3d(0,2,1), 100, 104));
+    predictor.Predict(100, collisions);
+    assert(MediationLayerCode::QuadTrajectoryCollidesWithAnotherQuad == collisions[0].code);
+    assert(10 == collisions[0].index);
+    assert(MediationLayerCode::QuadTrajectoryCollidesWithAnotherQuad == collisions[1].code);
+  }
+
+  { // A new trajectory is searched from its first sample
+    TrajectoryCollisionPredictor predictor(lookahead, collision_distance, 2);
+    predictor.SetTrajectory(0, Flight(Eigen::Vector3d(10,0,1), Eigen::Vector3d(10,1,1), 100, 110));
+    predictor.SetTrajectory(1, Flight(Eigen::Vector3d(0,0,1), Eigen::Vector3d(0,0,1), 100, 120));
+    predictor.Predict(100, collisions);
+    predictor.Predict(105, collisions);
+    assert(MediationLayerCode::Success == collisions[0].code);
+
+    // The new trajectory is shorter than the window of the old one had
+    // advanced, and crosses the hovering quad after a second
+    const auto crossing = Flight(Eigen::Vector3d(-1,0,1), Eigen::Vector3d(1,0,1), 105, 107);
+    predictor.SetTrajectory(0, crossing);
+    predictor.Predict(105, collisions);
+    assert(MediationLayerCode::QuadTrajectoryCollidesWithAnotherQuad == collisions[0].code);
+    assert(crossing->Time(collisions[0].index) < 106);
+  }
+}
+
+void test_TrajectoryVetter() {
+  const Map3D map(Box(Point3D(0, 0, 0), Point3D(10, 10, 10)),
+                  {Box(Point3D(4, 4, 0), Point3D(6, 6, 10))});
+
+  auto quad_state_warden = std::make_shared<QuadStateWarden>();
+  quad_state_warden->Register("quad");
+  Eigen::Matrix<double, 13, 1> state = Eigen::Matrix<double, 13, 1>::Zero();
+  state.head<3>() << 1, 2, 2;
+  state(6) = 1;
+  quad_state_warden->Write("quad", QuadState(state));
+
+  // Fly along x at 1 m/s, sampled at 100 Hz
+  TrajectoryVector3D flight;
+  for (size_t idx = 0; idx < 100; ++idx) {
+    flight.push_back((Eigen::Matrix<double, 11, 1>() << 1 + 0.01 * idx, 2, 2,
+                      1, 0, 0, 0, 0, 0, 0, 0.01 * idx)
+                         .finished());
+  }
+
+  // Hover in place, sampled at 100 Hz
+  TrajectoryVector3D hover;
+  for (size_t idx = 0; idx < 100; ++idx) {
+    hover.push_back((Eigen::Matrix<double, 11, 1>() << 1, 2, 2, 0, 0, 0, 0, 0,
+                     0, 0, 0.01 * idx)
+                        .finished());
+  }
+
+  { // Inflated maps are built once and shared by copies of the map
+    const Map3D copy = map;
+    const std::shared_ptr<const Map3D> inflated = map.Inflated(0.5);
+    assert(inflated == copy.Inflated(0.5));
+    assert(inflated != map.Inflated(0.25));
+    assert(false == inflated->IsFreeSpace(Point3D(3.75, 5, 5)));
+    assert(true == map.IsFreeSpace(Point3D(3.75, 5, 5)));
+  }
+
+  const TrajectoryVetter vetter(0);
+
+  { // Valid trajectory
+    const TrajectoryCode code =
+        vetter.Vet(Trajectory(flight), map, quad_state_warden, "quad");
+    assert(MediationLayerCode::Success == code.code);
+  }
+
+  { // Earlier constraints are reported first, at their first violation
+    TrajectoryVector3D samples = flight;
+    samples[10](6) = 1.0;  // Acceleration
+    samples[50](3) = 3.0;  // Velocity
+    samples[60](3) = 4.0;  // Velocity
+    TrajectoryCode code =
+        vetter.Vet(Trajectory(samples), map, quad_state_warden, "quad");
+    assert(MediationLayerCode::ExceedsMaxVelocity == code.code);
+    assert(50 == code.index);
+    assert(3.0 == code.value);
+
+    samples[80].head<3>() << 5, 5, 2;  // Inside the obstacle
+    code = vetter.Vet(Trajectory(samples), map, quad_state_warden, "quad");
+    assert(MediationLayerCode::PointWithinObstacle == code.code);
+    assert(80 == code.index);
+
+    samples[90].head<3>() << 20, 2, 2;  // Outside the map
+    code = vetter.Vet(Trajectory(samples), map, quad_state_warden, "quad");
+    assert(MediationLayerCode::PointWithinObstacle == code.code);
+    assert(80 == code.index);
+  }
+
+  { // Segments that cross an obstacle between free samples
+    TrajectoryVector3D samples;
+    samples.push_back((Eigen::Matrix<double, 11, 1>() << 1, 2, 2, 0, 0, 0, 0, 0, 0, 0, 0).finished());
+    samples.push_back((Eigen::Matrix<double, 11, 1>() << 3, 5, 2, 0, 0, 0, 0, 0, 0, 0, 0.01).finished());
+    samples.push_back((Eigen::Matrix<double, 11, 1>() << 7, 5, 2, 0, 0, 0, 0, 0, 0, 0, 0.02).finished());
+    TrajectoryCode code =
+        vetter.Vet(Trajectory(samples), map, quad_state_warden, "quad");
+    assert(MediationLayerCode::SegmentIntersectsObstacle == code.code);
+    assert(1 == code.index);
+
+    TrajectoryVetter::Options options;
+    options.check_segments = false;
+    const TrajectoryVetter sample_vetter(0, options);
+    code = sample_vetter.Vet(Trajectory(samples), map, quad_state_warden, "quad");
+    assert(MediationLayerCode::MeanValueExceedsMaxVelocity == code.code);
+  }
+
+  { // Mean value acceleration
+    TrajectoryVector3D samples = hover;
+    samples[40](3) = 1.0;
+    const TrajectoryCode code =
+        vetter.Vet(Trajectory(samples), map, quad_state_warden, "quad");
+    assert(MediationLayerCode::MeanValueExceedsMaxAcceleration == code.code);
+    assert(39 == code.index);
+  }
+
+  { // Timestamps
+    TrajectoryVector3D samples = hover;
+    samples[30](10) += 0.05;
+    samples[21](10) = samples[20](10) - 0.005;
+    const TrajectoryCode code =
+        vetter.Vet(Trajectory(samples), map, quad_state_warden, "quad");
+    assert(MediationLayerCode::TimestampsNotIncreasing == code.code);
+    assert(20 == code.index);
+  }
+
+  { // Start point
+    TrajectoryVector3D samples = hover;
+    for (auto& sample : samples) {
+      sample(0) += 2.0;
+    }
+    const TrajectoryCode code =
+        vetter.Vet(Trajectory(samples), map, quad_state_warden, "quad");
+    assert(MediationLayerCode::StartPointFarFromCurrentPosition == code.code);
+  }
+
+  { // Batches give the same codes as vetting one by one, in order
+    std::vector<Trajectory> candidates;
+    for (size_t idx = 0; idx < 20; ++idx) {
+      TrajectoryVector3D samples = (0 == idx % 2) ? flight : hover;
+      if (0 == idx % 3) {
+        samples[5 * idx](3) = 3.0;
+      }
+      if (0 == idx % 5) {
+        samples[4 * idx].head<3>() << 5, 5, 2;
+      }
+      candidates.push_back(Trajectory(samples));
+    }
+    candidates.push_back(Trajectory());
+
+    for (const size_t batch_threads : {1, 3, 64}) {
+      TrajectoryVetter::Options options;
+      options.batch_threads = batch_threads;
+      const TrajectoryVetter batch_vetter(0, options);
+      const std::vector<TrajectoryCode> codes =
+          batch_vetter.VetBatch(candidates, map, quad_state_warden, "quad");
+      assert(candidates.size() == codes.size());
+      for (size_t idx = 0; idx < candidates.size(); ++idx) {
+        const TrajectoryCode code =
+            vetter.Vet(candidates[idx], map, quad_state_warden, "quad");
+        assert(code.code == codes[idx].code);
+        assert(code.index == codes[idx].index);
+        assert(code.value == codes[idx].value);
+      }
+    }
+
+    assert(true == vetter.VetBatch({}, map, quad_state_warden, "quad").empty());
+  }
+
+  { // Longest prefixes that pass vetting
+    assert(100 == vetter.SafePrefix(Trajectory(flight), map, quad_state_warden, "quad"));
+
+    TrajectoryVector3D samples = flight;
+    samples[80].head<3>() << 5, 5, 2;
+    assert(80 == vetter.SafePrefix(Trajectory(samples), map, quad_state_warden, "quad"));
+
+    // Earlier violations of lower priority constraints are found as well
+    samples[50](3) = 3.0;
+    samples[60](10) = samples[59](10);
+    samples[61](10) = samples[59](10) - 0.001;
+    assert(50 == vetter.SafePrefix(Trajectory(samples), map, quad_state_warden, "quad"));
+    samples[50](3) = 1.0;
+    assert(61 == vetter.SafePrefix(Trajectory(samples), map, quad_state_warden, "quad"));
+
+    samples = flight;
+    samples[1](0) = 3.0;
+    assert(0 == vetter.SafePrefix(Trajectory(samples), map, quad_state_warden, "quad"));
+    for (auto& sample : samples) {
+      sample(0) += 2.0;
+    }
+    assert(0 == vetter.SafePrefix(Trajectory(samples), map, quad_state_warden, "quad"));
+  }
+
+  { // Reports of every violation
+    VettingReport report =
+        vetter.VetAll(Trajectory(flight), map, quad_state_warden, "quad");
+    assert(MediationLayerCode::Success == report.code.code);
+    assert(true == report.violations.empty());
+
+    TrajectoryVector3D samples = flight;
+    samples[10](6) = 1.0;               // Acceleration
+    samples[50](3) = 3.0;               // Velocity
+    samples[60](3) = 4.0;               // Velocity
+    samples[80].head<3>() << 5, 5, 2;   // Inside the obstacle
+    samples[90].head<3>() << 20, 2, 2;  // Outside the map
+    report = vetter.VetAll(Trajectory(samples), map, quad_state_warden, "quad");
+    const TrajectoryCode code =
+        vetter.Vet(Trajectory(samples), map, quad_state_warden, "quad");
+    assert(code.code == report.code.code);
+    assert(code.index == report.code.index);
+
+    std::vector<MediationLayerCode> codes;
+    for (const VettingReport::Violation& violation : report.violations) {
+      codes.push_back(violation.code);
+    }
+    assert((std::vector<MediationLayerCode>{
+               MediationLayerCode::PointExceedsMapBounds,
+               MediationLayerCode::PointWithinObstacle,
+               MediationLayerCode::SegmentIntersectsObstacle,
+               MediationLayerCode::ExceedsMaxVelocity,
+               MediationLayerCode::MeanValueExceedsMaxVelocity,
+               MediationLayerCode::ExceedsMaxAcceleration,
+               MediationLayerCode::MeanValueExceedsMaxAcceleration,
+           }) == codes);
+
+    const VettingReport::Violation& velocity = report.violations[3];
+    assert(50 == velocity.index);
+    assert(4.0 == velocity.worst_value);
+    assert(2 == velocity.count);
+
+    const VettingReport::Violation& acceleration = report.violations[5];
+    assert(10 == acceleration.index);
+    assert(1.0 == acceleration.worst_value);
+    assert(1 == acceleration.count);
+
+    // The segment leaving the obstacle
+    assert(80 == report.violations[2].index);
+
+    // Vet() and VetAll() agree on every kind of violation
+    const std::vector<std::function<void(TrajectoryVector3D&)>> faults = {
+        [](TrajectoryVector3D& s) { s[30].head<3>() << 20, 2, 2; },
+        [](TrajectoryVector3D& s) { s[30].head<3>() << 5, 5, 2; },
+        [](TrajectoryVector3D& s) { s[30](3) = 3.0; },
+        [](TrajectoryVector3D& s) { s[30](0) += 0.2; },
+        [](TrajectoryVector3D& s) { s[30](6) = 1.0; },
+        [](TrajectoryVector3D& s) { s[30](4) += 0.1; },
+        [](TrajectoryVector3D& s) { s[30](10) = s[29](10) - 0.001; },
+        [](TrajectoryVector3D& s) {
+          for (size_t idx = 30; idx < s.size(); ++idx) {
+            s[idx](10) += 0.1;
+          }
+        },
+    };
+    for (const auto& fault : faults) {
+      samples = flight;
+      fault(samples);
+      report = vetter.VetAll(Trajectory(samples), map, quad_state_warden, "quad");
+      const TrajectoryCode first =
+          vetter.Vet(Trajectory(samples), map, quad_state_warden, "quad");
+      assert(MediationLayerCode::Success != first.code);
+      assert(first.code == report.code.code);
+      assert(first.code == report.violations[0].code);
+      assert(first.index == report.violations[0].index);
+      assert(first.value == report.violations[0].worst_value ||
+             1 < report.violations[0].count);
+    }
+  }
+
+  { // Incremental vetting of trajectories that share a prefix
+    const Trajectory accepted(flight);
+    assert(100 == vetter.CommonPrefix(accepted, accepted));
+    assert(0 == vetter.CommonPrefix(accepted, Trajectory(hover)));
+    assert(0 == vetter.CommonPrefix(accepted, Trajectory()));
+
+    TrajectoryVector3D samples = flight;
+    samples.resize(70);
+    samples[60](0) += 1e-12;  // Within tolerance
+    assert(70 == vetter.CommonPrefix(accepted, Trajectory(samples)));
+    TrajectoryCode code = vetter.VetIncremental(Trajectory(samples), accepted,
+                                                map, quad_state_warden, "quad");
+    assert(MediationLayerCode::Success == code.code);
+
+    // Changes after the prefix are found as by a full vet
+    samples = flight;
+    samples[65](3) = 3.0;
+    samples[50](10) += 0.001;
+    samples[80].head<3>() << 5, 5, 2;
+    assert(50 == vetter.CommonPrefix(accepted, Trajectory(samples)));
+    code = vetter.VetIncremental(Trajectory(samples), accepted, map,
+                                 quad_state_warden, "quad");
+    assert(MediationLayerCode::PointWithinObstacle == code.code);
+    assert(80 == code.index);
+
+    // Pairs of samples that start at the last shared sample are checked
+    samples = flight;
+    samples[50](10) = samples[49](10);
+    samples[50](3) = 2.5;
+    code = vetter.VetIncremental(Trajectory(samples), accepted, map,
+                                 quad_state_warden, "quad");
+    assert(MediationLayerCode::ExceedsMaxVelocity == code.code);
+    assert(50 == code.index);
+    samples[50](3) = 1.0;
+    samples[49](10) = samples[48](10) - 0.001;
+    code = vetter.VetIncremental(Trajectory(samples), accepted, map,
+                                 quad_state_warden, "quad");
+    assert(MediationLayerCode::MeanValueExceedsMaxVelocity == code.code);
+    assert(48 == code.index);
+
+    // The shared prefix is not vetted again
+    samples = flight;
+    samples[10](3) = 3.0;
+    code = vetter.VetIncremental(Trajectory(samples), Trajectory(samples), map,
+                                 quad_state_warden, "quad");
+    assert(MediationLayerCode::Success == code.code);
+
+    // The start point is always checked
+    samples = flight;
+    for (auto& sample : samples) {
+      sample(0) += 2.0;
+    }
+    code = vetter.VetIncremental(Trajectory(samples), Trajectory(samples), map,
+                                 quad_state_warden, "quad");
+    assert(MediationLayerCode::StartPointFarFromCurrentPosition == code.code);
+  }
 }
 
 int main(int argc, char** argv) {
+  test_StopToken();
+  test_PeriodicScheduler();
+  test_SeqLock();
+  test_ListenerList();
   test_Trajectory();
   test_TrajectoryWarden();
+  test_TrajectoryWardenServer();
+  test_KeyedEventQueue();
   test_QuadState();
   test_QuadStateWarden();
+  test_QuadStateWatchdogStatus();
+  test_TrajectoryCollisionPredictor();
+  test_TrajectoryVetter();
 
   std::cout << "All tests passed!" << std::endl;
   return EXIT_SUCCESS;
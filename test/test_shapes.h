@@ -0,0 +1,24 @@
+#pragma once
+
+#include "polyhedron.h"
+#include "types.h"
+
+// Shapes shared by the tests
+
+// Axis-aligned box with outward-facing faces
+inline game_engine::Polyhedron Box(const Point3D& lo, const Point3D& hi) {
+  using game_engine::Line3D;
+  using game_engine::Plane3D;
+  const Point3D p000(lo.x(), lo.y(), lo.z()), p100(hi.x(), lo.y(), lo.z()),
+      p110(hi.x(), hi.y(), lo.z()), p010(lo.x(), hi.y(), lo.z()),
+      p001(lo.x(), lo.y(), hi.z()), p101(hi.x(), lo.y(), hi.z()),
+      p111(hi.x(), hi.y(), hi.z()), p011(lo.x(), hi.y(), hi.z());
+  const auto face = [](const Point3D& a, const Point3D& b, const Point3D& c,
+                       const Point3D& d) {
+    return Plane3D({Line3D(a, b), Line3D(b, c), Line3D(c, d), Line3D(d, a)});
+  };
+  return game_engine::Polyhedron(
+      {face(p000, p100, p110, p010), face(p001, p011, p111, p101),
+       face(p000, p010, p011, p001), face(p000, p001, p101, p100),
+       face(p100, p101, p111, p110), face(p010, p110, p111, p011)});
+}
@@ -0,0 +1,312 @@
+// Benchmarks of the safety path over every shipped map: trajectory vetting,
+// free space queries, map inflation and the quad state watchdog's checks.
+//
+// Results are printed as JSON unless another --benchmark_format is given. The
+// maps are read from the directory named by the GAME_ENGINE_MAP_DIRECTORY
+// environment variable, or from resources/maps in the source tree.
+//
+// Example:
+//   ./vetting_benchmark --benchmark_out=before.json
+//   ./vetting_benchmark --benchmark_filter='Vet/forest'
+#include <benchmark/benchmark.h>
+#include <dirent.h>
+
+#include <Eigen/StdVector>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "map3d.h"
+#include "periodic_scheduler.h"
+#include "quad_state.h"
+#include "quad_state_watchdog.h"
+#include "quad_state_watchdog_status.h"
+#include "trajectory.h"
+#include "trajectory_vetter.h"
+#include "warden.h"
+#include "yaml-cpp/yaml.h"
+
+using namespace game_engine;
+
+namespace {
+// Safety profile that is benchmarked. Leisure mode has the tightest limits.
+constexpr int kQuadSafetyLimits = 0;
+
+// Number of quads watched by the quad state watchdog
+constexpr size_t kNumQuads = 4;
+
+struct NamedMap {
+  std::string name;
+  std::shared_ptr<const Map3D> map;
+};
+
+std::vector<NamedMap> LoadMaps(const std::string& directory) {
+  std::vector<std::string> files;
+  if (DIR* dir = opendir(directory.c_str())) {
+    while (const dirent* entry = readdir(dir)) {
+      const std::string file = entry->d_name;
+      if (file.size() > 4 && 0 == file.compare(file.size() - 4, 4, ".map")) {
+        files.push_back(file);
+      }
+    }
+    closedir(dir);
+  }
+  std::sort(files.begin(), files.end());
+
+  std::vector<NamedMap> maps;
+  for (const std::string& file : files) {
+    try {
+      const YAML::Node node = YAML::LoadFile(directory + "/" + file);
+      maps.push_back({file.substr(0, file.size() - 4),
+                      std::make_shared<const Map3D>(node["map"].as<Map3D>())});
+    } catch (const std::exception& e) {
+      std::cerr << "Skipping " << file << ": " << e.what() << std::endl;
+    }
+  }
+  return maps;
+}
+
+Eigen::AlignedBox3d Bounds(const Map3D& map) {
+  const std::vector<std::pair<double, double>> extents = map.Extents();
+  return Eigen::AlignedBox3d(
+      Point3D(extents[0].first, extents[1].first, extents[2].first),
+      Point3D(extents[0].second, extents[1].second, extents[2].second));
+}
+
+// A random point in free space of a map, or the center of its bounds if
+// none is found
+Point3D RandomFreePoint(const Map3D& map, std::mt19937& generator) {
+  const Eigen::AlignedBox3d bounds = Bounds(map);
+  std::uniform_real_distribution<double> unit(0.0, 1.0);
+  for (size_t attempt = 0; attempt < 10000; ++attempt) {
+    const Point3D point =
+        bounds.min() + Point3D(unit(generator), unit(generator),
+                               unit(generator))
+                           .cwiseProduct(bounds.sizes());
+    if (true == map.Contains(point) && true == map.IsFreeSpace(point)) {
+      return point;
+    }
+  }
+  return bounds.center();
+}
+
+// A trajectory of the given number of samples that wanders through free
+// space at 1 m/s, turning whenever it would leave the map or hit an
+// obstacle, so that it passes vetting and every sample is checked
+Trajectory RandomFreeTrajectory(const Map3D& inflated_map,
+                                const size_t num_samples, const double dt,
+                                std::mt19937& generator) {
+  std::normal_distribution<double> normal(0.0, 1.0);
+  const auto random_direction = [&]() {
+    return Point3D(normal(generator), normal(generator), normal(generator))
+        .normalized();
+  };
+
+  Point3D position = RandomFreePoint(inflated_map, generator);
+  Point3D direction = random_direction();
+
+  TrajectoryVector3D samples;
+  samples.reserve(num_samples);
+  for (size_t idx = 0; idx < num_samples; ++idx) {
+    samples.push_back((Eigen::Matrix<double, 11, 1>() << position, 0, 0, 0, 0,
+                       0, 0, 0, idx * dt)
+                          .finished());
+
+    for (size_t attempt = 0; attempt < 16; ++attempt) {
+      const Point3D next = position + dt * direction;
+      if (true == inflated_map.Contains(next) &&
+          true == inflated_map.IsFreeSpace(next) &&
+          true == inflated_map.IsFreeSegment(position, next)) {
+        position = next;
+        break;
+      }
+      direction = random_direction();
+    }
+  }
+  return Trajectory(samples);
+}
+
+std::shared_ptr<QuadStateWarden> QuadStateWardenAt(const Point3D& position) {
+  auto quad_state_warden = std::make_shared<QuadStateWarden>();
+  Eigen::Matrix<double, 13, 1> state = Eigen::Matrix<double, 13, 1>::Zero();
+  state.head<3>() = position;
+  state(6) = 1;
+  quad_state_warden->Register("quad");
+  quad_state_warden->Write("quad", QuadState(state));
+  return quad_state_warden;
+}
+
+void BM_Vet(benchmark::State& state, const NamedMap& named_map,
+            const size_t num_samples, const double dt) {
+  const TrajectoryVetter vetter(kQuadSafetyLimits);
+  const Map3D& map = *named_map.map;
+  const std::shared_ptr<const Map3D> inflated_map =
+      map.Inflated(vetter.options_.min_distance);
+
+  std::mt19937 generator(0);
+  const Trajectory trajectory =
+      RandomFreeTrajectory(*inflated_map, num_samples, dt, generator);
+  const auto quad_state_warden = QuadStateWardenAt(trajectory.Position(0));
+  if (MediationLayerCode::Success !=
+      vetter.Vet(trajectory, map, quad_state_warden, "quad").code) {
+    state.SkipWithError("The synthetic trajectory does not pass vetting");
+    return;
+  }
+
+  for (auto _ : state) {
+    const TrajectoryCode code =
+        vetter.Vet(trajectory, map, quad_state_warden, "quad");
+    benchmark::DoNotOptimize(code);
+  }
+  state.SetItemsProcessed(state.iterations() * num_samples);
+}
+
+void BM_IsFreeSpace(benchmark::State& state, const NamedMap& named_map,
+                    const bool inflated) {
+  const Map3D& map = (true == inflated) ? *named_map.map->Inflated(0.4)
+                                        : *named_map.map;
+
+  // Uniformly distributed over the map's bounds
+  std::mt19937 generator(0);
+  std::uniform_real_distribution<double> unit(0.0, 1.0);
+  const Eigen::AlignedBox3d bounds = Bounds(map);
+  std::vector<Point3D> points;
+  for (size_t idx = 0; idx < 4096; ++idx) {
+    points.push_back(bounds.min() +
+                     Point3D(unit(generator), unit(generator), unit(generator))
+                         .cwiseProduct(bounds.sizes()));
+  }
+
+  for (auto _ : state) {
+    size_t free = 0;
+    for (const Point3D& point : points) {
+      free += map.IsFreeSpace(point);
+    }
+    benchmark::DoNotOptimize(free);
+  }
+  state.SetItemsProcessed(state.iterations() * points.size());
+}
+
+void BM_Inflate(benchmark::State& state, const NamedMap& named_map) {
+  for (auto _ : state) {
+    const Map3D inflated_map = named_map.map->Inflate(0.4);
+    benchmark::DoNotOptimize(inflated_map);
+  }
+}
+
+// The watchdog's checks run on a scheduler, as in the mediation layer. Each
+// iteration lets the watchdog run for a short window and reports the mean
+// time of one check, as measured by the scheduler.
+void BM_QuadStateWatchdog(benchmark::State& state, const NamedMap& named_map) {
+  const Map3D& map = *named_map.map;
+  std::mt19937 generator(0);
+
+  std::vector<std::string> quad_names;
+  auto quad_state_warden = std::make_shared<QuadStateWarden>();
+  auto quad_state_watchdog_status = std::make_shared<QuadStateWatchdogStatus>();
+  for (size_t idx = 0; idx < kNumQuads; ++idx) {
+    const std::string quad_name = "quad" + std::to_string(idx);
+    Eigen::Matrix<double, 13, 1> quad_state =
+        Eigen::Matrix<double, 13, 1>::Zero();
+    quad_state.head<3>() = RandomFreePoint(*map.Inflated(1.25), generator);
+    quad_state(6) = 1;
+    quad_state_warden->Register(quad_name);
+    quad_state_warden->Write(quad_name, QuadState(quad_state));
+    quad_state_watchdog_status->Register(quad_name);
+    quad_names.push_back(quad_name);
+  }
+
+  QuadStateWatchdog::Options options;
+  options.period = std::chrono::milliseconds(1);
+  QuadStateWatchdog watchdog(kQuadSafetyLimits, true, options);
+
+  PeriodicScheduler::Options scheduler_options;
+  scheduler_options.worker_threads = 1;
+  PeriodicScheduler scheduler(scheduler_options);
+  watchdog.Schedule(scheduler, quad_state_warden, quad_names,
+                    quad_state_watchdog_status, map);
+
+  uint64_t runs = 0;
+  PeriodicScheduler::Clock::duration execution_time{0};
+  for (auto _ : state) {
+    std::thread stopper([&]() {
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+      scheduler.Stop();
+    });
+    scheduler.Run();
+    stopper.join();
+
+    const PeriodicScheduler::TaskStats stats = scheduler.Stats()[0];
+    const uint64_t window_runs = stats.runs - runs;
+    const PeriodicScheduler::Clock::duration window_time =
+        stats.total_execution_time - execution_time;
+    runs = stats.runs;
+    execution_time = stats.total_execution_time;
+
+    state.SetIterationTime(
+        std::chrono::duration<double>(window_time).count() /
+        std::max<uint64_t>(window_runs, 1));
+  }
+  state.counters["quads"] = kNumQuads;
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+  // Default to JSON output
+  std::vector<char*> args(argv, argv + argc);
+  char json_format[] = "--benchmark_format=json";
+  if (args.end() == std::find_if(args.begin(), args.end(), [](const char* arg) {
+        return 0 == std::strncmp(arg, "--benchmark_format", 18);
+      })) {
+    args.insert(args.begin() + 1, json_format);
+  }
+  int num_args = args.size();
+  benchmark::Initialize(&num_args, args.data());
+  if (true == benchmark::ReportUnrecognizedArguments(num_args, args.data())) {
+    return EXIT_FAILURE;
+  }
+
+  const char* directory = std::getenv("GAME_ENGINE_MAP_DIRECTORY");
+  const std::vector<NamedMap> maps =
+      LoadMaps(nullptr != directory ? directory : GAME_ENGINE_MAP_DIRECTORY);
+  if (true == maps.empty()) {
+    std::cerr << "No maps found" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  for (const NamedMap& named_map : maps) {
+    for (const size_t num_samples : {100, 1000, 10000}) {
+      for (const size_t rate : {60, 100, 200}) {
+        const std::string name = "Vet/" + named_map.name +
+                                 "/samples:" + std::to_string(num_samples) +
+                                 "/hz:" + std::to_string(rate);
+        benchmark::RegisterBenchmark(name.c_str(), BM_Vet, named_map,
+                                     num_samples, 1.0 / rate);
+      }
+    }
+    benchmark::RegisterBenchmark(("IsFreeSpace/" + named_map.name).c_str(),
+                                 BM_IsFreeSpace, named_map, false);
+    benchmark::RegisterBenchmark(
+        ("IsFreeSpace/" + named_map.name + "/inflated").c_str(),
+        BM_IsFreeSpace, named_map, true);
+    benchmark::RegisterBenchmark(("Inflate/" + named_map.name).c_str(),
+                                 BM_Inflate, named_map)
+        ->Unit(benchmark::kMillisecond);
+    benchmark::RegisterBenchmark(
+        ("QuadStateWatchdog/" + named_map.name).c_str(), BM_QuadStateWatchdog,
+        named_map)
+        ->UseManualTime()
+        ->Iterations(5)
+        ->Unit(benchmark::kMicrosecond);
+  }
+
+  benchmark::RunSpecifiedBenchmarks();
+  return EXIT_SUCCESS;
+}